@@ -1,5 +1,7 @@
-__all__ = ['common', 'new_emulator', 'worker_connection', 'host_specification']
+__all__ = ['common', 'new_emulator', 'worker_connection', 'host_specification', 'batch_transfer', 'load_generator']
 from x3270if.common import *
 from x3270if.new_emulator import *
 from x3270if.worker_connection import *
 from x3270if.host_specification import *
+from x3270if.batch_transfer import *
+from x3270if.load_generator import *
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+# Simple Python version of x3270if
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Batch file transfers over several x3270 emulator sessions"""
+
+import json
+import queue
+import re
+import socket
+import sys
+import threading
+import time
+
+from x3270if.common import _session
+from x3270if.common import ActionFailException
+
+_bytes_re = re.compile(r'(\d+) bytes transferred')
+
+class batch_transfer():
+    """Runs a manifest of file transfers, spreading them over several
+       emulator sessions that are already connected and logged on. Each
+       session runs one Transfer() at a time and takes the next file from
+       the manifest as soon as it finishes, so a slow file does not hold up
+       the others."""
+    def __init__(self,sessions,manifest,debug=False):
+        """Initialize an instance
+
+           Args:
+              sessions (list of _session): Emulator sessions to use.
+              manifest (list of dict): Files to transfer. Each entry holds
+                 Transfer() keywords and values, e.g.
+                 {'direction': 'send', 'localfile': 'a.txt',
+                  'hostfile': 'a text a', 'host': 'vm'}.
+              debug (bool): True to trace debug info to stderr.
+        """
+        if (len(sessions) == 0):
+            raise ValueError('No sessions')
+        self._sessions = sessions
+        self._manifest = manifest
+        self._debug_enabled = debug
+        self._lock = threading.Lock()
+        self._files = []
+        self._start = None
+        self._end = None
+
+    def run(self):
+        """Run the transfers and wait for them all to finish
+
+           Returns:
+              dict: The report, as described under report().
+        """
+        work = queue.Queue()
+        self._files = [None] * len(self._manifest)
+        for i, entry in enumerate(self._manifest):
+            work.put((i, entry))
+        self._start = time.monotonic()
+        self._end = None
+        threads = [threading.Thread(target=self._worker, args=(ix, s, work))
+                for ix, s in enumerate(self._sessions)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self._end = time.monotonic()
+        return self.report()
+
+    def report(self):
+        """Report the status of each file and the aggregate throughput
+
+           May be called from another thread while run() is in progress.
+
+           Returns:
+              dict: 'files' is a list with an entry for each manifest entry
+                 that has been started, giving its 'index' in the manifest,
+                 the 'session' index that ran it, its 'status' ('running',
+                 'complete' or 'failed'), the emulator's 'message', and
+                 the 'bytes' and 'seconds' for the transfer.
+                 'completed', 'failed' and 'pending' count the files,
+                 'bytes' totals the bytes in completed transfers, 'seconds'
+                 is the elapsed time for the batch and 'bytes_per_second'
+                 is the aggregate throughput.
+        """
+        with self._lock:
+            files = [dict(f) for f in self._files if f is not None]
+        if (self._start is None):
+            seconds = 0.0
+        elif (self._end is None):
+            seconds = time.monotonic() - self._start
+        else:
+            seconds = self._end - self._start
+        total = sum(f['bytes'] for f in files if f['status'] == 'complete')
+        return {
+            'files': files,
+            'completed': sum(1 for f in files if f['status'] == 'complete'),
+            'failed': sum(1 for f in files if f['status'] == 'failed'),
+            'pending': len(self._manifest) - len(files),
+            'bytes': total,
+            'seconds': round(seconds, 3),
+            'bytes_per_second': round(total / seconds) if seconds > 0 else 0
+        }
+
+    def json(self):
+        """Report the status in JSON
+
+           Returns:
+              str: The report from report(), formatted as JSON.
+        """
+        return json.dumps(self.report())
+
+    def _worker(self,session_ix,session,work):
+        """Run transfers from the work queue on one session
+
+           Args:
+              session_ix (int): Index of the session.
+              session (_session): The session.
+              work (queue.Queue): Manifest entries to transfer.
+        """
+        while (True):
+            try:
+                (i, entry) = work.get_nowait()
+            except queue.Empty:
+                return
+            status = { 'index': i, 'session': session_ix,
+                    'status': 'running', 'message': '', 'bytes': 0,
+                    'seconds': 0.0 }
+            with self._lock:
+                self._files[i] = status
+            args = [k + '=' + str(v) for k, v in entry.items()]
+            start = time.monotonic()
+            try:
+                message = session.run_action('Transfer', args)
+                m = _bytes_re.search(message)
+                result = 'complete'
+                nbytes = int(m.group(1)) if m is not None else 0
+            except ActionFailException as err:
+                message = str(err)
+                result = 'failed'
+                nbytes = 0
+            except EOFError:
+                message = 'Emulator exited'
+                result = 'failed'
+                nbytes = 0
+            seconds = time.monotonic() - start
+            self._debug('session {0} file {1}: {2}'.format(session_ix, i,
+                message))
+            with self._lock:
+                status['status'] = result
+                status['message'] = message.split('\n')[0]
+                status['bytes'] = nbytes
+                status['seconds'] = round(seconds, 3)
+            if (result == 'failed' and message == 'Emulator exited'):
+                return
+
+    def _debug(self,text):
+        """Debug output
+
+           Args:
+              text (str): Text to log. A Newline will be added.
+        """
+        if (self._debug_enabled):
+            sys.stderr.write(text + '\n')
+
+class port_session(_session):
+    """Connection to an emulator started with -scriptport"""
+    def __init__(self,port,debug=False):
+        """Initialize the object.
+
+           Args:
+              port (int): Emulator script port on the local host.
+              debug (bool): True to log debug information to stderr.
+        """
+        _session.__init__(self, debug)
+        self._socket = socket.create_connection(['127.0.0.1', int(port)])
+        self._to3270 = self._socket.makefile('w', encoding='utf-8')
+        self._from3270 = self._socket.makefile('r', encoding='utf-8')
+        self._debug('Connected')
+
+    def __del__(self):
+        self._socket.close()
+        _session.__del__(self)
+
+if __name__ == '__main__':
+    # python3 -m x3270if.batch_transfer manifest.json port [port...]
+    if (len(sys.argv) < 3):
+        sys.stderr.write('usage: batch_transfer manifest.json port [port...]\n')
+        sys.exit(2)
+    with open(sys.argv[1]) as f:
+        manifest = json.load(f)
+    sessions = [port_session(port) for port in sys.argv[2:]]
+    b = batch_transfer(sessions, manifest)
+    b.run()
+    print(b.json())
+    sys.exit(1 if b.report()['failed'] else 0)
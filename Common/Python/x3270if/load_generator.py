@@ -0,0 +1,300 @@
+#!/usr/bin/env python3
+# Simple Python version of x3270if
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Synthetic load generation over many x3270 emulator sessions"""
+
+import argparse
+import json
+import math
+import sys
+import threading
+import time
+
+from x3270if.common import ActionFailException
+from x3270if.common import StartupException
+from x3270if.new_emulator import new_emulator
+
+class load_generator():
+    """Opens many s3270 sessions to one host and runs a scripted
+       transaction on each of them repeatedly, measuring the latency of
+       each transaction. A transaction is a list of actions in s3270 action
+       syntax, e.g. ['String(logon)', 'Enter()', 'Wait(InputField)'], and
+       is sent to the emulator as a single line, so its latency is one
+       round trip through the emulator and the host."""
+    def __init__(self,host,sessions,transaction,transactions=1,
+            setup=['Wait(InputField)'],think=0.0,ramp=0.0,extra_args=[],
+            debug=False):
+        """Initialize an instance
+
+           Args:
+              host (str): Host to connect to, in s3270 command-line syntax.
+              sessions (int): Number of concurrent sessions.
+              transaction (list of str): Actions making up a transaction.
+              transactions (int): Number of transactions per session.
+              setup (list of str): Actions to run on each session before
+                 the first transaction. These are not timed.
+              think (float): Seconds to wait between transactions.
+              ramp (float): Seconds over which to spread session start-up.
+              extra_args (list of str): Extra s3270 command-line arguments.
+              debug (bool): True to trace debug info to stderr.
+        """
+        if (sessions < 1):
+            raise ValueError('No sessions')
+        if (len(transaction) == 0):
+            raise ValueError('Empty transaction')
+        self._host = host
+        self._nsessions = sessions
+        self._transaction = ' '.join(transaction)
+        self._ntransactions = transactions
+        self._setup = ' '.join(setup)
+        self._think = think
+        self._ramp = ramp
+        self._extra_args = extra_args
+        self._debug_enabled = debug
+        self._lock = threading.Lock()
+        self._latencies = []
+        self._failed = 0
+        self._sessions_started = 0
+        self._sessions_failed = 0
+        self._errors = []
+        self._first = None
+        self._last = None
+
+    def run(self):
+        """Run the sessions and wait for them all to finish
+
+           Returns:
+              dict: The report, as described under report().
+        """
+        self._latencies = []
+        self._failed = 0
+        self._sessions_started = 0
+        self._sessions_failed = 0
+        self._errors = []
+        self._first = None
+        self._last = None
+        threads = [threading.Thread(target=self._worker, args=(ix,))
+                for ix in range(self._nsessions)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        return self.report()
+
+    def report(self):
+        """Report transaction latency and throughput
+
+           May be called from another thread while run() is in progress.
+
+           Returns:
+              dict: 'sessions' is the number of sessions that started
+                 successfully and 'session_failures' the number that did
+                 not; 'transactions' counts the successful transactions and
+                 'failed' the ones that failed. 'seconds' is the time from
+                 the start of the first transaction to the end of the last,
+                 and 'transactions_per_second' the aggregate throughput.
+                 'latency' gives the 'min', 'p50', 'p90', 'p95', 'p99' and
+                 'max' latency of successful transactions, in milliseconds.
+                 'errors' lists the distinct error messages.
+        """
+        with self._lock:
+            latencies = sorted(self._latencies)
+            seconds = (self._last - self._first) if self._first is not None and self._last is not None else 0.0
+            report = {
+                'sessions': self._sessions_started,
+                'session_failures': self._sessions_failed,
+                'transactions': len(latencies),
+                'failed': self._failed,
+                'seconds': round(seconds, 3),
+                'transactions_per_second': round(len(latencies) / seconds, 1) if seconds > 0 else 0.0,
+                'errors': list(self._errors)
+            }
+        report['latency'] = { name: round(self._percentile(latencies, p) * 1000, 3)
+                for name, p in [('min', 0), ('p50', 50), ('p90', 90), ('p95', 95), ('p99', 99), ('max', 100)] }
+        return report
+
+    def json(self):
+        """Report latency and throughput in JSON
+
+           Returns:
+              str: The report from report(), formatted as JSON.
+        """
+        return json.dumps(self.report())
+
+    def _percentile(self,values,p):
+        """Compute a percentile, using the nearest-rank method
+
+           Args:
+              values (list of float): Sorted values.
+              p (int): Percentile, 0 to 100.
+           Returns:
+              float: The percentile, or 0.0 if there are no values.
+        """
+        if (len(values) == 0):
+            return 0.0
+        return values[max(0, math.ceil(p / 100 * len(values)) - 1)]
+
+    def _error(self,text):
+        """Record an error message
+
+           Args:
+              text (str): Message.
+        """
+        text = text.split('\n')[0]
+        with self._lock:
+            if (text not in self._errors):
+                self._errors.append(text)
+
+    def _worker(self,session_ix):
+        """Run one session
+
+           Args:
+              session_ix (int): Index of the session.
+        """
+        if (self._ramp > 0 and self._nsessions > 1):
+            time.sleep(self._ramp * session_ix / (self._nsessions - 1))
+        try:
+            # Starting many emulators at once can take a while.
+            emulator = new_emulator(extra_args=self._extra_args + [self._host],
+                    timeout=10.0)
+        except StartupException as err:
+            self._start_failed(session_ix, err)
+            return
+        try:
+            self._session(session_ix, emulator)
+        finally:
+            try:
+                emulator.run_action('Quit()')
+            except (ActionFailException, EOFError, OSError):
+                pass
+            emulator.close()
+
+    def _start_failed(self,session_ix,err):
+        """Record a session that failed to start
+
+           Args:
+              session_ix (int): Index of the session.
+              err (Exception): What went wrong.
+        """
+        self._debug('session {0} failed to start: {1}'.format(session_ix, err))
+        self._error(str(err))
+        with self._lock:
+            self._sessions_failed += 1
+
+    def _session(self,session_ix,emulator):
+        """Run the setup and the transactions for one session
+
+           Args:
+              session_ix (int): Index of the session.
+              emulator (new_emulator): The emulator.
+        """
+        try:
+            emulator.run_action(self._setup)
+        except (ActionFailException, EOFError) as err:
+            self._start_failed(session_ix, err)
+            return
+        with self._lock:
+            self._sessions_started += 1
+
+        for i in range(self._ntransactions):
+            if (i > 0 and self._think > 0):
+                time.sleep(self._think)
+            start = time.monotonic()
+            try:
+                emulator.run_action(self._transaction)
+                failed = False
+            except ActionFailException as err:
+                self._error(str(err))
+                failed = True
+            except EOFError:
+                self._error('Emulator exited')
+                with self._lock:
+                    self._failed += self._ntransactions - i
+                break
+            end = time.monotonic()
+            with self._lock:
+                if (self._first is None or start < self._first):
+                    self._first = start
+                if (self._last is None or end > self._last):
+                    self._last = end
+                if (failed):
+                    self._failed += 1
+                else:
+                    self._latencies.append(end - start)
+            self._debug('session {0} transaction {1}: {2}'.format(session_ix,
+                i, 'failed' if failed else '{0:.3f}s'.format(end - start)))
+
+    def _debug(self,text):
+        """Debug output
+
+           Args:
+              text (str): Text to log. A Newline will be added.
+        """
+        if (self._debug_enabled):
+            sys.stderr.write(text + '\n')
+
+def _read_actions(filename):
+    """Read actions from a file, one or more per line, ignoring blank lines
+       and lines starting with '#'
+
+       Args:
+          filename (str): File name.
+       Returns:
+          list of str: Actions.
+    """
+    with open(filename) as f:
+        return [line.strip() for line in f if line.strip() != '' and not line.strip().startswith('#')]
+
+if __name__ == '__main__':
+    # python3 -m x3270if.load_generator [options] host transaction-file
+    parser = argparse.ArgumentParser(prog='load_generator',
+            description='Run transactions on many s3270 sessions at once')
+    parser.add_argument('-n', '--sessions', type=int, default=1,
+            help='number of concurrent sessions')
+    parser.add_argument('-t', '--transactions', type=int, default=1,
+            help='number of transactions per session')
+    parser.add_argument('-s', '--setup', metavar='FILE',
+            help='file of actions to run before the first transaction')
+    parser.add_argument('-k', '--think', type=float, default=0.0,
+            help='seconds to wait between transactions')
+    parser.add_argument('-r', '--ramp', type=float, default=0.0,
+            help='seconds over which to start the sessions')
+    parser.add_argument('-d', '--debug', action='store_true',
+            help='trace debug info to stderr')
+    parser.add_argument('host', help='host to connect to')
+    parser.add_argument('transaction', metavar='transaction-file',
+            help='file of actions making up a transaction')
+    args = parser.parse_args()
+    setup = _read_actions(args.setup) if args.setup is not None else ['Wait(InputField)']
+    g = load_generator(args.host, args.sessions,
+            _read_actions(args.transaction), transactions=args.transactions,
+            setup=setup, think=args.think, ramp=args.ramp, debug=args.debug)
+    g.run()
+    print(g.json())
+    r = g.report()
+    sys.exit(1 if r['failed'] or r['session_failures'] else 0)
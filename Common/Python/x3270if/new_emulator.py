@@ -40,7 +40,7 @@ from x3270if.common import StartupException
 
 class new_emulator(_session):
     """Starts a new copy of s3270"""
-    def __init__(self,debug=False,emulator=None,extra_args=[]):
+    def __init__(self,debug=False,emulator=None,extra_args=[],timeout=0.5):
         """Initialize the object.
 
            Args:
@@ -48,6 +48,7 @@ class new_emulator(_session):
               emulator (str): Name of the emulator to start, defaults to s3270
               extra_args(list of str, optional): Extra arguments
                  to pass in the s3270 command line.
+              timeout (float): Seconds to wait for the emulator to start.
            Raises:
               StartupException: Unable to start s3270.
         """
@@ -78,15 +79,17 @@ class new_emulator(_session):
             if (oserr != None): raise StartupException(oserr)
 
             # It might take a couple of tries to connect, as it takes time to
-            # start the process. We wait a maximum of half a second.
+            # start the process. By default we wait a maximum of half a
+            # second.
             tries = 0
             connected = False
-            while (tries < 5):
+            while (tries < max(1, round(timeout / 0.1))):
                 try:
                     self._socket = socket.create_connection(['127.0.0.1', port])
                     connected = True
                     break
                 except:
+                    if (self._s3270.poll() != None): break
                     time.sleep(0.1)
                     tries += 1
             if (not connected):
@@ -94,13 +97,37 @@ class new_emulator(_session):
                 self._s3270.terminate()
                 r = self._s3270.stderr.readline().rstrip('\r\n')
                 if (r != ''): errmsg += ': ' + r
+                self._s3270.wait()
+                self._s3270.stderr.close()
+                self._s3270 = None
                 raise StartupException(errmsg)
 
             self._to3270 = self._socket.makefile('w', encoding='utf-8')
             self._from3270 = self._socket.makefile('r', encoding='utf-8')
             self._debug('Connected')
         finally:
-            del tempsocket
+            tempsocket.close()
+
+    def close(self):
+        """Close the connection and wait for the emulator to exit
+
+           The emulator is terminated if it does not exit by itself, e.g.,
+           if Quit() has not been run.
+        """
+        if (self._socket != None):
+            self._to3270.close()
+            self._from3270.close()
+            self._socket.close()
+            self._socket = None
+        if (self._s3270 != None):
+            try:
+                self._s3270.wait(timeout=2)
+            except subprocess.TimeoutExpired:
+                self._s3270.terminate()
+                self._s3270.wait()
+            self._s3270.stderr.close()
+            self._s3270 = None
+        self._debug('new_emulator closed')
 
     def __del__(self):
         if (self._s3270 != None): self._s3270.terminate()
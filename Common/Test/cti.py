@@ -55,6 +55,20 @@ def unused_port(ipv6=False):
     s.bind(('::' if ipv6 else '0.0.0.0', 0))
     return (s.getsockname()[1], s)
 
+# Return the number of times a benchmark should repeat an operation, which
+# can be overridden with the BENCH_ITERATIONS environment variable.
+def bench_iterations(default: int):
+    return int(os.environ.get('BENCH_ITERATIONS', str(default)))
+
+# Return the CPU time used so far by a process, in seconds, or None.
+def cpu_time(pid: int):
+    try:
+        with open(f'/proc/{pid}/stat') as f:
+            fields = f.read().rsplit(')', 1)[1].split()
+        return (int(fields[11]) + int(fields[12])) / os.sysconf('SC_CLK_TCK')
+    except (OSError, ValueError):
+        return None
+
 # Simple socket copy server.
 class copyserver():
 
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Minimal TN3270 host that runs IND$FILE DFT transfers.
+
+import socket
+
+# TELNET and 3270 constants.
+IAC = 0xff
+SB = 0xfa
+SE = 0xf0
+EOR = 0xef
+AID_SF = 0x88
+AID_ENTER = 0x7d
+QR_DDM = 0x95
+
+# Host structured fields, taken from s3270/Test/ft_dft.trc.
+open_data = bytes.fromhex('0029d000120106010104030a0a000100000000010050055203f0080627043fef030946543a44415441')
+open_msg = bytes.fromhex('0023d000120106010104030a0a000000001101010050055203f0030946543a4d534720')
+set_cursor = bytes.fromhex('000fd0451101050006000905010300')
+get_req = bytes.fromhex('0009d0461101040080')
+insert_req = bytes.fromhex('000ad047110105008000')
+close_req = bytes.fromhex('0005d04112')
+complete_msg = 'TRANS03 File transfer complete$'.encode()
+
+# Build a Data Insert structured field.
+def data_insert(data: bytes) -> bytes:
+    return (10 + len(data)).to_bytes(2, 'big') + bytes.fromhex('d04704c08061') + (5 + len(data)).to_bytes(2, 'big') + data
+
+# A minimal TN3270 host that understands just enough IND$FILE DFT to run
+# uploads and downloads.
+class DftHost:
+
+    def __init__(self, listener: socket.socket):
+        self.listener = listener
+        self.conn = None
+        self.buf = bytearray()
+        self.inlim = 0
+
+    # Read more data from the emulator.
+    def fill(self):
+        data = self.conn.recv(65536)
+        if len(data) == 0:
+            raise EOFError('emulator disconnected')
+        self.buf += data
+
+    # Read a TELNET command sequence, returning it.
+    def read_command(self) -> bytes:
+        while True:
+            if len(self.buf) >= 2 and self.buf[0] == IAC and self.buf[1] == SB:
+                end = self.buf.find(bytes([IAC, SE]))
+                if end >= 0:
+                    cmd = bytes(self.buf[:end + 2])
+                    del self.buf[:end + 2]
+                    return cmd
+            elif len(self.buf) >= 3 and self.buf[0] == IAC:
+                cmd = bytes(self.buf[:3])
+                del self.buf[:3]
+                return cmd
+            self.fill()
+
+    # Read a 3270 record, skipping any TELNET negotiation.
+    def read_record(self) -> bytes:
+        while True:
+            while len(self.buf) >= 3 and self.buf[0] == IAC and self.buf[1] != IAC and self.buf[1] != EOR:
+                self.read_command()
+            i = 0
+            while True:
+                i = self.buf.find(IAC, i)
+                if i < 0 or i + 1 >= len(self.buf):
+                    break
+                if self.buf[i + 1] == EOR:
+                    rec = bytes(self.buf[:i]).replace(b'\xff\xff', b'\xff')
+                    del self.buf[:i + 2]
+                    return rec
+                i += 2
+            self.fill()
+
+    # Send a 3270 record.
+    def send_record(self, data: bytes):
+        self.conn.sendall(data.replace(b'\xff', b'\xff\xff') + bytes([IAC, EOR]))
+
+    # Send a Write Structured Field and check the reply.
+    def wsf(self, sfs: bytes, expect: bytes = None) -> bytes:
+        self.send_record(b'\xf3' + sfs)
+        if expect is None:
+            return None
+        rec = self.read_record()
+        if not rec.startswith(expect):
+            raise ValueError(f'unexpected reply {rec[:16].hex()}')
+        return rec
+
+    # Negotiate TN3270 and paint a screen with one input field.
+    def connect(self):
+        (self.conn, _) = self.listener.accept()
+        self.conn.settimeout(10)
+        self.conn.sendall(bytes.fromhex('fffd18'))
+        self.read_command()
+        self.conn.sendall(bytes.fromhex('fffa1801fff0'))
+        self.read_command()
+        self.conn.sendall(bytes.fromhex('fffb00fffd00fffb19fffd19'))
+        self.send_record(bytes.fromhex('f5c311404040401d4013'))
+
+    # Process the IND$FILE command and query the emulator's buffer size.
+    def start_transfer(self, rec: bytes = None):
+        if rec is None:
+            rec = self.read_record()
+        if rec[0] != AID_ENTER:
+            raise ValueError(f'expected Enter, got {rec[:16].hex()}')
+        rec = self.wsf(bytes.fromhex('000501ff02'), bytes([AID_SF]))
+        i = 1
+        while i + 4 <= len(rec):
+            qlen = int.from_bytes(rec[i:i + 2], 'big')
+            if rec[i + 3] == QR_DDM:
+                self.inlim = int.from_bytes(rec[i + 6:i + 8], 'big')
+            i += qlen
+        if self.inlim == 0:
+            raise ValueError('no DDM query reply')
+        self.wsf(open_data, bytes.fromhex('880005d00009'))
+
+    # Finish a transfer and unlock the keyboard.
+    def end_transfer(self):
+        self.wsf(close_req, bytes.fromhex('880005d04109'))
+        self.wsf(open_msg, bytes.fromhex('880005d00009'))
+        self.wsf(insert_req + data_insert(complete_msg), bytes.fromhex('88000bd04705'))
+        self.send_record(bytes.fromhex('f1c3'))
+
+    # Receive a file from the emulator (an upload), returning its contents.
+    # If fail_after is given, fail like a host that crashes after storing
+    # that many records: ask for the next one, then drop the connection.
+    def upload(self, rec: bytes = None, fail_after: int = None) -> bytes:
+        self.start_transfer(rec)
+        data = bytearray()
+        nrec = 0
+        while True:
+            rec = self.wsf(set_cursor + get_req, bytes([AID_SF]))
+            if rec[4:6] == bytes.fromhex('4608'):
+                break
+            if nrec == fail_after:
+                self.conn.close()
+                return bytes(data)
+            data += rec[17:17 + int.from_bytes(rec[15:17], 'big') - 5]
+            nrec += 1
+        self.end_transfer()
+        return bytes(data)
+
+    # Send a file to the emulator (a download).
+    def download(self, data: bytes, rec: bytes = None):
+        self.start_transfer(rec)
+        chunk = self.inlim - 1 - len(insert_req) - 10
+        for i in range(0, len(data), chunk):
+            self.wsf(insert_req + data_insert(data[i:i + chunk]), bytes.fromhex('88000bd04705'))
+        self.end_transfer()
+
+    # Run transfers until the emulator disconnects, keeping uploaded files by
+    # host file name so they can be downloaded again.
+    def serve(self):
+        self.files = {}
+        try:
+            while True:
+                rec = self.read_record()
+                words = rec.decode('cp037').split('IND$FILE', 1)[-1].split()
+                if words[0] == 'PUT':
+                    self.files[words[1]] = self.upload(rec)
+                else:
+                    self.download(self.files[words[1]], rec)
+        except (EOFError, OSError):
+            pass
@@ -0,0 +1,631 @@
+/*
+ * Copyright (c) 2025 Paul Mattes.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the names of Paul Mattes nor the names of his contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ *	ds_bench.c
+ *		Data stream benchmark: feeds the host data from trace files
+ *		straight into the 3270 and NVT data stream processors.
+ */
+
+#include "globals.h"
+
+#include <time.h>
+#include <sys/stat.h>
+
+#include "appres.h"
+#include "3270ds.h"
+#include "arpa_telnet.h"
+#include "tn3270e.h"
+
+#include "codepage.h"
+#include "ctlrc.h"
+#include "ft.h"
+#include "glue.h"
+#include "host.h"
+#include "httpd-core.h"
+#include "httpd-io.h"
+#include "idle.h"
+#include "kybd.h"
+#include "login_macro.h"
+#include "model.h"
+#include "nvt.h"
+#include "pr3287_session.h"
+#include "prefer.h"
+#include "print_screen.h"
+#include "proxy_toggle.h"
+#include "query.h"
+#include "rpq.h"
+#include "save_restore.h"
+#include "s3270_modules.h"
+#include "screen.h"
+#include "sio_glue.h"
+#include "task.h"
+#include "telnet.h"
+#include "telnet_new_environ.h"
+#include "toggles.h"
+#include "trace.h"
+#include "trace_binary.h"
+#include "screentrace.h"
+#include "utils.h"
+#include "vstatus.h"
+#include "xio.h"
+
+/* Default minimum time to spend on each trace file, in seconds. */
+#define DEFAULT_TIME	0.25
+
+/* Types of record. */
+typedef enum {
+    R_3270,		/* 3270 data stream */
+    R_SSCP_LU,		/* SSCP-LU data */
+    R_NVT		/* NVT data */
+} rtype_t;
+
+/* A host data record. */
+typedef struct {
+    rtype_t type;
+    unsigned char *data;
+    size_t len;
+} record_t;
+
+/* Records loaded from a trace file. */
+static record_t *records;
+static size_t nrecords;
+static size_t nbytes;
+static unsigned long nskipped;
+
+/* Telnet parser state. */
+static enum {
+    TS_DATA,		/* data */
+    TS_IAC,		/* got IAC */
+    TS_OPT,		/* got WILL/WONT/DO/DONT */
+    TS_SB,		/* in a subnegotiation */
+    TS_SB_IAC		/* got IAC in a subnegotiation */
+} tstate;
+static unsigned char topt_cmd;	/* WILL/WONT/DO/DONT */
+static bool sb_start;		/* at the start of a subnegotiation */
+static bool in_eor;		/* EOR negotiated, records end with IAC EOR */
+static bool in_tn3270e;		/* TN3270E negotiated */
+static unsigned char *rbuf;	/* record being accumulated */
+static size_t rlen;
+static size_t rsize;
+
+/* Return the current time in seconds. */
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/*
+ * Returns true if a 3270 record can be processed without generating
+ * output. Read commands, Read Partition and file transfer structured fields
+ * would need a connection to send their replies on.
+ */
+static bool
+quiet_3270(const unsigned char *buf, size_t len)
+{
+    size_t offset;
+
+    switch (buf[0]) {
+    case CMD_W:
+    case SNA_CMD_W:
+    case CMD_EW:
+    case SNA_CMD_EW:
+    case CMD_EWA:
+    case SNA_CMD_EWA:
+    case CMD_EAU:
+    case SNA_CMD_EAU:
+	return true;
+    case CMD_WSF:
+    case SNA_CMD_WSF:
+	for (offset = 1; offset + 3 <= len; ) {
+	    size_t sflen = (buf[offset] << 8) | buf[offset + 1];
+
+	    if (buf[offset + 2] == SF_READ_PART ||
+		    buf[offset + 2] == SF_TRANSFER_DATA) {
+		return false;
+	    }
+	    if (sflen == 0) {
+		break;
+	    }
+	    offset += sflen;
+	}
+	return true;
+    default:
+	return false;
+    }
+}
+
+/* Add a record. */
+static void
+add_record(rtype_t type, const unsigned char *data, size_t len)
+{
+    record_t *r;
+
+    if (len == 0) {
+	return;
+    }
+    if ((type == R_3270 && !quiet_3270(data, len))) {
+	nskipped++;
+	return;
+    }
+    records = (record_t *)Realloc(records, (nrecords + 1) * sizeof(record_t));
+    r = &records[nrecords++];
+    r->type = type;
+    r->data = (unsigned char *)Malloc(len);
+    memcpy(r->data, data, len);
+    r->len = len;
+    nbytes += len;
+}
+
+/* Finish a record at IAC EOR. */
+static void
+end_record(void)
+{
+    if (!in_tn3270e) {
+	add_record(R_3270, rbuf, rlen);
+    } else if (rlen >= EH_SIZE) {
+	switch (rbuf[0]) {
+	case TN3270E_DT_3270_DATA:
+	    add_record(R_3270, rbuf + EH_SIZE, rlen - EH_SIZE);
+	    break;
+	case TN3270E_DT_SSCP_LU_DATA:
+	    add_record(R_SSCP_LU, rbuf + EH_SIZE, rlen - EH_SIZE);
+	    break;
+	case TN3270E_DT_NVT_DATA:
+	    add_record(R_NVT, rbuf + EH_SIZE, rlen - EH_SIZE);
+	    break;
+	default:
+	    break;
+	}
+    }
+    rlen = 0;
+}
+
+/*
+ * Flush NVT data. Before EOR or TN3270E is negotiated, host data is NVT
+ * data, and it is flushed at each telnet command and each network read.
+ */
+static void
+flush_nvt(void)
+{
+    if (!in_eor && !in_tn3270e) {
+	add_record(R_NVT, rbuf, rlen);
+	rlen = 0;
+    }
+}
+
+/* Store a data byte. */
+static void
+store(unsigned char c)
+{
+    if (rlen >= rsize) {
+	rsize = rsize? rsize * 2: 4096;
+	rbuf = (unsigned char *)Realloc(rbuf, rsize);
+    }
+    rbuf[rlen++] = c;
+}
+
+/* Run a block of host data through the telnet parser. */
+static void
+host_data(const unsigned char *buf, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+	unsigned char c = buf[i];
+
+	switch (tstate) {
+	case TS_DATA:
+	    if (c == IAC) {
+		tstate = TS_IAC;
+	    } else {
+		store(c);
+	    }
+	    break;
+	case TS_IAC:
+	    tstate = TS_DATA;
+	    switch (c) {
+	    case IAC:
+		store(c);
+		break;
+	    case EOR:
+		end_record();
+		break;
+	    case WILL:
+	    case WONT:
+	    case DO:
+	    case DONT:
+		flush_nvt();
+		topt_cmd = c;
+		tstate = TS_OPT;
+		break;
+	    case SB:
+		flush_nvt();
+		sb_start = true;
+		tstate = TS_SB;
+		break;
+	    default:
+		break;
+	    }
+	    break;
+	case TS_OPT:
+	    if (c == TELOPT_EOR && (topt_cmd == DO || topt_cmd == WILL)) {
+		in_eor = true;
+	    } else if (c == TELOPT_TN3270E &&
+		    (topt_cmd == DONT || topt_cmd == WONT)) {
+		in_tn3270e = false;
+	    }
+	    tstate = TS_DATA;
+	    break;
+	case TS_SB:
+	    if (sb_start && c == TELOPT_TN3270E) {
+		in_tn3270e = true;
+	    }
+	    sb_start = false;
+	    if (c == IAC) {
+		tstate = TS_SB_IAC;
+	    }
+	    break;
+	case TS_SB_IAC:
+	    tstate = (c == SE)? TS_DATA: TS_SB;
+	    break;
+	}
+    }
+    flush_nvt();
+}
+
+/* Return the value of a hex digit, or -1. */
+static int
+hexval(char c)
+{
+    static char hexes[] = "0123456789abcdef";
+    char *h;
+
+    if (c == '\0' || (h = strchr(hexes, c)) == NULL) {
+	return -1;
+    }
+    return (int)(h - hexes);
+}
+
+/* Fetch a big-endian number. */
+static size_t
+get_be(const unsigned char *buf, int len)
+{
+    size_t n = 0;
+
+    while (len--) {
+	n = (n << 8) | *buf++;
+    }
+    return n;
+}
+
+/*
+ * Load the host data records from a text or binary trace file.
+ *
+ * Returns false if the file cannot be read.
+ */
+static bool
+load_trace(const char *path)
+{
+    FILE *f;
+    char magic[TRB_MAGIC_LEN];
+    unsigned char *data = NULL;
+    size_t dsize = 0;
+    size_t dlen = 0;
+
+    if ((f = fopen(path, "rb")) == NULL) {
+	perror(path);
+	return false;
+    }
+    tstate = TS_DATA;
+    in_eor = false;
+    in_tn3270e = false;
+    rlen = 0;
+
+    if (fread(magic, TRB_MAGIC_LEN, 1, f) == 1 &&
+	    !memcmp(magic, TRB_MAGIC, TRB_MAGIC_LEN)) {
+	unsigned char hdr[TRB_HDR_LEN];
+
+	/* Binary trace. */
+	while (fread(hdr, TRB_HDR_LEN, 1, f) == 1) {
+	    size_t len = get_be(hdr + 13, 4);
+
+	    if (len > dsize) {
+		dsize = len;
+		data = (unsigned char *)Realloc(data, dsize);
+	    }
+	    if (len && fread(data, len, 1, f) != 1) {
+		break;
+	    }
+	    if (hdr[0] == TRB_HOST) {
+		host_data(data, len);
+	    }
+	}
+    } else {
+	char line[1024];
+
+	/* Text trace: one network read is a run of '<' lines. */
+	rewind(f);
+	while (fgets(line, sizeof(line), f) != NULL) {
+	    char *s;
+	    int hi, lo;
+
+	    if (strncmp(line, "< 0x", 4)) {
+		continue;
+	    }
+	    if (!strncmp(line, "< 0x0 ", 6) && dlen) {
+		host_data(data, dlen);
+		dlen = 0;
+	    }
+	    s = line + 4;
+	    while (hexval(*s) >= 0) {
+		s++;
+	    }
+	    while (*s == ' ' || *s == '\t') {
+		s++;
+	    }
+	    while ((hi = hexval(s[0])) >= 0 && (lo = hexval(s[1])) >= 0) {
+		if (dlen >= dsize) {
+		    dsize = dsize? dsize * 2: 4096;
+		    data = (unsigned char *)Realloc(data, dsize);
+		}
+		data[dlen++] = (unsigned char)((hi << 4) | lo);
+		s += 2;
+	    }
+	}
+	if (dlen) {
+	    host_data(data, dlen);
+	}
+    }
+    fclose(f);
+    Free(data);
+    return true;
+}
+
+/* Free the records. */
+static void
+free_records(void)
+{
+    size_t i;
+
+    for (i = 0; i < nrecords; i++) {
+	Free(records[i].data);
+    }
+    Free(records);
+    records = NULL;
+    nrecords = 0;
+    nbytes = 0;
+    nskipped = 0;
+}
+
+/* Returns true if all of the records are NVT data. */
+static bool
+nvt_only(void)
+{
+    size_t i;
+
+    for (i = 0; i < nrecords; i++) {
+	if (records[i].type != R_NVT) {
+	    return false;
+	}
+    }
+    return true;
+}
+
+/*
+ * Process each record once.
+ *
+ * Returns false if the host sent a data stream the emulator rejected.
+ */
+static bool
+run_records(void)
+{
+    bool ok = true;
+    size_t i;
+
+    for (i = 0; i < nrecords; i++) {
+	record_t *r = &records[i];
+
+	switch (r->type) {
+	case R_3270:
+	    if (process_ds(r->data, r->len, false) < 0) {
+		ok = false;
+	    }
+	    break;
+	case R_SSCP_LU:
+	    ctlr_write_sscp_lu(r->data, r->len);
+	    break;
+	case R_NVT:
+	    nvt_process_run(r->data, r->len);
+	    break;
+	}
+    }
+    return ok;
+}
+
+void
+usage(const char *msg)
+{
+    if (msg != NULL) {
+	fprintf(stderr, "%s\n", msg);
+    }
+    fprintf(stderr, "Usage: %s [-t seconds] [emulator-options --] "
+	    "trace-file...\n", app);
+    exit(1);
+}
+
+/* Set product-specific appres defaults. */
+void
+product_set_appres_defaults(void)
+{
+    appres.scripted = true;
+    appres.oerr_lock = true;
+}
+
+bool
+model_can_change(void)
+{
+    return true;
+}
+
+void
+screen_init(void)
+{
+}
+
+void
+screen_change_model(int mn, int ovc, int ovr)
+{
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char *cl_hostname = NULL;
+    double min_time = DEFAULT_TIME;
+    int first_file = 1;
+    int oargc;
+    const char **oargv;
+    int i;
+    unsigned long long total_records = 0;
+    unsigned long long total_bytes = 0;
+    double total_time = 0.0;
+
+    /* Pick off -t, and split the emulator options from the file names. */
+    if (argc > 2 && !strcmp(argv[1], "-t")) {
+	char *ptr;
+
+	min_time = strtod(argv[2], &ptr);
+	if (ptr == argv[2] || *ptr != '\0' || min_time <= 0.0) {
+	    usage("Invalid time");
+	}
+	argv[2] = argv[0];
+	argv += 2;
+	argc -= 2;
+    }
+    for (i = 1; i < argc; i++) {
+	if (!strcmp(argv[i], "--")) {
+	    first_file = i + 1;
+	    break;
+	}
+    }
+    if (first_file >= argc) {
+	usage(NULL);
+    }
+
+    /* Initialize the emulator, as s3270 does. */
+    s3270_modules_register(NULL);
+
+    /*
+     * parse_command_line() edits its argument vector, so give it a copy of
+     * just the emulator options.
+     */
+    oargc = (first_file > 1)? first_file - 1: 1;
+    oargv = (const char **)Malloc((oargc + 1) * sizeof(char *));
+    for (i = 0; i < oargc; i++) {
+	oargv[i] = argv[i];
+    }
+    oargv[oargc] = NULL;
+    if (parse_command_line(oargc, oargv, &cl_hostname) != 1 ||
+	    cl_hostname != NULL) {
+	usage("Unexpected emulator arguments");
+    }
+    if (codepage_init(appres.codepage) != CS_OKAY) {
+	fprintf(stderr, "Cannot find code page \"%s\"\n", appres.codepage);
+	exit(1);
+    }
+    model_init();
+    ctlr_init(ALL_CHANGE);
+    ctlr_reinit(ALL_CHANGE);
+    initialize_toggles();
+    host_in3270(CONNECTED_NVT_CHAR);
+
+    /* Time each file. */
+    for (i = first_file; i < argc; i++) {
+	const char *name;
+	unsigned long iterations = 0;
+	double start, elapsed;
+
+	if (!load_trace(argv[i])) {
+	    exit(1);
+	}
+	if ((name = strrchr(argv[i], '/')) != NULL) {
+	    name++;
+	} else {
+	    name = argv[i];
+	}
+	if (nrecords == 0) {
+	    printf("%-24s no usable host data\n", name);
+	    free_records();
+	    continue;
+	}
+
+	/*
+	 * Put the emulator in the mode the host data needs. Going into NVT
+	 * mode resets the NVT emulator.
+	 */
+	host_in3270(nvt_only()? CONNECTED_NVT_CHAR: CONNECTED_3270);
+
+	/*
+	 * Warm up, skipping files that contain deliberately bad data, then
+	 * repeat until the minimum time has passed.
+	 */
+	ctlr_erase(false);
+	if (!run_records()) {
+	    printf("%-24s data stream errors, skipped\n", name);
+	    free_records();
+	    continue;
+	}
+	start = now();
+	do {
+	    (void) run_records();
+	    iterations++;
+	} while ((elapsed = now() - start) < min_time);
+
+	printf("%-24s %5lu records %7lu bytes %4lu skipped: %10.0f records/s "
+		"%7.2f ns/byte\n", name, (unsigned long)nrecords,
+		(unsigned long)nbytes, nskipped,
+		(nrecords * iterations) / elapsed,
+		(elapsed * 1e9) / ((double)nbytes * iterations));
+	total_records += nrecords * iterations;
+	total_bytes += nbytes * iterations;
+	total_time += elapsed;
+	free_records();
+    }
+
+    if (total_time > 0.0) {
+	printf("%-24s %10.0f records/s %7.2f ns/byte\n", "Total:",
+		total_records / total_time,
+		(total_time * 1e9) / total_bytes);
+    }
+    return 0;
+}
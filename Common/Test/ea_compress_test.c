@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2022-2024 Paul Mattes.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the names of Paul Mattes nor the names of his contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ *      ea_compress_test.c
+ *              Compressed screen buffer row unit tests
+ */
+
+#include "globals.h"
+
+#include <assert.h>
+
+#include "3270ds.h"
+#include "ctlrc.h"
+#include "ea_compress.h"
+
+#define NCOLS	132
+
+static void blank_test(void);
+static void nvt_test(void);
+static void ebcdic_test(void);
+static void attrs_test(void);
+static void dbcs_test(void);
+static void unicode_test(void);
+static void short_test(void);
+
+static struct {
+    const char *name;
+    void (*function)(void);
+} test[] = {
+    { "Blank", blank_test },
+    { "NVT", nvt_test },
+    { "EBCDIC", ebcdic_test },
+    { "Attributes", attrs_test },
+    { "DBCS", dbcs_test },
+    { "Unicode", unicode_test },
+    { "Short", short_test },
+    { NULL, NULL }
+};
+
+int
+main(int argc, char *argv[])
+{
+    int i;
+    bool verbose = false;
+
+    if (argc > 1 && !strcmp(argv[1], "-v")) {
+	verbose = true;
+    }
+
+    /* Loop through the tests. */
+    for (i = 0; test[i].name != NULL; i++) {
+	(*test[i].function)();
+	if (verbose) {
+	    printf("%s test - PASS\n", test[i].name);
+	} else {
+	    printf(".");
+	    fflush(stdout);
+	}
+    }
+
+    /* Success. */
+    printf("\nPASS\n");
+    return 0;
+}
+
+/* Compress a row, expand it again and check that it is unchanged. */
+static size_t
+round_trip(const struct ea *row, int ncols)
+{
+    unsigned char z[EA_COMPRESS_MAX(NCOLS)];
+    struct ea out[NCOLS + 1];
+    size_t len;
+
+    len = ea_compress_row(row, ncols, z);
+    assert(len <= EA_COMPRESS_MAX(ncols));
+    memset(out, 0xff, sizeof(out));
+    ea_expand_row(z, out, ncols);
+    assert(!memcmp(row, out, ncols * sizeof(struct ea)));
+
+    /* Nothing past the end of the row is touched. */
+    assert(out[ncols].ec == 0xff);
+    return len;
+}
+
+/* Blank row test. */
+static void
+blank_test(void)
+{
+    struct ea row[NCOLS];
+
+    memset(row, 0, sizeof(row));
+    assert(round_trip(row, NCOLS) < 16);
+}
+
+/* NVT text test. */
+static void
+nvt_test(void)
+{
+    const char *text = "$ ls -l /usr/local/bin";
+    struct ea row[NCOLS];
+    size_t i;
+
+    memset(row, 0, sizeof(row));
+    for (i = 0; i < strlen(text); i++) {
+	row[i].ucs4 = text[i];
+	row[i].fg = HOST_COLOR_GREEN;
+    }
+    assert(round_trip(row, NCOLS) < strlen(text) + 32);
+}
+
+/* EBCDIC test, with both the EBCDIC and the Unicode values set. */
+static void
+ebcdic_test(void)
+{
+    struct ea row[NCOLS];
+    int i;
+
+    memset(row, 0, sizeof(row));
+    for (i = 0; i < NCOLS; i++) {
+	row[i].ec = 0x40 + (i % 0x80);
+	if (i % 3) {
+	    row[i].ucs4 = 0x20 + i;
+	}
+    }
+    round_trip(row, NCOLS);
+}
+
+/* Mixed attributes test, including repeats between other runs. */
+static void
+attrs_test(void)
+{
+    struct ea row[NCOLS];
+    int i;
+
+    memset(row, 0, sizeof(row));
+    for (i = 0; i < NCOLS; i++) {
+	row[i].ec = (i % 10 < 5)? 0x40: 0xc1 + (i % 9);
+	row[i].fa = (i % 20)? 0: 0xe0 | (i % 8);
+	row[i].fg = (i / 7) % 16;
+	row[i].bg = (i / 11) % 16;
+	row[i].gr = (i / 13) % 16;
+	row[i].cs = (i / 17) % 4;
+	row[i].ic = (i / 19) % 2;
+    }
+    round_trip(row, NCOLS);
+}
+
+/* DBCS test. */
+static void
+dbcs_test(void)
+{
+    struct ea row[NCOLS];
+    int i;
+
+    memset(row, 0, sizeof(row));
+    row[0].ec = 0x0e;
+    for (i = 1; i < NCOLS - 2; i += 2) {
+	row[i].ec = 0x44;
+	row[i].ucs4 = 0x4e00 + i;
+	row[i].db = DBCS_LEFT;
+	row[i + 1].ec = 0x5a;
+	row[i + 1].db = DBCS_RIGHT;
+    }
+    row[i].ec = 0x0f;
+    row[i].db = DBCS_SI;
+    round_trip(row, NCOLS);
+}
+
+/* Unicode test, with characters of every UTF-8 length. */
+static void
+unicode_test(void)
+{
+    static ucs4_t u[] = { 0x41, 0xe9, 0x20ac, 0x1f600, 0x10ffff };
+    struct ea row[NCOLS];
+    int i;
+
+    memset(row, 0, sizeof(row));
+    for (i = 0; i < NCOLS; i++) {
+	row[i].ucs4 = u[(i / 5) % (sizeof(u) / sizeof(u[0]))];
+    }
+    round_trip(row, NCOLS);
+}
+
+/* Short row and long repeat test. */
+static void
+short_test(void)
+{
+    struct ea row[NCOLS];
+    int i;
+
+    memset(row, 0, sizeof(row));
+    for (i = 0; i < NCOLS; i++) {
+	row[i].ucs4 = (i < 3)? 'x': ' ';
+    }
+    round_trip(row, 1);
+    round_trip(row, 3);
+    round_trip(row, 4);
+    assert(round_trip(row, NCOLS) < 32);
+}
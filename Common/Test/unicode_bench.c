@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2025 Paul Mattes.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the names of Paul Mattes nor the names of his contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *	unicode_bench.c
+ *		EBCDIC/Unicode translation benchmark.
+ */
+
+#include "globals.h"
+
+#include <assert.h>
+#include <time.h>
+
+#include "unicodec.h"
+#include "unicode_dbcs.h"
+#include "utf8.h"
+
+/* Default number of characters to translate per code page. */
+#define DEFAULT_CHARS	(4 * 1024 * 1024)
+
+/* Stub. */
+void
+Error(const char *s)
+{
+    fprintf(stderr, "%s\n", s);
+    exit(1);
+}
+
+/* Return the current time in seconds. */
+static double
+now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/* Results of DBCS translations, so they are not optimized away. */
+static volatile unsigned long dbcs_sink;
+
+/* Time the DBCS translations for a code page. */
+static void
+bench_dbcs(const char *cpname, unsigned long nchars)
+{
+    const char *codepage;
+    ebc_t *codes = (ebc_t *)Malloc(0x10000 * sizeof(ebc_t));
+    ucs4_t *uc = (ucs4_t *)Malloc(0x10000 * sizeof(ucs4_t));
+    unsigned long ncodes = 0;
+    unsigned long j, k;
+    double start, t_d2u, t_u2d;
+    ebc_t e;
+
+    if (!set_uni_dbcs(cpname, &codepage)) {
+	fprintf(stderr, "%s: set_uni_dbcs failed\n", cpname);
+	exit(1);
+    }
+
+    /* Collect the defined codes. */
+    for (e = 0x4141; e <= 0xfefe; e++) {
+	ucs4_t u = ebcdic_dbcs_to_unicode(e, EUO_NONE);
+
+	if (u != 0) {
+	    codes[ncodes] = e;
+	    uc[ncodes++] = u;
+	}
+    }
+    assert(ncodes > 0);
+
+    /* Cycle through the codes, skipping around. */
+    start = now();
+    for (j = k = 0; j < nchars; j++) {
+	dbcs_sink += ebcdic_dbcs_to_unicode(codes[k], EUO_NONE);
+	if ((k += 7) >= ncodes) {
+	    k -= ncodes;
+	}
+    }
+    t_d2u = now() - start;
+
+    start = now();
+    for (j = k = 0; j < nchars; j++) {
+	dbcs_sink += unicode_to_ebcdic_dbcs(uc[k]);
+	if ((k += 7) >= ncodes) {
+	    k -= ncodes;
+	}
+    }
+    t_u2d = now() - start;
+
+    printf("%-22s %lu DBCS codes, ns/char: ebcdic_dbcs_to_unicode %.1f, "
+	    "unicode_to_ebcdic_dbcs %.1f\n", cpname, ncodes,
+	    t_d2u * 1e9 / nchars, t_u2d * 1e9 / nchars);
+    Free(codes);
+    Free(uc);
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned long nchars = DEFAULT_CHARS;
+    cpname_t *cpnames;
+    ucs4_t *text;
+    unsigned char *ebc;
+    char *mb;
+    char *utf8;
+    ucs4_t *ucs4;
+    int i;
+
+    if (argc > 1) {
+	nchars = strtoul(argv[1], NULL, 10);
+	if (nchars == 0) {
+	    fprintf(stderr, "usage: %s [characters]\n", argv[0]);
+	    exit(1);
+	}
+    }
+
+    set_codeset("UTF-8", true);
+    text = (ucs4_t *)Malloc(nchars * sizeof(ucs4_t));
+    ebc = (unsigned char *)Malloc(nchars);
+    mb = (char *)Malloc((nchars * 4) + 1);
+    utf8 = (char *)Malloc(nchars * 6);
+    ucs4 = (ucs4_t *)Malloc(nchars * sizeof(ucs4_t));
+    cpnames = get_cpnames();
+    for (i = 0; cpnames[i].name != NULL; i++) {
+	const char *host_codepage, *cgcsgid;
+	ucs4_t charset[256];
+	int ncharset = 0;
+	double start, t_ebc, t_ge, t_mbs, t_mbx, t_mbe, t_mbu;
+	unsigned long j;
+	size_t utf8_len;
+	enum me_fail error;
+	bool truncated;
+	ebc_t e;
+
+	if (!set_uni(cpnames[i].name, -1, &host_codepage, &cgcsgid, NULL, NULL,
+		    NULL)) {
+	    fprintf(stderr, "%s: set_uni failed\n", cpnames[i].name);
+	    exit(1);
+	}
+
+	/*
+	 * Collect the characters in the code page, checking that each one
+	 * translates back to an EBCDIC code with the same translation.
+	 */
+	for (e = 0x40; e < 0xff; e++) {
+	    ucs4_t u = ebcdic_base_to_unicode(e, EUO_NONE);
+
+	    if (u != 0) {
+		assert(ebcdic_base_to_unicode(unicode_to_ebcdic(u), EUO_NONE)
+			== u);
+		charset[ncharset++] = u;
+	    }
+	}
+
+	/* Build the text by cycling through the characters. */
+	for (j = 0; j < nchars; j++) {
+	    text[j] = charset[(j * 7) % ncharset];
+	    ebc[j] = (unsigned char)unicode_to_ebcdic(text[j]);
+	}
+
+	start = now();
+	for (j = 0; j < nchars; j++) {
+	    (void) unicode_to_ebcdic(text[j]);
+	}
+	t_ebc = now() - start;
+
+	start = now();
+	for (j = 0; j < nchars; j++) {
+	    bool ge;
+
+	    (void) unicode_to_ebcdic_ge(text[j], &ge, false);
+	}
+	t_ge = now() - start;
+
+	/* Translate back, as a string and one character at a time. */
+	start = now();
+	(void) ebcdic_to_multibyte_string(ebc, nchars, mb, (nchars * 4) + 1);
+	t_mbs = now() - start;
+
+	start = now();
+	for (j = 0; j < nchars; j++) {
+	    char xmb[16];
+	    ucs4_t uc;
+
+	    (void) ebcdic_to_multibyte_x(ebc[j], CS_BASE, xmb, sizeof(xmb),
+		    EUO_BLANK_UNDEF, &uc);
+	    assert(uc == text[j]);
+	}
+	t_mbx = now() - start;
+
+	/*
+	 * Translate alphanumeric text, the common case for String() and file
+	 * transfer, from UTF-8.
+	 */
+	for (j = 0; j < nchars; j++) {
+	    static const char alnum[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789";
+
+	    utf8[j] = alnum[j % (sizeof(alnum) - 1)];
+	}
+	utf8_len = nchars;
+
+	start = now();
+	assert(multibyte_to_ebcdic_string(utf8, utf8_len, ebc, nchars, &error,
+		    &truncated) == (ssize_t)nchars);
+	t_mbe = now() - start;
+
+	start = now();
+	assert(multibyte_to_unicode_string(utf8, utf8_len, ucs4, nchars, false)
+		== (int)nchars);
+	t_mbu = now() - start;
+
+	printf("%-22s %lu chars, ns/char: unicode_to_ebcdic %.1f, "
+		"unicode_to_ebcdic_ge %.1f, ebcdic_to_multibyte_string %.1f, "
+		"ebcdic_to_multibyte_x %.1f, alphanumeric multibyte_to_ebcdic_string "
+		"%.1f, alphanumeric multibyte_to_unicode_string %.1f\n",
+		cpnames[i].name, nchars, t_ebc * 1e9 / nchars,
+		t_ge * 1e9 / nchars, t_mbs * 1e9 / nchars,
+		t_mbx * 1e9 / nchars, t_mbe * 1e9 / nchars,
+		t_mbu * 1e9 / nchars);
+
+	if (cpnames[i].dbcs) {
+	    bench_dbcs(cpnames[i].name, nchars);
+	}
+    }
+    free_cpnames(cpnames);
+    Free(text);
+    Free(ebc);
+    Free(mb);
+    Free(utf8);
+    Free(ucs4);
+
+    return 0;
+}
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2025 Paul Mattes.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the names of Paul Mattes nor the names of his contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *	unicode_test.c
+ *		Conformance tests for the bulk EBCDIC/multi-byte string
+ *		translations.
+ */
+
+#include "globals.h"
+
+#include <assert.h>
+
+#include "3270ds.h"
+#include "unicodec.h"
+#include "unicode_dbcs.h"
+#include "utf8.h"
+
+#define MAX_CHARSET	512	/* characters sampled from a code page */
+#define TEXT_CHARS	600	/* characters in each test string */
+#define TEXTS		40	/* test strings per code page */
+
+/* Stub. */
+void
+Error(const char *s)
+{
+    fprintf(stderr, "%s\n", s);
+    exit(1);
+}
+
+/* Pseudo-random number generator, so failures are repeatable. */
+static unsigned long seed = 1;
+
+static unsigned
+rnd(unsigned n)
+{
+    seed = (seed * 1103515245UL) + 12345UL;
+    return (unsigned)((seed >> 16) % n);
+}
+
+/*
+ * Reference translation of a multi-byte string to UCS-4, one character at a
+ * time.
+ */
+static int
+ref_multibyte_to_unicode_string(const char *mb, size_t mb_len, ucs4_t *ucs4,
+	size_t u_len, bool force_utf8)
+{
+    int consumed;
+    enum me_fail error = ME_NONE;
+    int nr = 0;
+
+    while (u_len && mb_len &&
+	    (*ucs4++ = multibyte_to_unicode_f(mb, mb_len, &consumed,
+					    &error, force_utf8)) != 0) {
+	u_len--;
+	mb += consumed;
+	mb_len -= consumed;
+	nr++;
+    }
+    return (error != ME_NONE)? -1: nr;
+}
+
+/*
+ * Reference translation of a multi-byte string to EBCDIC, one character at a
+ * time.
+ */
+static ssize_t
+ref_multibyte_to_ebcdic_string(const char *mb, size_t mb_len,
+	unsigned char *ebc, size_t ebc_len, enum me_fail *errorp,
+	bool *truncated)
+{
+    size_t ne = 0;
+    bool in_dbcs = false;
+
+    *truncated = false;
+    while (mb_len > 0 && ebc_len > 0) {
+	ebc_t e;
+	int consumed;
+
+	e = multibyte_to_ebcdic(mb, mb_len, &consumed, errorp);
+	if (e == 0) {
+	    return -1;
+	}
+	if (e & 0xff00) {
+	    if (!in_dbcs) {
+		if (ebc_len < 4) {
+		    *truncated = true;
+		    return ne;
+		}
+		*ebc++ = EBC_so;
+		ebc_len++;
+		ne++;
+		in_dbcs = true;
+	    }
+	    if (ebc_len < 3) {
+		*ebc++ = EBC_si;
+		ne++;
+		*truncated = true;
+		return ne;
+	    }
+	    *ebc++ = (e >> 8) & 0xff;
+	    *ebc++ = e & 0xff;
+	    ebc_len -= 2;
+	    ne += 2;
+	} else {
+	    if (in_dbcs) {
+		*ebc++ = EBC_si;
+		ne++;
+		if (!--ebc_len) {
+		    *truncated = true;
+		    return ne;
+		}
+		in_dbcs = false;
+	    }
+	    *ebc++ = e & 0xff;
+	    ebc_len--;
+	    ne++;
+	}
+	mb += consumed;
+	mb_len -= consumed;
+    }
+    if (in_dbcs) {
+	*ebc++ = EBC_si;
+	ne++;
+    }
+    if (mb_len > 0) {
+	*truncated = true;
+    }
+    return ne;
+}
+
+/*
+ * Reference translation of an EBCDIC string to multi-byte, one character at a
+ * time.
+ */
+static size_t
+ref_ebcdic_to_multibyte_string(unsigned char *ebc, size_t ebc_len, char mb[],
+	size_t mb_len)
+{
+    size_t nmb = 0;
+
+    while (ebc_len && mb_len) {
+	size_t xlen = ebcdic_to_multibyte(*ebc, mb, mb_len);
+
+	if (xlen) {
+	    mb += xlen - 1;
+	    mb_len -= (xlen - 1);
+	    nmb += xlen - 1;
+	}
+	ebc++;
+	ebc_len--;
+    }
+    return nmb;
+}
+
+/* Compare the multi-byte to UCS-4 translations of a string. */
+static void
+check_to_unicode(const char *mb, size_t mb_len, size_t u_len, bool force_utf8)
+{
+    ucs4_t bulk[TEXT_CHARS * 2], ref[TEXT_CHARS * 2];
+    int nb, nr;
+
+    assert(u_len <= TEXT_CHARS * 2);
+    memset(bulk, 0, sizeof(bulk));
+    memset(ref, 0, sizeof(ref));
+    nb = multibyte_to_unicode_string(mb, mb_len, bulk, u_len, force_utf8);
+    nr = ref_multibyte_to_unicode_string(mb, mb_len, ref, u_len, force_utf8);
+    assert(nb == nr);
+    assert(!memcmp(bulk, ref, sizeof(bulk)));
+}
+
+/* Compare the multi-byte to EBCDIC translations of a string. */
+static void
+check_to_ebcdic(const char *mb, size_t mb_len, size_t ebc_len)
+{
+    unsigned char bulk[TEXT_CHARS * 4], ref[TEXT_CHARS * 4];
+    enum me_fail eb = ME_NONE, er = ME_NONE;
+    bool tb, tr;
+    ssize_t nb, nr;
+
+    assert(ebc_len <= TEXT_CHARS * 3);
+    memset(bulk, 0, sizeof(bulk));
+    memset(ref, 0, sizeof(ref));
+    nb = multibyte_to_ebcdic_string(mb, mb_len, bulk, ebc_len, &eb, &tb);
+    nr = ref_multibyte_to_ebcdic_string(mb, mb_len, ref, ebc_len, &er, &tr);
+    assert(nb == nr);
+    assert(eb == er);
+    if (nb >= 0) {
+	assert(tb == tr);
+    }
+    assert(!memcmp(bulk, ref, sizeof(bulk)));
+}
+
+/* Compare the EBCDIC to multi-byte translations of a string. */
+static void
+check_to_multibyte(unsigned char *ebc, size_t ebc_len, size_t mb_len)
+{
+    char bulk[TEXT_CHARS * 8], ref[TEXT_CHARS * 8];
+
+    assert(mb_len <= sizeof(bulk));
+    memset(bulk, 0, sizeof(bulk));
+    memset(ref, 0, sizeof(ref));
+    assert(ebcdic_to_multibyte_string(ebc, ebc_len, bulk, mb_len) ==
+	    ref_ebcdic_to_multibyte_string(ebc, ebc_len, ref, mb_len));
+    assert(!memcmp(bulk, ref, sizeof(bulk)));
+}
+
+/* Run the tests for the current code page. */
+static void
+test_codepage(ucs4_t *charset, int ncharset)
+{
+    char mb[TEXT_CHARS * 6];
+    unsigned char ebc[256];
+    int t;
+    int i;
+
+    for (t = 0; t < TEXTS; t++) {
+	size_t mb_len = 0;
+	size_t nchars = 0;
+
+	/*
+	 * Build a string with runs of ASCII of random lengths, broken up by
+	 * other characters from the code page.
+	 */
+	while (nchars < TEXT_CHARS) {
+	    unsigned run = rnd(40);
+	    unsigned j;
+
+	    for (j = 0; j < run && nchars < TEXT_CHARS; j++) {
+		mb[mb_len++] = (t & 1)? 0x20 + rnd(0x5f): 'A' + rnd(26);
+		nchars++;
+	    }
+	    if (nchars < TEXT_CHARS) {
+		mb_len += unicode_to_utf8(charset[rnd(ncharset)],
+			mb + mb_len);
+		nchars++;
+	    }
+	}
+
+	/* Whole strings. */
+	check_to_unicode(mb, mb_len, TEXT_CHARS * 2, false);
+	check_to_unicode(mb, mb_len, TEXT_CHARS * 2, true);
+	check_to_ebcdic(mb, mb_len, TEXT_CHARS * 3);
+
+	/* Short output buffers. */
+	check_to_unicode(mb, mb_len, 1 + rnd(TEXT_CHARS), false);
+	check_to_ebcdic(mb, mb_len, 1 + rnd(TEXT_CHARS));
+
+	/* Strings with an embedded NUL or a stray byte. */
+	i = rnd((int)mb_len);
+	mb[i] = (t & 1)? '\0': '\x80';
+	check_to_unicode(mb, mb_len, TEXT_CHARS * 2, false);
+	check_to_ebcdic(mb, mb_len, TEXT_CHARS * 3);
+    }
+
+    /* Every EBCDIC code, in order and shuffled. */
+    for (i = 0; i < 256; i++) {
+	ebc[i] = (unsigned char)i;
+    }
+    check_to_multibyte(ebc, 256, TEXT_CHARS * 8);
+    for (t = 0; t < TEXTS; t++) {
+	for (i = 0; i < 256; i++) {
+	    ebc[i] = (unsigned char)rnd(256);
+	}
+	check_to_multibyte(ebc, 256, TEXT_CHARS * 8);
+	check_to_multibyte(ebc, 256, 1 + rnd(512));
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    cpname_t *cpnames;
+    int i;
+    bool verbose = false;
+
+    if (argc > 1 && !strcmp(argv[1], "-v")) {
+	verbose = true;
+    }
+
+    set_codeset("UTF-8", true);
+    cpnames = get_cpnames();
+    for (i = 0; cpnames[i].name != NULL; i++) {
+	const char *host_codepage, *cgcsgid;
+	ucs4_t charset[MAX_CHARSET];
+	int ncharset = 0;
+	ebc_t e;
+
+	if (!set_uni(cpnames[i].name, -1, &host_codepage, &cgcsgid, NULL, NULL,
+		    NULL)) {
+	    fprintf(stderr, "%s: set_uni failed\n", cpnames[i].name);
+	    exit(1);
+	}
+	if (!cpnames[i].dbcs || !set_uni_dbcs(cpnames[i].name, &host_codepage)) {
+	    (void) set_uni_dbcs("", &host_codepage);
+	}
+
+	/* Collect the non-ASCII characters in the code page. */
+	for (e = 0x41; e <= 0xfe; e++) {
+	    ucs4_t u = ebcdic_base_to_unicode(e, EUO_NONE);
+
+	    if (u >= 0x80) {
+		charset[ncharset++] = u;
+	    }
+	}
+
+	/* Add some DBCS characters. */
+	for (e = 0x4141; e < 0x4300 && ncharset < MAX_CHARSET; e++) {
+	    ucs4_t u = ebcdic_dbcs_to_unicode(e, EUO_NONE);
+
+	    if (u != 0 && (unicode_to_ebcdic(u) & 0xff00)) {
+		charset[ncharset++] = u;
+	    }
+	}
+	assert(ncharset > 0);
+
+	test_codepage(charset, ncharset);
+	if (verbose) {
+	    printf("%s test - PASS\n", cpnames[i].name);
+	} else {
+	    printf(".");
+	    fflush(stdout);
+	}
+    }
+    free_cpnames(cpnames);
+
+    /* Success. */
+    printf("\nPASS\n");
+    return 0;
+}
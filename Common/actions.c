@@ -49,6 +49,7 @@
 
 llist_t actions_list = LLIST_INIT(actions_list);
 unsigned actions_list_count;
+unsigned actions_generation;	/* bumped whenever actions are registered */
 
 enum iaction ia_cause;
 const char *ia_name[] = {
@@ -178,7 +179,7 @@ action_debug(const char *aname, ia_t ia, unsigned argc, const char **argv)
 {
     unsigned i;
 
-    if (!toggled(TRACING)) {
+    if (!trace_on(TC_EVENT)) {
 	return;
     }
     vtrace("%s -> %s(", ia_name[(int)ia], aname);
@@ -348,6 +349,7 @@ register_actions(action_table_t *new_actions, unsigned count)
 	    if (cmp == 0) {
 		/* Replace. */
 		e->t = new_actions[i]; /* struct copy */
+		actions_generation++;
 		return;
 	    } else if (cmp < 0) {
 		/* Goes ahead of this one. */
@@ -369,6 +371,7 @@ register_actions(action_table_t *new_actions, unsigned count)
 	}
 
 	actions_list_count++;
+	actions_generation++;
     }
 }
 
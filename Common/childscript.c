@@ -358,7 +358,7 @@ delayed_close(ioid_t id)
 
     FOREACH_LLIST(&delayed_closes, dc, delayed_close_t *) {
 	if (dc->id == id) {
-	    vtrace("Delayed shutdown of listeners\n");
+	    vctrace(TC_SCRIPT, "Delayed shutdown of listeners\n");
 	    close_listeners(&dc->listeners);
 	    llist_unlink(&dc->llist);
 	    Free(dc);
@@ -366,7 +366,7 @@ delayed_close(ioid_t id)
 	}
     } FOREACH_LLIST_END(&delayed_closes, dc, delayed_close_t *);
 
-    vtrace("Error: Delayed shutdown record not found\n");
+    vctrace(TC_SCRIPT, "Error: Delayed shutdown record not found\n");
 }
 
 /**
@@ -455,9 +455,9 @@ child_input(iosrc_t fd _is_unused, ioid_t id)
     n2r = sizeof(buf);
     nr = read(c->infd, buf, (int)n2r);
     assert(nr >= 0);
-    vtrace("%s input complete, nr=%d\n", c->parent_name, (int)nr);
+    vctrace(TC_SCRIPT, "%s input complete, nr=%d\n", c->parent_name, (int)nr);
     if (nr == 0) {
-	vtrace("%s script EOF\n", c->parent_name);
+	vctrace(TC_SCRIPT, "%s script EOF\n", c->parent_name);
 	close_child(c);
 	if (c->exit_id == NULL_IOID) {
 	    c->done = true;
@@ -521,9 +521,10 @@ child_stdout(iosrc_t fd _is_unused, ioid_t id)
     n2r = sizeof(buf);
     nr = read(fd, buf, (int)n2r);
     assert(nr >= 0);
-    vtrace("%s stdout read complete, nr=%d\n", c->parent_name, (int)nr);
+    vctrace(TC_SCRIPT, "%s stdout read complete, nr=%d\n", c->parent_name,
+	(int)nr);
     if (nr == 0) {
-	vtrace("%s script stdout EOF\n", c->parent_name);
+	vctrace(TC_SCRIPT, "%s script stdout EOF\n", c->parent_name);
 	RemoveInput(c->stdout_id);
 	c->stdout_id = NULL_IOID;
 	close(c->stdoutpipe);
@@ -554,9 +555,9 @@ check_write(int fd, const char *data, size_t len, const char *sender)
 
     if (nw != (ssize_t)len) {
 	if (nw < 0) {
-	    vtrace("%s write: %s\n", sender, strerror(errno));
+	    vctrace(TC_SCRIPT, "%s write: %s\n", sender, strerror(errno));
 	} else {
-	    vtrace("%s: short write\n", sender);
+	    vctrace(TC_SCRIPT, "%s: short write\n", sender);
 	}
     }
 }
@@ -625,7 +626,7 @@ child_done(task_cbh handle, bool success, bool abort)
 
     if (abort || !c->enabled) {
 	close_listeners(&c->listeners);
-	vtrace("%s terminating script process\n", c->parent_name);
+	vctrace(TC_SCRIPT, "%s terminating script process\n", c->parent_name);
 	kill(c->pid, SIGTERM);
 	if (c->keyboard_lock) {
 	    disable_keyboard(ENABLE, IMPLICIT, AnScript "() abort");
@@ -654,7 +655,7 @@ child_done(task_cbh handle, bool success, bool abort)
 
     if (abort) {
 	close_listeners(&c->listeners);
-	vtrace("%s terminating script process\n", c->parent_name);
+	vctrace(TC_SCRIPT, "%s terminating script process\n", c->parent_name);
 	TerminateProcess(c->child_handle, 1);
 	if (c->keyboard_lock) {
 	    disable_keyboard(ENABLE, IMPLICIT, AnScript "() abort");
@@ -725,10 +726,11 @@ cr_collect(child_t *c)
 {
     cr_t *cr = &c->cr;
     if (cr->nr != 0) {
-	vtrace("Got %d bytes of script stdout/stderr\n", (int)cr->nr);
+	vctrace(TC_SCRIPT, "Got %d bytes of script stdout/stderr\n",
+	    (int)cr->nr);
 	if (cr->nr == 2 && !strncmp(cr->buf, "^C", 2)) {
 	    /* Hack, hack, hack. */
-	    vtrace("Suppressing '^C' output from child\n");
+	    vctrace(TC_SCRIPT, "Suppressing '^C' output from child\n");
 	} else {
 	    c->output_buf = Realloc(c->output_buf,
 		    c->output_buflen + cr->nr + 1);
@@ -742,7 +744,7 @@ cr_collect(child_t *c)
     }
     if (cr->dead) {
 	if (cr->error != 0) {
-	    vtrace("Script stdout/stderr read failed: %s\n",
+	    vctrace(TC_SCRIPT, "Script stdout/stderr read failed: %s\n",
 		    win32_strerror(cr->error));
 	}
 	cr->collected_eof = true;
@@ -773,7 +775,7 @@ child_run(task_cbh handle, bool *success)
 
 	if (!cr->collected_eof) {
 	    do {
-		vtrace("Waiting for child final stdout/stderr\n");
+		vctrace(TC_SCRIPT, "Waiting for child final stdout/stderr\n");
 		WaitForSingleObject(cr->done_event, INFINITE);
 	    } while (cr_collect(c));
 	}
@@ -956,11 +958,11 @@ child_exited(ioid_t id, int status)
     } FOREACH_LLIST_END(&child_scripts, c, child_t *);
 
     if (!found_child) {
-	vtrace("child_exited: no match\n");
+	vctrace(TC_SCRIPT, "child_exited: no match\n");
 	return;
     }
 
-    vtrace("%s script %d exited with status %d\n",
+    vctrace(TC_SCRIPT, "%s script %d exited with status %d\n",
 	    (c->child_name != NULL) ? c->child_name : "socket",
 	    (int)c->pid, status);
 
@@ -994,7 +996,7 @@ child_exited(iosrc_t fd _is_unused, ioid_t id _is_unused)
     } FOREACH_LLIST_END(&child_scripts, c, child_t *);
 
     if (!found_child) {
-	vtrace("child_exited: no match\n");
+	vctrace(TC_SCRIPT, "child_exited: no match\n");
 	return;
     }
 
@@ -1003,7 +1005,7 @@ child_exited(iosrc_t fd _is_unused, ioid_t id _is_unused)
 	popup_an_error("GetExitCodeProcess failed: %s",
 	win32_strerror(GetLastError()));
     } else if (status != STILL_ACTIVE) {
-	vtrace("%s script exited with status %d\n", c->parent_name,
+	vctrace(TC_SCRIPT, "%s script exited with status %d\n", c->parent_name,
 		(unsigned)status);
 	c->exit_status = status;
 	if (status != 0) {
@@ -1462,7 +1464,8 @@ Script_action(ia_t ia, unsigned argc, const char **argv)
     c->keyboard_lock = keyboard_lock;
     name = push_cb(NULL, 0, async? &async_script_cb: &script_cb, (task_cbh)c);
     Replace(c->parent_name, NewString(name));
-    vtrace("%s script process is %d\n", c->parent_name, (int)c->pid);
+    vctrace(TC_SCRIPT, "%s script process is %d\n", c->parent_name,
+	(int)c->pid);
 
     if (keyboard_lock) {
 	disable_keyboard(DISABLE, IMPLICIT, AnScript "() start");
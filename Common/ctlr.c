@@ -97,6 +97,9 @@ bool formatted = false;	/* set in screen_disp */
 bool screen_changed = false;
 int first_changed = -1;
 int last_changed = -1;
+unsigned long ctlr_generation = 1; /* bumped whenever ea_buf changes */
+unsigned long *ctlr_row_generation; /* ctlr_generation when each row last
+				       changed */
 unsigned char reply_mode = SF_SRM_FIELD;
 int crm_nattr = 0;
 unsigned char crm_attr[16];
@@ -104,6 +107,9 @@ bool dbcs = false;
 
 /* Statics */
 static unsigned char *zero_buf;	/* empty buffer, for area clears */
+static struct ea *ea_base;	/* start of ea_buf's allocation */
+static struct ea *aea_base;	/* start of aea_buf's allocation */
+static int ea_slide;		/* cells ea_buf can slide past its base */
 static void set_formatted(void);
 static void ctlr_blanks(void);
 static bool trace_primed = false;
@@ -119,6 +125,7 @@ static void ctlr_add_ic(int baddr, unsigned char ic);
 static bool ctlr_initted = false;
 
 static void ticking_stop(struct timeval *tp);
+static void rows_changed(int first, int last);
 
 /*
  * code_table is used to translate buffer addresses and attributes to the 3270
@@ -139,9 +146,11 @@ static unsigned char code_table[64] = {
 
 #define ALL_CHANGED	{ \
 	screen_changed = true; \
+	rows_changed(0, ROWS*COLS); \
 	if (IN_NVT) { first_changed = 0; last_changed = ROWS*COLS; } }
 #define REGION_CHANGED(f, l)	{ \
 	screen_changed = true; \
+	rows_changed(f, l); \
 	if (IN_NVT) { \
 	    if (first_changed == -1 || f < first_changed) first_changed = f; \
 	    if (last_changed == -1 || l > last_changed) last_changed = l; } }
@@ -198,15 +207,21 @@ ctlr_reinit(unsigned cmask)
 	if (real_ea_buf) {
 	    Free((char *)real_ea_buf);
 	}
+	/*
+	 * The buffers have room for another screenful of rows, so
+	 * ctlr_scroll() can slide ea_buf down a row instead of moving every
+	 * cell.
+	 */
+	ea_slide = maxROWS * maxCOLS;
 	real_ea_buf = (struct ea *)Calloc(sizeof(struct ea),
-		(maxROWS * maxCOLS) + 1);
-	ea_buf = real_ea_buf + 1;
+		(maxROWS * maxCOLS) + ea_slide + 1);
+	ea_buf = ea_base = real_ea_buf + 1;
 	if (real_aea_buf) {
 	    Free((char *)real_aea_buf);
 	}
 	real_aea_buf = (struct ea *)Calloc(sizeof(struct ea),
-		(maxROWS * maxCOLS) + 1);
-	aea_buf = real_aea_buf + 1;
+		(maxROWS * maxCOLS) + ea_slide + 1);
+	aea_buf = aea_base = real_aea_buf + 1;
 #if defined(CHECK_AEA_BUF) /*[*/
 	ea_sum = 0;
 	aea_sum = 0;
@@ -220,6 +235,9 @@ ctlr_reinit(unsigned cmask)
 	ea_buf[-1].ic  = 1;
 	aea_buf[-1].fa = FA_PRINTABLE | FA_MODIFY;
 	aea_buf[-1].ic = 1;
+	Replace(ctlr_row_generation,
+		(unsigned long *)Calloc(sizeof(unsigned long), maxROWS));
+	rows_changed(0, maxROWS * maxCOLS);
     }
 }
 
@@ -666,6 +684,9 @@ process_ds(unsigned char *buf, size_t buflen, bool kybd_restore)
     if (kybd_restore) {
 	restore_keyboard();
     }
+    if (rv < 0) {
+	trace_flight_dump("3270 data stream error");
+    }
     return rv;
 }
 
@@ -2466,6 +2487,9 @@ ctlr_dbcs_postprocess(void)
 	return 0;
     }
 
+    /* The DBCS states and SI/SO positions below may change. */
+    rows_changed(0, ROWS * COLS);
+
     /*
      * Find the field attribute for location 0.  If unformatted, it's the
      * dummy at -1.  Also compute the starting and ending points for the
@@ -2715,6 +2739,55 @@ ctlr_add(int baddr, unsigned char c, unsigned char cs)
     }
 }
 
+/*
+ * Change a run of characters in the 3270 buffer, EBCDIC mode, as if typed
+ * one at a time with ctlr_add(), ctlr_add_fg(0) and ctlr_add_gr(0).
+ * The run must not wrap around the end of the buffer. The changed region is
+ * noted once.
+ */
+void
+ctlr_add_run(int baddr, const unsigned char *c, const unsigned char *cs,
+	int count)
+{
+    int first = -1;
+    int last = -1;
+    int i;
+
+    for (i = 0; i < count; i++) {
+	struct ea *ea = &ea_buf[baddr + i];
+	unsigned char fg = mode3279? 0: ea->fg;
+	bool char_changed = ea->fa || ea->ucs4 || ea->ec != c[i] ||
+	    ea->cs != cs[i];
+
+	if (!char_changed && ea->fg == fg && !ea->gr) {
+	    continue;
+	}
+	if (char_changed && trace_primed && !IsBlank(ea->ec)) {
+	    if (toggled(SCREEN_TRACE)) {
+		trace_screen(false);
+	    }
+	    scroll_save(maxROWS);
+	    trace_primed = false;
+	}
+	if (screen_selected(baddr + i)) {
+	    unselect(baddr + i, 1);
+	}
+	ea->ec = c[i];
+	ea->cs = cs[i];
+	ea->fa = 0;
+	ea->ucs4 = 0;
+	ea->fg = fg;
+	ea->gr = 0;
+	if (first < 0) {
+	    first = baddr + i;
+	}
+	last = baddr + i;
+    }
+    if (first >= 0) {
+	REGION_CHANGED(first, last + 1);
+    }
+}
+
 /*
  * Change a character in the 3270 buffer, NVT mode.
  * Removes any field attribute defined at that location.
@@ -2748,6 +2821,66 @@ ctlr_add_nvt(int baddr, ucs4_t ucs4, unsigned char cs)
     }
 }
 
+/*
+ * Change a run of characters in the 3270 buffer, NVT mode, as if written one
+ * at a time with ctlr_add_nvt(CS_BASE), ctlr_add_gr(), ctlr_add_fg() and
+ * ctlr_add_bg(). The run must not wrap around the end of the buffer. The
+ * changed region is noted once.
+ */
+void
+ctlr_add_nvt_run(int baddr, const unsigned char *c, int count,
+	unsigned char gr, unsigned char fg, unsigned char bg)
+{
+    int first = -1;
+    int last = -1;
+    int i;
+
+    if ((fg & 0xf0) != 0xf0) {
+	fg = 0;
+    }
+    if ((bg & 0xf0) != 0xf0) {
+	bg = 0;
+    }
+    for (i = 0; i < count; i++) {
+	struct ea *ea = &ea_buf[baddr + i];
+	unsigned char xfg = mode3279? fg: ea->fg;
+	unsigned char xbg = mode3279? bg: ea->bg;
+	bool char_changed = ea->fa || ea->ucs4 != c[i] || ea->ec != 0 ||
+	    ea->cs != CS_BASE;
+
+	if (!char_changed && ea->gr == gr && ea->fg == xfg && ea->bg == xbg) {
+	    continue;
+	}
+	if (char_changed && trace_primed && !IsBlank(ea->ec)) {
+	    if (toggled(SCREEN_TRACE)) {
+		trace_screen(false);
+	    }
+	    scroll_save(maxROWS);
+	    trace_primed = false;
+	}
+	if (screen_selected(baddr + i)) {
+	    unselect(baddr + i, 1);
+	}
+	ea->ucs4 = c[i];
+	ea->ec = 0;
+	ea->cs = CS_BASE;
+	ea->fa = 0;
+	ea->gr = gr;
+	ea->fg = xfg;
+	ea->bg = xbg;
+	if (first < 0) {
+	    first = baddr + i;
+	}
+	last = baddr + i;
+    }
+    if (first >= 0) {
+	REGION_CHANGED(first, last + 1);
+	if (gr & GR_BLINK) {
+	    blink_start();
+	}
+    }
+}
+
 /* 
  * Set a field attribute in the 3270 buffer.
  */
@@ -2761,7 +2894,11 @@ ctlr_add_fa(int baddr, unsigned char fa, unsigned char cs)
      * Store the new attribute, setting the 'printable' bits so that the
      * value will be non-zero.
      */
-    ea_buf[baddr].fa = FA_PRINTABLE | (fa & FA_MASK);
+    fa = FA_PRINTABLE | (fa & FA_MASK);
+    if (ea_buf[baddr].fa != fa) {
+	ONE_CHANGED(baddr);
+	ea_buf[baddr].fa = fa;
+    }
 }
 
 /* 
@@ -2932,12 +3069,18 @@ ctlr_aclear(int baddr, int count, int clear_ea)
  *
  * This could be accomplished with ctlr_bcopy() and ctlr_aclear(), but this
  * operation is common enough to warrant a separate path.
+ *
+ * Rather than moving every cell up a row, ea_buf is slid down a row within
+ * its allocation. Buffer addresses are still relative to ea_buf, so nothing
+ * else needs to know. Once the slack at the end of the allocation is used
+ * up, the rows are moved back to the start of it.
  */
 void
 ctlr_scroll(unsigned char fg, unsigned char bg)
 {
     int qty = (ROWS - 1) * COLS;
     bool obscured;
+    struct ea dummy_fa;
     int i;
 
     /* Make sure nothing is selected. (later this can be fixed) */
@@ -2949,8 +3092,16 @@ ctlr_scroll(unsigned char fg, unsigned char bg)
 	screen_disp(false);
     }
 
-    /* Move ea_buf. */
-    memmove(&ea_buf[0], &ea_buf[COLS], qty * sizeof(struct ea));
+    /* Move ea_buf, carrying along the dummy field attribute before it. */
+    dummy_fa = ea_buf[-1];
+    if ((ea_buf - ea_base) + COLS <= ea_slide) {
+	ea_buf += COLS;
+    } else {
+	memmove(ea_base, &ea_buf[COLS], qty * sizeof(struct ea));
+	ea_buf = ea_base;
+    }
+    ea_buf[-1] = dummy_fa;
+    rows_changed(0, ROWS * COLS);
 
     /* Clear the last line. */
     memset((char *) &ea_buf[qty], 0, COLS * sizeof(struct ea));
@@ -2973,6 +3124,36 @@ ctlr_scroll(unsigned char fg, unsigned char bg)
     }
 }
 
+/*
+ * Bump ctlr_generation and stamp the rows covering a changed region of the
+ * buffer. The row before the region is stamped too, because the rendering of
+ * a DBCS character in its last column depends on the first position of the
+ * next row.
+ */
+static void
+rows_changed(int first, int last)
+{
+    int row, last_row;
+
+    ctlr_generation++;
+    if (ctlr_row_generation == NULL || COLS == 0) {
+	return;
+    }
+    if (last > ROWS * COLS) {
+	last = ROWS * COLS;
+    }
+    if (first > 0) {
+	row = (first - 1) / COLS;
+    } else {
+	row = 0;
+	ctlr_row_generation[ROWS - 1] = ctlr_generation;
+    }
+    last_row = (last > first)? (last - 1) / COLS: row;
+    for (; row <= last_row && row < maxROWS; row++) {
+	ctlr_row_generation[row] = ctlr_generation;
+    }
+}
+
 /*
  * Note that a particular region of the screen has changed.
  */
@@ -3016,6 +3197,9 @@ ctlr_altbuffer(bool alt)
 	etmp = ea_buf;
 	ea_buf = aea_buf;
 	aea_buf = etmp;
+	etmp = ea_base;
+	ea_base = aea_base;
+	aea_base = etmp;
 
 #if defined(CHECK_AEA_BUF) /*[*/
 	stmp = ea_sum;
@@ -3051,6 +3235,7 @@ mdt_set(int baddr)
     faddr = find_field_attribute(baddr);
     if (faddr >= 0 && !(ea_buf[faddr].fa & FA_MODIFY)) {
 	ea_buf[faddr].fa |= FA_MODIFY;
+	ctlr_generation++;
 	if (appres.modified_sel) {
 	    ALL_CHANGED;
 	}
@@ -3065,6 +3250,7 @@ mdt_clear(int baddr)
     faddr = find_field_attribute(baddr);
     if (faddr >= 0 && (ea_buf[faddr].fa & FA_MODIFY)) {
 	ea_buf[faddr].fa &= ~FA_MODIFY;
+	ctlr_generation++;
 	if (appres.modified_sel) {
 	    ALL_CHANGED;
 	}
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2025 Paul Mattes.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the names of Paul Mattes nor the names of his contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *	ea_compress.c
+ *		Compressed screen buffer rows, for the scrollback buffer.
+ *
+ * A row is stored as a series of runs. Each run starts with a kind byte, a
+ * cell count (7 bits per byte, high bit set on all but the last byte) and
+ * the attributes shared by the cells in the run (fa, fg, bg, gr, cs, ic
+ * and db), followed by the text of the cells. A repeat run holds the text
+ * for one cell, which is repeated. The text for a cell is its EBCDIC code,
+ * its Unicode value in UTF-8, or both, depending on which of the two are
+ * set, as recorded in the kind byte.
+ */
+
+#include "globals.h"
+
+#include "ea_compress.h"
+#include "utf8.h"
+
+/* Run kinds. */
+#define EK_EC		0x00	/* EBCDIC code only */
+#define EK_UCS4		0x01	/* Unicode only */
+#define EK_BOTH		0x02	/* EBCDIC code and Unicode */
+#define EK_TEXT_MASK	0x03
+#define EK_REPEAT	0x04	/* one cell, repeated */
+
+/* Shortest run of identical cells stored as a repeat. */
+#define MIN_REPEAT	4
+
+/* Returns the kind of text in a cell. */
+static unsigned char
+text_kind(const struct ea *ea)
+{
+    if (!ea->ucs4) {
+	return EK_EC;
+    }
+    return ea->ec? EK_BOTH: EK_UCS4;
+}
+
+/* Returns true if two cells have the same attributes. */
+static bool
+same_attrs(const struct ea *a, const struct ea *b)
+{
+    return a->fa == b->fa && a->fg == b->fg && a->bg == b->bg &&
+	a->gr == b->gr && a->cs == b->cs && a->ic == b->ic && a->db == b->db;
+}
+
+/* Returns true if two cells are identical. */
+static bool
+same_cell(const struct ea *a, const struct ea *b)
+{
+    return a->ec == b->ec && a->ucs4 == b->ucs4 && same_attrs(a, b);
+}
+
+/* Returns the number of identical cells starting at row[i]. */
+static int
+repeat_length(const struct ea *row, int i, int ncols)
+{
+    int n = 1;
+
+    while (i + n < ncols && same_cell(&row[i], &row[i + n])) {
+	n++;
+    }
+    return n;
+}
+
+/* Stores the text for a cell. */
+static unsigned char *
+put_text(const struct ea *ea, unsigned char kind, unsigned char *o)
+{
+    if (kind != EK_UCS4) {
+	*o++ = ea->ec;
+    }
+    if (kind != EK_EC) {
+	int len = unicode_to_utf8(ea->ucs4, (char *)o);
+
+	if (len < 0) {
+	    /* Not representable; the emulator never stores these. */
+	    *o = '?';
+	    len = 1;
+	}
+	o += len;
+    }
+    return o;
+}
+
+/* Fetches the text for a cell. */
+static const unsigned char *
+get_text(struct ea *ea, unsigned char kind, const unsigned char *z)
+{
+    ea->ec = (kind != EK_UCS4)? *z++: 0;
+    ea->ucs4 = 0;
+    if (kind != EK_EC) {
+	int len = utf8_to_unicode((const char *)z, 6, &ea->ucs4);
+
+	if (len <= 0) {
+	    ea->ucs4 = '?';
+	    len = 1;
+	}
+	z += len;
+    }
+    return z;
+}
+
+/*
+ * Compress a row of ncols cells into out, which must hold at least
+ * EA_COMPRESS_MAX(ncols) bytes.
+ *
+ * Returns the length of the compressed row.
+ */
+size_t
+ea_compress_row(const struct ea *row, int ncols, unsigned char *out)
+{
+    unsigned char *o = out;
+    int i = 0;
+
+    while (i < ncols) {
+	const struct ea *ea = &row[i];
+	unsigned char kind = text_kind(ea);
+	int n = repeat_length(row, i, ncols);
+	int j;
+
+	if (n >= MIN_REPEAT) {
+	    kind |= EK_REPEAT;
+	} else {
+	    /*
+	     * Take cells with the same attributes and kind of text, up to
+	     * the start of the next repeat.
+	     */
+	    for (n = 1; i + n < ncols; n++) {
+		const struct ea *next = &row[i + n];
+
+		if (!same_attrs(ea, next) || text_kind(next) != kind ||
+			repeat_length(row, i + n, ncols) >= MIN_REPEAT) {
+		    break;
+		}
+	    }
+	}
+
+	/* Store the run header. */
+	*o++ = kind;
+	for (j = n; j >= 0x80; j >>= 7) {
+	    *o++ = 0x80 | (j & 0x7f);
+	}
+	*o++ = (unsigned char)j;
+	*o++ = ea->fa;
+	*o++ = ea->fg;
+	*o++ = ea->bg;
+	*o++ = ea->gr;
+	*o++ = ea->cs;
+	*o++ = ea->ic;
+	*o++ = ea->db;
+
+	/* Store the text. */
+	if (kind & EK_REPEAT) {
+	    o = put_text(ea, kind & EK_TEXT_MASK, o);
+	} else {
+	    for (j = 0; j < n; j++) {
+		o = put_text(&row[i + j], kind, o);
+	    }
+	}
+	i += n;
+    }
+    return o - out;
+}
+
+/*
+ * Expand the first ncols cells of a compressed row.
+ */
+void
+ea_expand_row(const unsigned char *z, struct ea *row, int ncols)
+{
+    int i = 0;
+
+    while (i < ncols) {
+	unsigned char kind = *z++;
+	struct ea ea;
+	int n = 0;
+	int shift = 0;
+	int j;
+
+	do {
+	    n |= (*z & 0x7f) << shift;
+	    shift += 7;
+	} while (*z++ & 0x80);
+	ea.fa = *z++;
+	ea.fg = *z++;
+	ea.bg = *z++;
+	ea.gr = *z++;
+	ea.cs = *z++;
+	ea.ic = *z++;
+	ea.db = *z++;
+	if (n > ncols - i) {
+	    n = ncols - i;
+	}
+
+	if (kind & EK_REPEAT) {
+	    z = get_text(&ea, kind & EK_TEXT_MASK, z);
+	    for (j = 0; j < n; j++) {
+		row[i + j] = ea;
+	    }
+	} else {
+	    for (j = 0; j < n; j++) {
+		z = get_text(&ea, kind, z);
+		row[i + j] = ea;
+	    }
+	}
+	i += n;
+    }
+}
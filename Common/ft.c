@@ -51,13 +51,17 @@
 #include "kybd.h"
 #include "names.h"
 #include "popups.h"
+#include "query.h"
 #include "resources.h"
 #include "task.h"
 #include "toggles.h"
+#include "trace.h"
+#include "txa.h"
 #include "utils.h"
 #include "varbuf.h"
 
 /* Macros. */
+#define FT_FILE_BUF	(64 * 1024)	/* local file stdio buffer size */
 
 /* Globals. */
 enum ft_state ft_state = FT_NONE;	/* File transfer state */
@@ -72,6 +76,14 @@ static bool gui_conf_initted = false;
 
 static struct timeval t0;		/* Starting time */
 
+/* Statistics for all transfers in this session. */
+static struct {
+    unsigned long completed;		/* number of successful transfers */
+    unsigned long failed;		/* number of failed transfers */
+    unsigned long long bytes;		/* bytes in successful transfers */
+    double seconds;			/* time in successful transfers */
+} ft_stats;
+
 /* Translation table: "ASCII" to EBCDIC, as seen by IND$FILE. */
 unsigned char i_asc2ft[256] = {
 0x00,0x01,0x02,0x03,0x37,0x2d,0x2e,0x2f,0x16,0x05,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
@@ -131,6 +143,7 @@ enum ft_parm_name {
 #if defined(_WIN32) /*[*/
     PARM_WINDOWS_CODEPAGE,
 #endif /*]*/
+    PARM_CHECKPOINT,
     PARM_OTHER_OPTIONS,
     N_PARMS
 };
@@ -158,6 +171,7 @@ static struct {
 #if defined(_WIN32) /*[*/
     { "WindowsCodePage" },
 #endif /*]*/
+    { "Checkpoint" },
     { "OtherOptions" },
 };
 ft_tstate_t fts;
@@ -166,6 +180,7 @@ static ioid_t ft_start_id = NULL_IOID;
 
 static void ft_connected(bool ignored);
 static void ft_in3270(bool ignored);
+static const char *ft_query(void);
 
 static action_t Transfer_action;
 
@@ -206,6 +221,9 @@ ft_register(void)
     static action_table_t ft_actions[] = {
 	{ AnTransfer,	Transfer_action,	ACTION_KE }
     };
+    static query_t ft_queries[] = {
+	{ KwFileTransfer, ft_query, NULL, false, false }
+    };
 
     /* Register for state changes. */
     register_schange(ST_CONNECT, ft_connected);
@@ -214,6 +232,9 @@ ft_register(void)
     /* Register actions. */
     register_actions(ft_actions, array_count(ft_actions));
 
+    /* Register queries. */
+    register_queries(ft_queries, array_count(ft_queries));
+
     /* Register the toggles. */
     register_extended_toggle(ResFtBufferSize, toggle_ft_buffer_size, NULL,
 	    NULL, (void **)&appres.ft.dft_buffer_size, XRM_INT);
@@ -336,6 +357,7 @@ ft_init_conf(ft_conf_t *p)
 	appres.ft.codepage: appres.local_cp;
 #endif /*]*/
     Replace(p->other_options, NULL);
+    Replace(p->checkpoint_file, NULL);
 
     /* Apply resources. */
     if (appres.ft.blksize) {
@@ -500,6 +522,49 @@ ft_didnt_start(ioid_t id _is_unused)
     ft_complete(get_message("ftStartTimeout"));
 }
 
+/* Return the time since the current transfer started running. */
+static double
+ft_elapsed(struct timeval *t1)
+{
+    return (double)(t1->tv_sec - t0.tv_sec) +
+	(double)(t1->tv_usec - t0.tv_usec) / 1.0e6;
+}
+
+/*
+ * Query(FileTransfer): the state of the current transfer, if any, and the
+ * totals for all transfers in this session.
+ */
+static const char *
+ft_query(void)
+{
+    static const char *state_name[] = {
+	"idle", "awaiting-ack", "running", "aborting", "aborting"
+    };
+    varbuf_t r;
+
+    vb_init(&r);
+    vb_appendf(&r, "state %s", state_name[ft_state]);
+    if (ft_state != FT_NONE) {
+	vb_appendf(&r, "\ndirection %s\nlocal-file %s\nhost-file %s",
+		ftc->receive_flag? "receive": "send",
+		fts.resolved_local_filename, ftc->host_filename);
+	if (ft_state != FT_AWAIT_ACK) {
+	    struct timeval t1;
+
+	    gettimeofday(&t1, NULL);
+	    vb_appendf(&r, "\nmode %s\nbytes %lu\nseconds %.3f",
+		    fts.is_cut? "CUT": "DFT", (unsigned long)fts.length,
+		    ft_elapsed(&t1));
+	}
+    }
+    vb_appendf(&r, "\ncompleted %lu failed %lu bytes %llu seconds %.3f "
+	    "bytes/sec %.0f",
+	    ft_stats.completed, ft_stats.failed, ft_stats.bytes,
+	    ft_stats.seconds,
+	    ft_stats.seconds? (double)ft_stats.bytes / ft_stats.seconds: 0.0);
+    return txdFree(vb_consume(&r));
+}
+
 /* External entry points called by ft_dft and ft_cut. */
 
 /* Pop up a message, end the transfer. */
@@ -512,6 +577,15 @@ ft_complete(const char *errmsg)
     }
     fts.local_file = NULL;
 
+    /* Keep the checkpoint only if the transfer failed. */
+    if (fts.checkpoint != NULL) {
+	fclose(fts.checkpoint);
+	fts.checkpoint = NULL;
+	if (errmsg == NULL) {
+	    unlink(ftc->checkpoint_file);
+	}
+    }
+
     /* Clean up the state. */
     ft_state = FT_NONE;
     kybd_ft(false);
@@ -530,6 +604,8 @@ ft_complete(const char *errmsg)
     if (errmsg != NULL) {
 	char *msg_copy = NewString(errmsg);
 
+	ft_stats.failed++;
+
 	/* Send the error message to any waiting action. */
 	task_ft_complete(errmsg, true);
 
@@ -544,13 +620,16 @@ ft_complete(const char *errmsg)
 	Free(msg_copy);
     } else {
 	struct timeval t1;
+	double secs;
 	double bytes_sec;
 	char *buf;
 
 	gettimeofday(&t1, NULL);
-	bytes_sec = (double)fts.length /
-		((double)(t1.tv_sec - t0.tv_sec) + 
-		 (double)(t1.tv_usec - t0.tv_usec) / 1.0e6);
+	secs = ft_elapsed(&t1);
+	bytes_sec = (double)fts.length / secs;
+	ft_stats.completed++;
+	ft_stats.bytes += fts.length;
+	ft_stats.seconds += secs;
 	buf = Asprintf(get_message("ftComplete"), fts.length,
 		display_scale(bytes_sec),
 		fts.is_cut ? "CUT" : "DFT");
@@ -640,6 +719,163 @@ ft_resolve_dir(ft_conf_t *p)
     }
 }
 
+/*
+ * Compute how each single-byte ASCII character in the local file is sent to
+ * the host, so uploads can translate runs of them without going through the
+ * multi-byte and EBCDIC conversions one character at a time.
+ */
+static void
+ft_init_ascii_remap(void)
+{
+    int c;
+
+    for (c = 0; c < 0x80; c++) {
+	char mb = (char)c;
+	int consumed;
+	enum me_fail error = ME_NONE;
+	ucs4_t u;
+	ebc_t e;
+
+	u = ft_multibyte_to_unicode(&mb, 1, &consumed, &error);
+	if (error != ME_NONE || consumed != 1) {
+	    fts.ascii_remap[c] = -1;
+	    continue;
+	}
+	if (!ftc->remap_flag) {
+	    fts.ascii_remap[c] = c;
+	    continue;
+	}
+
+	/* This matches the translation in dft_ascii_read(). */
+	if (u < 0x20 || ((u >= 0x80 && u < 0x9f))) {
+	    e = i_asc2ft[u];
+	} else if (u == 0x9f) {
+	    e = 0xff;
+	} else {
+	    e = unicode_to_ebcdic(u);
+	}
+	if (e & 0xff00) {
+	    fts.ascii_remap[c] = -1;
+	} else {
+	    fts.ascii_remap[c] = e? i_ft2asc[e]: '?';
+	}
+    }
+}
+
+/*
+ * Refill the upload input block from the local file.
+ * Returns the first byte of the new block, or EOF.
+ */
+int
+ft_fill_getc(void)
+{
+    size_t nr;
+
+    if (fts.inbuf == NULL) {
+	fts.inbuf = (unsigned char *)Malloc(FT_FILE_BUF);
+    }
+    nr = fread(fts.inbuf, 1, FT_FILE_BUF, fts.local_file);
+    fts.inbuf_len = nr;
+    if (nr == 0) {
+	fts.inbuf_ix = 0;
+	return EOF;
+    }
+    fts.inbuf_ix = 1;
+    return fts.inbuf[0];
+}
+
+/*
+ * Record how much of an upload the host has confirmed, so a failed transfer
+ * can be resumed from that point.
+ */
+void
+ft_checkpoint(unsigned long long bytes, unsigned long records)
+{
+    if (fts.checkpoint == NULL) {
+	return;
+    }
+
+    /* The numbers are fixed-width, so the file can be rewritten in place. */
+    rewind(fts.checkpoint);
+    if (fprintf(fts.checkpoint, "%sconfirmed %020llu %010lu\n",
+		fts.checkpoint_header, bytes, records) < 0 ||
+	    fflush(fts.checkpoint) < 0) {
+	vtrace("Transfer: cannot write checkpoint: %s\n", strerror(errno));
+    }
+}
+
+/*
+ * Set up the checkpoint file for an upload. If it holds a checkpoint for the
+ * same local file, host file and options, set up to resume the transfer
+ * where it left off.
+ *
+ * Returns false, after popping up an error, if the checkpoint file cannot be
+ * written.
+ */
+static bool
+ft_checkpoint_start(ft_conf_t *p, FILE *f)
+{
+    struct stat st;
+    FILE *cf;
+
+    if (fstat(fileno(f), &st) < 0) {
+	popup_an_errno(errno, "Local file '%s'", fts.resolved_local_filename);
+	return false;
+    }
+    Replace(fts.checkpoint_header, Asprintf("x3270 transfer checkpoint\n"
+		"local-file %s\n"
+		"host-file %s\n"
+		"host %s\n"
+		"size %llu mtime %llu\n"
+		"mode %s cr %s remap %s recfm %s lrecl %d\n",
+		fts.resolved_local_filename,
+		p->host_filename,
+		ft_decode_host_type(p->host_type),
+		(unsigned long long)st.st_size,
+		(unsigned long long)st.st_mtime,
+		p->ascii_flag? "ascii": "binary",
+		p->cr_flag? "yes": "no",
+		p->remap_flag? "yes": "no",
+		ft_decode_recfm(p->recfm),
+		p->lrecl));
+
+    /* See if there is a checkpoint for the same transfer. */
+    cf = fopen(p->checkpoint_file, "r");
+    if (cf != NULL) {
+	size_t hlen = strlen(fts.checkpoint_header);
+	char *text = Malloc(hlen + 64 + 1);
+	size_t nr = fread(text, 1, hlen + 64, cf);
+	unsigned long long bytes;
+	unsigned long records;
+
+	fclose(cf);
+	text[nr] = '\0';
+	if (nr > hlen &&
+		!memcmp(text, fts.checkpoint_header, hlen) &&
+		sscanf(text + hlen, "confirmed %llu %lu", &bytes,
+		    &records) == 2 &&
+		(p->ascii_flag || bytes <= (unsigned long long)st.st_size)) {
+	    fts.restart_bytes = bytes;
+	    fts.restart_records = records;
+	    vtrace("Transfer: resuming '%s' after %llu bytes, %lu records\n",
+		    fts.resolved_local_filename, bytes, records);
+	} else {
+	    vtrace("Transfer: checkpoint '%s' does not match, starting over\n",
+		    p->checkpoint_file);
+	}
+	Free(text);
+    }
+
+    /* Start the new checkpoint. */
+    fts.checkpoint = fopen(p->checkpoint_file, "w");
+    if (fts.checkpoint == NULL) {
+	popup_an_errno(errno, "Checkpoint file '%s'", p->checkpoint_file);
+	return false;
+    }
+    ft_checkpoint(fts.restart_bytes, fts.restart_records);
+    return true;
+}
+
 /*
  * Start a file transfer, based on the contents of an ft_state structure.
  *
@@ -680,6 +916,24 @@ ft_go(ft_conf_t *p, enum iaction cause)
 	return NULL;
     }
 
+    /*
+     * Transfers move a DFT buffer or a CUT frame at a time, so give the
+     * file a buffer big enough to batch several of them into each read or
+     * write.
+     */
+    setvbuf(f, NULL, _IOFBF, FT_FILE_BUF);
+
+    /*
+     * If the host already has part of a checkpointed upload, append the
+     * rest to it.
+     */
+    fts.restart_bytes = 0;
+    fts.restart_records = 0;
+    if (p->checkpoint_file != NULL && !ft_checkpoint_start(p, f)) {
+	fclose(f);
+	return NULL;
+    }
+
     /* Build the ind$file command */
     vb_init(&r);
     vb_appendf(&r, "IND\\e005BFILE %s %s %s",
@@ -696,7 +950,7 @@ ft_go(ft_conf_t *p, enum iaction cause)
     } else if (p->host_type == HT_CICS) {
 	vb_appends(&r, " NOCRLF");
     }
-    if (p->append_flag && !p->receive_flag) {
+    if ((p->append_flag || fts.restart_bytes) && !p->receive_flag) {
 	vb_appends(&r, " APPEND");
     }
     if (!p->receive_flag) {
@@ -783,6 +1037,10 @@ ft_go(ft_conf_t *p, enum iaction cause)
 		unlink(fts.resolved_local_filename);
 	    }
 	}
+	if (fts.checkpoint != NULL) {
+	    fclose(fts.checkpoint);
+	    fts.checkpoint = NULL;
+	}
 	switch (flen) {
 	case KYP_LOCKED:
 	    why = get_message("ftUnableLocked");
@@ -811,6 +1069,11 @@ ft_go(ft_conf_t *p, enum iaction cause)
     fts.is_cut = false;
     fts.last_dbcs = false;
     fts.dbcs_state = FT_DBCS_NONE;
+    fts.inbuf_len = 0;
+    fts.inbuf_ix = 0;
+    if (!p->receive_flag && p->ascii_flag) {
+	ft_init_ascii_remap();
+    }
 
     ft_state = FT_AWAIT_ACK;
     kybd_ft(true);
@@ -986,6 +1249,9 @@ parse_ft_keywords(unsigned argc, const char **argv)
 	p->windows_codepage = atoi(tp[PARM_WINDOWS_CODEPAGE].value);
     }
 #endif /*]*/
+    if (tp[PARM_CHECKPOINT].value) {
+	Replace(p->checkpoint_file, NewString(tp[PARM_CHECKPOINT].value));
+    }
     if (tp[PARM_OTHER_OPTIONS].value) {
 	Replace(p->other_options, NewString(tp[PARM_OTHER_OPTIONS].value));
     }
@@ -1076,6 +1342,26 @@ parse_ft_keywords(unsigned argc, const char **argv)
 	popup_an_error(AnTransfer "(): 'Avblock' is only for TSO hosts");
 	return NULL;
     }
+    if (tp[PARM_CHECKPOINT].value && p->receive_flag) {
+	popup_an_error(AnTransfer "(): 'Checkpoint' is only for sending files");
+	return NULL;
+    }
+    if (tp[PARM_CHECKPOINT].value && p->host_type == HT_CICS) {
+	popup_an_error(AnTransfer "(): 'Checkpoint' is only for TSO and VM "
+		"hosts");
+	return NULL;
+    }
+    if (tp[PARM_CHECKPOINT].value && p->ascii_flag && !p->cr_flag) {
+	popup_an_error(AnTransfer "(): 'Checkpoint' cannot be used with "
+		"'Cr=keep'");
+	return NULL;
+    }
+    if (tp[PARM_CHECKPOINT].value && !p->ascii_flag &&
+	    (p->recfm != RECFM_FIXED || !p->lrecl)) {
+	popup_an_error(AnTransfer "(): 'Checkpoint' needs 'Recfm=fixed' and "
+		"'Lrecl' for binary transfers");
+	return NULL;
+    }
 #if defined(_WIN32) /*[*/
     if (tp[PARM_WINDOWS_CODEPAGE].value && !p->ascii_flag) {
 	popup_an_error(AnTransfer "(): 'WindowsCodePage' is only for ASCII "
@@ -1128,6 +1414,7 @@ ft_start_backend(ft_conf_t *p, enum iaction cause)
  *   BufferSize			no default
  *   Avblock=n			no default
  *   WindowsCodePage=n		no default
+ *   Checkpoint=file		no default
  */
 
 static bool  
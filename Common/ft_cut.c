@@ -340,6 +340,14 @@ download_convert(unsigned const char *buf, unsigned len, unsigned char *xobuf)
 	    continue;
 	}
 
+	/* Single-byte ASCII characters have a precomputed translation. */
+	if (c < 0x80 && !fts.last_dbcs && fts.ascii_remap[c] >= 0) {
+	    ob += store_download((unsigned char)fts.ascii_remap[c], ob);
+	    buf++;
+	    len--;
+	    continue;
+	}
+
 	/*
 	 * Translate.
 	 *
@@ -438,6 +446,9 @@ cut_control_code(void)
 	cut_eof = false;
 	cut_ack();
 	ft_running(true);
+	if (fts.restart_bytes) {
+	    cut_abort(get_message("ftCutNoRestart"), SC_ABORT_FILE);
+	}
 	break;
     case SC_XFER_COMPLETE:
 	trace_ds("XFER_COMPLETE\n");
@@ -706,7 +717,7 @@ xlate_getc(void)
 	 * Get the next (possibly multi-byte) character from the file.
 	 */
 	do {
-	    c = fgetc(fts.local_file);
+	    c = ft_getc();
 	    if (c == EOF) {
 		if (fts.last_dbcs) {
 		    fts.last_dbcs = false;
@@ -716,6 +727,10 @@ xlate_getc(void)
 	    }
 	    fts.length++;
 	    mb[mb_len++] = c;
+	    if (mb_len == 1 && c < 0x80 && fts.ascii_remap[c] >= 0) {
+		/* Single-byte character. */
+		break;
+	    }
 	    error = ME_NONE;
 	    ft_multibyte_to_unicode(mb, mb_len, &consumed, &error);
 	    if (error == ME_INVALID) {
@@ -736,7 +751,7 @@ xlate_getc(void)
 
     } else {
 	/* Binary, just read it. */
-	c = fgetc(fts.local_file);
+	c = ft_getc();
 	if (c == EOF)
 		return c;
 	mb[0] = c;
@@ -55,6 +55,11 @@
 
 #define DFT_MAX_UNGETC	32
 
+/* System calls which may not be there. */
+#if !defined(HAVE_FSEEKO) /*[*/
+#define fseeko(s, o, w)	fseek(s, (long)o, w)
+#endif /*]*/
+
 /* Typedefs. */
 struct data_buffer {
     char sf_length[2];		/* SF length = 0x0023 */
@@ -76,8 +81,16 @@ static char *abort_string = NULL;
 static unsigned char *dft_savebuf = NULL;
 static size_t dft_savebuf_len = 0;
 static size_t dft_savebuf_max = 0;
+static char *dft_convbuf = NULL;
+static size_t dft_convbuf_max = 0;
 static unsigned char dft_ungetc_cache[DFT_MAX_UNGETC];
 static size_t dft_ungetc_count = 0;
+static unsigned char *dft_carry = NULL;	/* data held for the next record */
+static size_t dft_carry_len = 0;
+static size_t dft_carry_max = 0;
+static unsigned long long dft_sent;	/* bytes the host has, with restart */
+static bool dft_sent_aligned;	/* last record sent ended on a boundary */
+static bool dft_unconfirmed;	/* last record sent not yet checkpointed */
 
 static void dft_abort(const char *s, unsigned short code);
 static void dft_close_request(void);
@@ -86,6 +99,7 @@ static void dft_get_request(void);
 static void dft_insert_request(void);
 static void dft_open_request(unsigned short len, unsigned char *cp);
 static void dft_set_cur_req(void);
+static size_t dft_ascii_read(unsigned char *bufptr, size_t numbytes);
 
 /* Process a Transfer Data structured field from the host. */
 void
@@ -134,6 +148,75 @@ ft_dft_data(unsigned char *data, int length _is_unused)
     }
 }
 
+/*
+ * Skip the part of the local file that the host already has from an earlier
+ * checkpointed upload.
+ * Returns false if the file is too short.
+ */
+static bool
+dft_restart(void)
+{
+    unsigned long long skip = fts.restart_bytes;
+    unsigned char skipbuf[1024];
+
+    if (!ftc->ascii_flag) {
+	return fseeko(fts.local_file, (off_t)skip, SEEK_SET) == 0;
+    }
+
+    /* The host has converted data, so convert the file again to find it. */
+    while (skip) {
+	size_t n = (skip < sizeof(skipbuf))? (size_t)skip: sizeof(skipbuf);
+	size_t nr = dft_ascii_read(skipbuf, n);
+
+	if (nr == (size_t)-1) {
+	    return false;
+	}
+	skip -= nr;
+    }
+    return true;
+}
+
+/* The host has the last record sent, so checkpoint it if possible. */
+static void
+dft_confirm(void)
+{
+    if (dft_unconfirmed && dft_sent_aligned) {
+	ft_checkpoint(dft_sent, fts.restart_records + recnum - 1);
+    }
+    dft_unconfirmed = false;
+}
+
+/*
+ * When checkpointing, end a record on a line or fixed-length record boundary
+ * if possible, holding the rest of the data for the next record, so that a
+ * resumed transfer never appends to a partial line or record.
+ */
+static void
+dft_align(unsigned char *data, size_t *len)
+{
+    size_t keep;
+
+    if (!ftc->ascii_flag) {
+	dft_sent_aligned = dft_eof || (dft_sent + *len) % ftc->lrecl == 0;
+	return;
+    }
+
+    if (!dft_eof) {
+	for (keep = *len; keep && data[keep - 1] != '\n'; keep--) {
+	}
+	if (keep && keep < *len) {
+	    dft_carry_len = *len - keep;
+	    if (dft_carry_len > dft_carry_max) {
+		dft_carry_max = dft_carry_len;
+		Replace(dft_carry, (unsigned char *)Malloc(dft_carry_max));
+	    }
+	    memcpy(dft_carry, data + keep, dft_carry_len);
+	    *len = keep;
+	}
+    }
+    dft_sent_aligned = dft_eof || data[*len - 1] == '\n';
+}
+
 /* Process an Open request. */
 static void
 dft_open_request(unsigned short len, unsigned char *cp)
@@ -177,6 +260,13 @@ dft_open_request(unsigned short len, unsigned char *cp)
     dft_eof = false;
     recnum = 1;
     dft_ungetc_count = 0;
+    dft_carry_len = 0;
+    dft_sent = fts.restart_bytes;
+    dft_unconfirmed = false;
+    if (!message_flag && fts.restart_bytes && !dft_restart()) {
+	dft_abort(get_message("ftDftRestartShort"), TR_OPEN_REQ);
+	return;
+    }
 
     /* Acknowledge the Open. */
     trace_ds("> WriteStructuredField FileTransferData OpenAck\n");
@@ -287,12 +377,19 @@ dft_data_insert(struct data_buffer *data_bufr)
 	/* Write the data out to the file. */
 	if (ftc->ascii_flag && (ftc->remap_flag || ftc->cr_flag)) {
 	    size_t obuf_len = 4 * my_length;
-	    char *ob0 = Malloc(obuf_len);
-	    char *ob = ob0;
+	    char *ob0;
+	    char *ob;
 	    unsigned char *s = (unsigned char *)data_bufr->data;
 	    unsigned len = my_length;
 	    size_t nx;
 
+	    /* The conversion buffer is kept across records. */
+	    if (obuf_len > dft_convbuf_max) {
+		dft_convbuf_max = obuf_len;
+		Replace(dft_convbuf, (char *)Malloc(dft_convbuf_max));
+	    }
+	    ob = ob0 = dft_convbuf;
+
 	    /* Copy and convert data_bufr->data to ob0. */
 	    while (len-- && obuf_len) {
 		unsigned char c = *s++;
@@ -383,7 +480,6 @@ dft_data_insert(struct data_buffer *data_bufr)
 		rv = fwrite(ob0, ob - ob0, (size_t)1, fts.local_file);
 		fts.length += ob - ob0;
 	    }
-	    Free(ob0);
 	} else {
 	    /* Write the buffer to the file directly. */
 	    rv = fwrite((char *)data_bufr->data, my_length, (size_t)1,
@@ -431,6 +527,49 @@ store_inbyte(unsigned char c, unsigned char **bufptr, size_t *numbytes)
     }
 }
 
+/*
+ * Convert a run of characters from the upload input block in one pass,
+ * stopping at anything that needs the full treatment in dft_ascii_read().
+ * Returns the number of bytes stored.
+ */
+static size_t
+dft_ascii_run(unsigned char *bufptr, size_t numbytes)
+{
+    unsigned char *bp0 = bufptr;
+    unsigned char *bp_end = bufptr + numbytes;
+    const unsigned char *ip = fts.inbuf + fts.inbuf_ix;
+    const unsigned char *ip_end = fts.inbuf + fts.inbuf_len;
+    bool last_cr = fts.last_cr;
+
+    while (ip < ip_end && bufptr < bp_end) {
+	unsigned char c = *ip;
+
+	if (ftc->cr_flag && !last_cr && c == '\n') {
+	    /* Expand NL to CR/LF. */
+	    if (bp_end - bufptr < 2) {
+		break;
+	    }
+	    *bufptr++ = '\r';
+	    *bufptr++ = '\n';
+	} else {
+	    if (ftc->remap_flag) {
+		if ((c & 0x80) || fts.ascii_remap[c] < 0) {
+		    break;
+		}
+		*bufptr++ = (unsigned char)fts.ascii_remap[c];
+	    } else {
+		*bufptr++ = c;
+	    }
+	    last_cr = (c == '\r');
+	}
+	ip++;
+    }
+
+    fts.inbuf_ix = ip - fts.inbuf;
+    fts.last_cr = last_cr;
+    return bufptr - bp0;
+}
+
 /*
  * Read a character from a local file in ASCII mode.
  * Stores the data in 'bufptr' and returns the number of bytes stored.
@@ -468,12 +607,21 @@ dft_ascii_read(unsigned char *bufptr, size_t numbytes)
 	return nm;
     }
 
+    /* Convert as much as possible directly from the input block. */
+    if (!fts.last_dbcs) {
+	size_t nr = dft_ascii_run(bufptr, numbytes);
+
+	if (nr) {
+	    return nr;
+	}
+    }
+
     if (ftc->remap_flag) {
 	/* Read bytes until we have a legal multibyte sequence. */
 	do {
 	    int consumed;
 
-	    c = fgetc(fts.local_file);
+	    c = ft_getc();
 	    if (c == EOF) {
 		if (fts.last_dbcs) {
 		    *bufptr = EBC_si;
@@ -493,7 +641,7 @@ dft_ascii_read(unsigned char *bufptr, size_t numbytes)
 	} while (error == ME_SHORT);
     } else {
 	/* Get a byte from the file. */
-	c = fgetc(fts.local_file);
+	c = ft_getc();
 	if (c == EOF) {
 	    return -1;
 	}
@@ -572,6 +720,7 @@ dft_get_request(void)
     unsigned char *bufptr;
 
     trace_ds(" Get\n");
+    dft_confirm();
 
     if (!message_flag && ft_state == FT_ABORT_WAIT) {
 	dft_abort(get_message("ftUserCancel"), TR_GET_REQ);
@@ -583,6 +732,17 @@ dft_get_request(void)
     numbytes = ftc->dft_buffersize - 27; /* always read 5 bytes less than we're
 				            allowed */
     bufptr = obuf + 17;
+    if (fts.checkpoint != NULL && !ftc->ascii_flag &&
+	    (size_t)ftc->lrecl <= numbytes) {
+	numbytes -= numbytes % ftc->lrecl;
+    }
+    if (dft_carry_len) {
+	memcpy(bufptr, dft_carry, dft_carry_len);
+	bufptr += dft_carry_len;
+	numbytes -= dft_carry_len;
+	total_read += dft_carry_len;
+	dft_carry_len = 0;
+    }
     while (!dft_eof && numbytes) {
 	if (ftc->ascii_flag && (ftc->remap_flag || ftc->cr_flag)) {
 	    numread = dft_ascii_read(bufptr, numbytes);
@@ -621,6 +781,10 @@ dft_get_request(void)
 	return;
     }
 
+    if (fts.checkpoint != NULL && total_read) {
+	dft_align(obuf + 17, &total_read);
+    }
+
     /* Set up SF header for Data or EOF. */
     obptr = obuf;
     *obptr++ = AID_SF;
@@ -640,6 +804,8 @@ dft_get_request(void)
 	obptr += total_read;
 
 	fts.length += total_read;
+	dft_sent += total_read;
+	dft_unconfirmed = true;
     } else {
 	trace_ds("> WriteStructuredField FileTransferData EOF\n");
 	*obptr++ = HIGH8(TR_GET_REQ);
@@ -677,6 +843,7 @@ dft_close_request(void)
      * Return a close acknowledgement.
      */
     trace_ds(" Close\n");
+    dft_confirm();
     trace_ds("> WriteStructuredField FileTransferData CloseAck\n");
     obptr = obuf;
     space3270out(6);
@@ -216,37 +216,43 @@ httpd_data_trace(httpd_t *h, const char *direction, const char *buf,
     unsigned char linebuf[BPL];
     size_t j;
 
+    if (!trace_on(TC_HTTPD)) {
+	*doffset += len;
+	return;
+    }
+
     memset(linebuf, 0, BPL);
     for (i = 0; i < len; i++) {
 	if (!(i % BPL)) {
 	    if (i) {
-		vtrace(" ");
+		vctrace(TC_HTTPD, " ");
 		for (j = 0; j < BPL; j++) {
-		    vtrace("%c", iscntrl(linebuf[j])? '.': linebuf[j]);
+		    vctrace(TC_HTTPD, "%c",
+			iscntrl(linebuf[j])? '.': linebuf[j]);
 		}
 	    }
-	    vtrace("%sh%s [%lu] 0x%04x",
+	    vctrace(TC_HTTPD, "%sh%s [%lu] 0x%04x",
 		    i? "\n": "",
 		    direction,
 		    h->seq,
 		    (unsigned)(*doffset + i));
 	}
-	vtrace(" %02x", (unsigned char)buf[i]);
+	vctrace(TC_HTTPD, " %02x", (unsigned char)buf[i]);
 	linebuf[i % BPL] = buf[i];
     }
 
     /* Space over the missing data bytes on the line. */
     if (i % BPL) {
-	vtrace("%*s", (int)((BPL - (i % BPL)) * 3 + 1), "");
+	vctrace(TC_HTTPD, "%*s", (int)((BPL - (i % BPL)) * 3 + 1), "");
     } else {
-	vtrace(" ");
+	vctrace(TC_HTTPD, " ");
     }
 
     /* Trace the last chunk of data as text. */
     for (j = 0; j < ((i % BPL)? (i % BPL): BPL); j++) {
-	vtrace("%c", iscntrl(linebuf[j])? '.': linebuf[j]);
+	vctrace(TC_HTTPD, "%c", iscntrl(linebuf[j])? '.': linebuf[j]);
     }
-    vtrace("\n");
+    vctrace(TC_HTTPD, "\n");
 
     *doffset += len;
 }
@@ -527,7 +533,7 @@ httpd_http_header(httpd_t *h, int status_code, bool do_close,
     request_t *r = &h->request;
     const char *a;
 
-    vtrace("h> [%lu] Response: %d %s\n", h->seq, status_code,
+    vctrace(TC_HTTPD, "h> [%lu] Response: %d %s\n", h->seq, status_code,
 	    status_text(status_code));
 
     httpd_print(h, HP_BUFFER, "HTTP/1.1 %d %s\n", status_code,
@@ -597,7 +603,7 @@ httpd_verror(httpd_t *h, errmode_t mode, content_t content_type,
 	httpd_http_header(h, status_code, mode <= ERRMODE_FATAL, content_type,
 		"");
     } else {
-	vtrace("h> [%lu] Response: %d %s\n", h->seq, status_code,
+	vctrace(TC_HTTPD, "h> [%lu] Response: %d %s\n", h->seq, status_code,
 		status_text(status_code));
     }
 
@@ -783,7 +789,7 @@ httpd_digest_request_line(httpd_t *h)
     errmode = ERRMODE_NON_HTTP;
 
     rq = r->request_buf;
-    vtrace("h< [%lu] Request: %s\n", h->seq, rq);
+    vctrace(TC_HTTPD, "h< [%lu] Request: %s\n", h->seq, rq);
 
     /*
      * We need to see something that looks like:
@@ -2087,7 +2093,7 @@ httpd_new(void *mhandle, const char *client_name)
     memset(h, 0, sizeof(*h));
     httpd_init_state(h, mhandle);
 
-    vtrace("h< [%lu] New session from %s\n", h->seq, client_name);
+    vctrace(TC_HTTPD, "h< [%lu] New session from %s\n", h->seq, client_name);
 
     return h;
 }
@@ -2151,7 +2157,7 @@ httpd_close(void *dhandle, const char *why)
 {
     httpd_t *h = dhandle;
 
-    vtrace("h> [%lu] Close: %s\n", h->seq, why);
+    vctrace(TC_HTTPD, "h> [%lu] Close: %s\n", h->seq, why);
 
     /* Wipe the existing request state. */
     httpd_free_request(&h->request);
@@ -126,15 +126,29 @@ static char *temporary_compose_map_name = NULL;
 #define ak_eq(k1, k2)	(((k1).ucs4  == (k2).ucs4) && \
 			 ((k1).keytype == (k2).keytype))
 
-typedef struct ta {
-    struct ta *next;
+/*
+ * The typeahead queue is a ring of slots that grows by doubling when full.
+ * Short parameters (the common case, keysyms and EBCDIC codes) are stored in
+ * the slot itself; longer ones are copied onto the heap.
+ */
+#define TA_RING_INIT	64	/* initial number of slots */
+#define TA_PARM_INLINE	16	/* inline parameter space, including NUL */
+typedef struct {
     const char *efn_name;
     action_t *fn;
-    const char *parm1;
-    const char *parm2;
+    unsigned nparms;
+    char *parm_heap[2];
+    char parm_inline[2][TA_PARM_INLINE];
 } ta_t;
-ta_t *ta_head = (struct ta *) NULL;
-ta_t *ta_tail = (struct ta *) NULL;
+static ta_t *ta_ring = NULL;
+static unsigned ta_ring_size = 0;
+static unsigned ta_first = 0;
+static unsigned ta_count = 0;
+
+/* Typeahead statistics, for Query(Typeahead). */
+static unsigned ta_peak = 0;
+static unsigned long ta_dropped = 0;
+static unsigned long ta_flushed = 0;
 
 static char dxl[] = "0123456789abcdef";
 #define FROM_HEX(c)	(int)(strchr(dxl, tolower((unsigned char)c)) - dxl)
@@ -255,6 +269,60 @@ static action_table_t kybd_dactions[] = {
     { AnCompose,	Compose_action,		ACTION_KE }
 };
 
+/*
+ * Store a typeahead parameter in a slot.
+ */
+static void
+ta_set_parm(ta_t *ta, unsigned i, const char *parm)
+{
+    size_t sl = strlen(parm);
+
+    if (sl < TA_PARM_INLINE) {
+	memcpy(ta->parm_inline[i], parm, sl + 1);
+	ta->parm_heap[i] = NULL;
+    } else {
+	ta->parm_heap[i] = NewString(parm);
+    }
+}
+
+/*
+ * Return a typeahead parameter from a slot.
+ */
+static const char *
+ta_parm(const ta_t *ta, unsigned i)
+{
+    return ta->parm_heap[i]? ta->parm_heap[i]: ta->parm_inline[i];
+}
+
+/*
+ * Free the heap storage for a slot's parameters.
+ */
+static void
+ta_free_parms(ta_t *ta)
+{
+    Replace(ta->parm_heap[0], NULL);
+    Replace(ta->parm_heap[1], NULL);
+}
+
+/*
+ * Grow the typeahead ring, preserving the order of the queued entries.
+ */
+static void
+ta_grow(void)
+{
+    unsigned new_size = ta_ring_size? ta_ring_size * 2: TA_RING_INIT;
+    ta_t *new_ring = (ta_t *)Malloc(new_size * sizeof(ta_t));
+    unsigned i;
+
+    for (i = 0; i < ta_count; i++) {
+	new_ring[i] = ta_ring[(ta_first + i) % ta_ring_size];
+    }
+    Free(ta_ring);
+    ta_ring = new_ring;
+    ta_ring_size = new_size;
+    ta_first = 0;
+}
+
 /*
  * Put a function or action on the typeahead queue.
  */
@@ -266,6 +334,7 @@ enq_xta(const char *name, action_t *fn, const char *parm1, const char *parm2)
     /* If no connection, forget it. */
     if (!IN_3270 && !IN_NVT && !IN_SSCP) {
 	vtrace("  dropped (not connected)\n");
+	ta_dropped++;
 	return;
     }
 
@@ -273,6 +342,7 @@ enq_xta(const char *name, action_t *fn, const char *parm1, const char *parm2)
     if (kybdlock & KL_OERR_MASK) {
 	ring_bell();
 	vtrace("  dropped (operator error)\n");
+	ta_dropped++;
 	return;
     }
 
@@ -280,6 +350,7 @@ enq_xta(const char *name, action_t *fn, const char *parm1, const char *parm2)
     if (kybdlock & KL_SCROLLED) {
 	ring_bell();
 	vtrace("  dropped (scrolled)\n");
+	ta_dropped++;
 	return;
     }
 
@@ -287,33 +358,37 @@ enq_xta(const char *name, action_t *fn, const char *parm1, const char *parm2)
     if (kybdlock & KL_FT) {
 	ring_bell();
 	vtrace("  dropped (file transfer in progress)\n");
+	ta_dropped++;
 	return;
     }
 
     /* If typeahead disabled, complain and drop it. */
     if (!toggled(TYPEAHEAD)) {
 	vtrace("  dropped (no typeahead)\n");
+	ta_dropped++;
 	return;
     }
 
-    ta = (ta_t *)Malloc(sizeof(*ta));
-    ta->next = NULL;
+    if (ta_count == ta_ring_size) {
+	ta_grow();
+    }
+    ta = &ta_ring[(ta_first + ta_count) % ta_ring_size];
     ta->efn_name = name;
     ta->fn = fn;
-    ta->parm1 = ta->parm2 = NULL;
+    ta->nparms = 0;
+    ta->parm_heap[0] = ta->parm_heap[1] = NULL;
     if (parm1) {
-	ta->parm1 = NewString(parm1);
+	ta_set_parm(ta, ta->nparms++, parm1);
 	if (parm2) {
-	    ta->parm2 = NewString(parm2);
+	    ta_set_parm(ta, ta->nparms++, parm2);
 	}
     }
-    if (ta_head) {
-	ta_tail->next = ta;
-    } else {
-	ta_head = ta;
+    if (ta_count++ == 0) {
 	vstatus_typeahead(true);
     }
-    ta_tail = ta;
+    if (ta_count > ta_peak) {
+	ta_peak = ta_count;
+    }
 
     vtrace("  action queued (kybdlock 0x%x)\n", kybdlock);
 }
@@ -342,34 +417,36 @@ enq_fta(action_t *fn, const char *parm1, const char *parm2)
 bool
 run_ta(void)
 {
-    ta_t *ta;
+    ta_t ta;
 
-    if (kybdlock || (ta = ta_head) == NULL) {
+    if (kybdlock || ta_count == 0) {
 	return false;
     }
 
-    if ((ta_head = ta->next) == NULL) {
-	ta_tail = NULL;
+    /*
+     * Copy the slot out of the ring before running it, because the action
+     * may queue more typeahead and move the ring.
+     */
+    ta = ta_ring[ta_first];
+    ta_first = (ta_first + 1) % ta_ring_size;
+    if (--ta_count == 0) {
 	vstatus_typeahead(false);
     }
 
-    if (ta->efn_name) {
-	run_action(ta->efn_name, IA_TYPEAHEAD, ta->parm1, ta->parm2);
+    if (ta.efn_name) {
+	run_action(ta.efn_name, IA_TYPEAHEAD,
+		(ta.nparms > 0)? ta_parm(&ta, 0): NULL,
+		(ta.nparms > 1)? ta_parm(&ta, 1): NULL);
     } else {
-	unsigned argc = 0;
+	unsigned i;
 	const char *argv[2];
 
-	if (ta->parm1) {
-	    argv[argc++] = ta->parm1;
-	    if (ta->parm2) {
-		argv[argc++] = ta->parm2;
-	    }
+	for (i = 0; i < ta.nparms; i++) {
+	    argv[i] = ta_parm(&ta, i);
 	}
-	(*ta->fn)(IA_TYPEAHEAD, argc, argv);
+	(*ta.fn)(IA_TYPEAHEAD, ta.nparms, argv);
     }
-    Free((char *)ta->parm1);
-    Free((char *)ta->parm2);
-    Free(ta);
+    ta_free_parms(&ta);
 
     return true;
 }
@@ -381,17 +458,15 @@ run_ta(void)
 static bool
 flush_ta(void)
 {
-    ta_t *ta, *next;
-    bool any = false;
+    bool any = (ta_count != 0);
 
-    for (ta = ta_head; ta != NULL; ta = next) {
-	Free((char *)ta->parm1);
-	Free((char *)ta->parm2);
-	next = ta->next;
-	Free(ta);
-	any = true;
+    while (ta_count) {
+	ta_free_parms(&ta_ring[ta_first]);
+	ta_first = (ta_first + 1) % ta_ring_size;
+	ta_count--;
+	ta_flushed++;
     }
-    ta_head = ta_tail = NULL;
+    ta_first = 0;
     vstatus_typeahead(false);
     return any;
 }
@@ -774,6 +849,14 @@ toggle_insert_mode(toggle_index_t ix, enum toggle_type type)
     vstatus_insert_mode(toggled(INSERT_MODE));
 }
 
+/* Dump the typeahead queue statistics. */
+static const char *
+typeahead_dump(void)
+{
+    return txAsprintf("queued %u peak %u dropped %lu flushed %lu", ta_count,
+	    ta_peak, ta_dropped, ta_flushed);
+}
+
 /* Dump the keyboard lock state. */
 static const char *
 kybdlock_dump(void)
@@ -798,6 +881,7 @@ kybd_register(void)
     };
     static query_t queries[] = {
 	{ KwKeyboardLock, kybdlock_dump, NULL, false, false },
+	{ KwTypeahead, typeahead_dump, NULL, false, false },
     };
 
     /* Register interest in connect and disconnect events. */
@@ -1145,6 +1229,50 @@ key_Character_wrapper(ia_t ia _is_unused, unsigned argc, const char **argv)
     return true;
 }
 
+/*
+ * Replace leading nulls with blanks in the field at faddr, if blank fill
+ * mode is on, working backwards from the position before baddr.
+ */
+static void
+blank_fill(int baddr, int faddr)
+{
+    register int baddr_fill = baddr;
+
+    if (!formatted || !toggled(BLANK_FILL)) {
+	return;
+    }
+
+    DEC_BA(baddr_fill);
+    while (baddr_fill != faddr) {
+
+	/* Check for backward line wrap. */
+	if ((baddr_fill % COLS) == COLS - 1) {
+	    bool aborted = true;
+	    register int baddr_scan = baddr_fill;
+
+	    /* Check the field within the preceeding line for NULs. */
+	    while (baddr_scan != faddr) {
+		if (ea_buf[baddr_scan].ec != EBC_null) {
+		    aborted = false;
+		    break;
+		}
+		if (!(baddr_scan % COLS)) {
+		    break;
+		}
+		DEC_BA(baddr_scan);
+	    }
+	    if (aborted) {
+		break;
+	    }
+	}
+
+	if (ea_buf[baddr_fill].ec == EBC_null) {
+	    ctlr_add(baddr_fill, EBC_space, 0);
+	}
+	DEC_BA(baddr_fill);
+    }
+}
+
 /*
  * Handle an ordinary displayable character key.  Lots of stuff to handle
  * insert-mode, protected fields and etc.
@@ -1354,39 +1482,7 @@ key_Character(unsigned ebc, bool with_ge, bool pasting, bool oerr_fail,
     }
 
     /* Replace leading nulls with blanks, if desired. */
-    if (formatted && toggled(BLANK_FILL)) {
-	register int baddr_fill = baddr;
-
-	DEC_BA(baddr_fill);
-	while (baddr_fill != faddr) {
-
-	    /* Check for backward line wrap. */
-	    if ((baddr_fill % COLS) == COLS - 1) {
-		bool aborted = true;
-		register int baddr_scan = baddr_fill;
-
-		/* Check the field within the preceeding line for NULs. */
-		while (baddr_scan != faddr) {
-		    if (ea_buf[baddr_scan].ec != EBC_null) {
-			aborted = false;
-			break;
-		    }
-		    if (!(baddr_scan % COLS)) {
-			break;
-		    }
-		    DEC_BA(baddr_scan);
-		}
-		if (aborted) {
-		    break;
-		}
-	    }
-
-	    if (ea_buf[baddr_fill].ec == EBC_null) {
-		ctlr_add(baddr_fill, EBC_space, 0);
-	    }
-	    DEC_BA(baddr_fill);
-	}
-    }
+    blank_fill(baddr, faddr);
 
     mdt_set(cursor_addr);
 
@@ -3721,6 +3817,114 @@ ns_action(action_t action, enum iaction cause, const char *param)
 
 }
 
+/*
+ * Fast path for String() and pasting: type a run of ordinary characters into
+ * an unprotected field in one step.
+ *
+ * Only the simple case is handled: a formatted 3270-mode screen, no insert,
+ * reverse-input or overlay-paste mode, no compose sequence in progress, and
+ * the cursor in an unprotected SBCS field with no DBCS subfields in the way.
+ * The run stops at the end of the field (or of the row, when pasting) and at
+ * the first character that needs individual treatment, which is left to
+ * key_UCharacter().
+ *
+ * Returns the number of characters consumed, which may be 0.
+ */
+static size_t
+key_UCharacter_run(const ucs4_t *ws, size_t xlen, enum iaction ia,
+	bool pasting)
+{
+    static unsigned char *ebc_run = NULL;
+    static unsigned char *cs_run = NULL;
+    static int run_alloc = 0;
+    int baddr, faddr, end;
+    unsigned char fa;
+    int n = 0;
+
+    if (!IN_3270 || IN_SSCP || !formatted || composing != NONE ||
+	    toggled(INSERT_MODE) || toggled(REVERSE_INPUT) ||
+	    (pasting && toggled(OVERLAY_PASTE))) {
+	return 0;
+    }
+    baddr = cursor_addr;
+    if (ea_buf[baddr].fa) {
+	return 0;
+    }
+    faddr = find_field_attribute(baddr);
+    fa = ea_buf[faddr].fa;
+    if (FA_IS_PROTECTED(fa) || ea_buf[faddr].cs == CS_DBCS) {
+	return 0;
+    }
+
+    /* Stay within the field, the buffer and (when pasting) the row. */
+    end = pasting? ((baddr / COLS) + 1) * COLS: ROWS * COLS;
+    if (run_alloc < end - baddr) {
+	run_alloc = end - baddr;
+	ebc_run = (unsigned char *)Realloc(ebc_run, run_alloc);
+	cs_run = (unsigned char *)Realloc(cs_run, run_alloc);
+    }
+
+    while ((size_t)n < xlen && baddr + n < end && !ea_buf[baddr + n].fa) {
+	ucs4_t c = ws[n];
+	ebc_t ebc;
+	bool ge;
+
+	/* Controls, backslashes and private-use characters are special. */
+	if (c < 0x20 || c == '\\' || (c >= UPRIV2 && c <= UPRIV_dup)) {
+	    break;
+	}
+	ebc = unicode_to_ebcdic_ge(c, &ge, toggled(APL_MODE));
+	if (ebc < EBC_space || (ebc & 0xff00)) {
+	    break;
+	}
+	if (FA_IS_NUMERIC(fa) && appres.numeric_lock &&
+		!((ebc >= EBC_0 && ebc <= EBC_9) ||
+		  ebc == EBC_plus ||
+		  ebc == EBC_minus ||
+		  ebc == EBC_period ||
+		  ebc == EBC_comma)) {
+	    break;
+	}
+	if (dbcs) {
+	    enum dbcs_why why;
+	    enum dbcs_state d;
+
+	    if (ea_buf[baddr + n].ec == EBC_so ||
+		    ea_buf[baddr + n].ec == EBC_si) {
+		break;
+	    }
+	    d = ctlr_lookleft_state(baddr + n, &why);
+	    if (d == DBCS_LEFT || d == DBCS_RIGHT) {
+		break;
+	    }
+	}
+	ebc_run[n] = (unsigned char)ebc;
+	cs_run[n] = ge? CS_GE: 0;
+	n++;
+    }
+    if (n == 0) {
+	return 0;
+    }
+
+    vtrace(" %s -> %d characters\n", ia_name[(int) ia], n);
+    ctlr_add_run(baddr, ebc_run, cs_run, n);
+    baddr = (baddr + n) % (ROWS * COLS);
+    blank_fill(baddr, faddr);
+    mdt_set(cursor_addr);
+
+    /* Implement auto-skip, and don't land on attribute bytes. */
+    while (ea_buf[baddr].fa) {
+	if (FA_IS_SKIP(ea_buf[baddr].fa)) {
+	    baddr = next_unprotected(baddr);
+	} else {
+	    INC_BA(baddr);
+	}
+    }
+    cursor_move(baddr);
+    ctlr_dbcs_postprocess();
+    return n;
+}
+
 /*
  * Pretend that a sequence of keys was entered at the keyboard.
  *
@@ -3901,7 +4105,14 @@ emulate_uinput(const ucs4_t *ws, size_t xlen, bool pasting)
 		    /* Untranslatable CP 310 code point. */
 		    key_Character(c - UPRIV_GE_00, true, ia, true, NULL);
 		} else {
+		    size_t n;
+
 		    /* Ordinary text. */
+		    if ((n = key_UCharacter_run(ws, xlen, ia, pasting)) > 0) {
+			ws += n;
+			xlen -= n;
+			continue;
+		    }
 		    key_UCharacter(c, KT_STD, ia, true);
 		}
 		break;
@@ -1,2 +1,2 @@
 # Object files for lib3270i.
-LIB3270I_OBJECTS = scroll.o
+LIB3270I_OBJECTS = ea_compress.o scroll.o
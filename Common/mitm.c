@@ -30,11 +30,15 @@
 #include "globals.h"
 
 #include <errno.h>
+#include <time.h>
+#include <sys/time.h>
 #if defined(HAVE_GETOPT_H) /*[*/
 # include <getopt.h>		/* why isn't this necessary elsewhere? */
 #endif /*]*/
 #if !defined(_WIN32) /*[*/
+# include <fcntl.h>
 # include <netdb.h>
+# include <poll.h>
 # include <signal.h>
 # include <unistd.h>
 # include <sys/types.h>
@@ -51,15 +55,82 @@
 #if !defined(_WIN32) /*[*/
 # define DIRSEP '/'
 # define sockerr(s)	perror(s)
+# define CONNECT_PENDING(e)	((e) == EINPROGRESS)
 #else /*][*/
 # define DIRSEP '\\'
 # define sockerr(s)	win32_perror(s)
+# define poll		WSAPoll
+typedef unsigned long nfds_t;
+# define SHUT_WR	SD_SEND
+# define CONNECT_PENDING(e)	((e) == WSAEWOULDBLOCK)
 #endif /*]*/
 
+/* Size of the relay buffer for each direction of a connection. */
+#define RELAY_BUFSIZE	16384
+
+/* Maximum length of a passthru request line. */
+#define REQ_MAX		512
+
+/* How often to check for finished host name lookups, in milliseconds. */
+#define RESOLVE_POLL_MS	10
+
+/* One direction of a relayed connection. */
+typedef struct {
+    char direction;		/* '>' emulator to host, '<' host to emulator */
+    const char *name;		/* name of the sender */
+    socket_t *from;		/* socket data is read from */
+    socket_t *to;		/* socket data is written to */
+    bool open;			/* false once the sender has closed */
+    bool shut;			/* true once the receiver has been shut down */
+    char *buf;			/* data read but not sent yet */
+    size_t len;			/* length of data in buf */
+    size_t offset;		/* offset of unsent data in buf */
+} relay_t;
+
+/* Connection states. */
+typedef enum {
+    CS_REQUEST,			/* reading the passthru request */
+    CS_RESOLVING,		/* looking up the host name */
+    CS_CONNECTING,		/* connecting to the host */
+    CS_RELAY			/* relaying data */
+} cstate_t;
+
+/* A connection from an emulator. */
+typedef struct conn {
+    struct conn *next;
+    unsigned id;		/* connection number */
+    cstate_t state;		/* state */
+    FILE *f;			/* trace file */
+    socket_t e;			/* emulator socket */
+    socket_t h;			/* host socket */
+    char req[REQ_MAX];		/* passthru request */
+    size_t req_len;		/* length of passthru request */
+    relay_t to_host;		/* emulator to host */
+    relay_t to_emul;		/* host to emulator */
+    int e_ix;			/* index of e in the poll array, or -1 */
+    int h_ix;			/* index of h in the poll array, or -1 */
+    bool done;			/* true if ready to be freed */
+#if defined(HAVE_GETADDRINFO_A) /*[*/
+    struct gaicb gai;		/* host name lookup */
+    struct addrinfo hints;	/* host name lookup hints */
+    char thru_host[256];	/* host name */
+    char thru_port[6];		/* port */
+#endif /*]*/
+} conn_t;
+
 static char *me;
-#if 0
-static void sockerr(const char *s);
-#endif
+static bool multi = false;
+static char *file = NULL;
+static const char *file_suffix = "";
+static FILE *single_f = NULL;
+static conn_t *conns = NULL;
+static unsigned conn_count = 0;
+#if !defined(_WIN32) /*[*/
+static volatile sig_atomic_t stopping = 0;
+#else /*][*/
+static bool stopping = false;
+#endif /*]*/
+
 static void netdump(FILE *f, char direction, unsigned char *buffer,
 	size_t length);
 
@@ -67,31 +138,545 @@ static void netdump(FILE *f, char direction, unsigned char *buffer,
 static void
 mitm_usage(void)
 {
-    fprintf(stderr, "Usage: %s [-p listenport] [-f outfile]\n", me);
+    fprintf(stderr, "Usage: %s [-m] [-p listenport] [-f outfile]\n", me);
     exit(1);
 }
 
+/* Return a timestamp for the trace file. */
+static const char *
+timestamp(void)
+{
+    static char ts[64];
+    struct timeval tv;
+    time_t t;
+    size_t len;
+
+    gettimeofday(&tv, NULL);
+    t = tv.tv_sec;
+    len = strftime(ts, sizeof(ts), "%Y%m%d.%H%M%S", localtime(&t));
+    snprintf(ts + len, sizeof(ts) - len, ".%03d", (int)(tv.tv_usec / 1000));
+    return ts;
+}
+
+/* Open a trace file and write its header. */
+static FILE *
+open_trace(const char *path)
+{
+    FILE *f;
+    time_t t;
+
+    f = fopen(path, "w");
+    if (f == NULL) {
+	perror(path);
+	return NULL;
+    }
+    fprintf(f, "Recorded by %s\n", build);
+    t = time(NULL);
+    fprintf(f, "Started %s", asctime(gmtime(&t)));
+    return f;
+}
+
+/* Make a socket non-blocking. */
+static bool
+set_nonblocking(socket_t s)
+{
+#if !defined(_WIN32) /*[*/
+    int flags = fcntl(s, F_GETFL);
+
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#else /*][*/
+    u_long on = 1;
+
+    return ioctlsocket(s, FIONBIO, &on) == 0;
+#endif /*]*/
+}
+
+/* Returns true if the last socket operation would have blocked. */
+static bool
+would_block(void)
+{
+#if !defined(_WIN32) /*[*/
+    return errno == EWOULDBLOCK || errno == EAGAIN || errno == EINTR;
+#else /*][*/
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#endif /*]*/
+}
+
+/* Return the text for the last socket error. */
+static const char *
+socket_errtext(void)
+{
+#if !defined(_WIN32) /*[*/
+    return strerror(errno);
+#else /*][*/
+    static char buf[1024];
+    unsigned err = WSAGetLastError();
+
+    if (FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, NULL, err,
+		MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), buf, sizeof(buf),
+		NULL) == 0) {
+	snprintf(buf, sizeof(buf), "0x%x", err);
+    }
+    return buf;
+#endif /*]*/
+}
+
+/* Report a connection failure, and arrange for the connection to be freed. */
+static void
+conn_fail(conn_t *c, const char *fmt, ...)
+{
+    va_list args;
+    char *msg;
+
+    va_start(args, fmt);
+    msg = Vasprintf(fmt, args);
+    va_end(args);
+    fprintf(stderr, "%s: connection %u: %s\n", me, c->id, msg);
+    fprintf(c->f, "%s %s\n", timestamp(), msg);
+    Free(msg);
+    c->done = true;
+}
+
+/* Set up one direction of a connection. */
+static void
+relay_init(relay_t *r, char direction, const char *name,
+	socket_t *from, socket_t *to)
+{
+    r->direction = direction;
+    r->name = name;
+    r->from = from;
+    r->to = to;
+    r->open = true;
+    r->shut = false;
+    r->buf = Malloc(RELAY_BUFSIZE);
+    r->len = 0;
+    r->offset = 0;
+}
+
+/* Free the resources for one direction of a connection. */
+static void
+relay_free(relay_t *r)
+{
+    Free(r->buf);
+    r->buf = NULL;
+}
+
+/* Returns the amount of data waiting to be sent in one direction. */
+static size_t
+relay_pending(relay_t *r)
+{
+    return r->len - r->offset;
+}
+
+/*
+ * Send pending data in one direction.
+ * Returns false if the connection failed.
+ */
+static bool
+relay_flush(conn_t *c, relay_t *r)
+{
+    while (r->offset < r->len) {
+	ssize_t nw = send(*r->to, r->buf + r->offset, r->len - r->offset, 0);
+
+	if (nw < 0) {
+	    if (would_block()) {
+		return true;
+	    }
+	    conn_fail(c, "%s send: %s", (r->direction == '>')? "Host":
+		    "Emulator", socket_errtext());
+	    return false;
+	}
+	r->offset += nw;
+    }
+    r->len = r->offset = 0;
+
+    /* Pass on an EOF once everything has been sent. */
+    if (!r->open && !r->shut) {
+	shutdown(*r->to, SHUT_WR);
+	r->shut = true;
+    }
+    return true;
+}
+
+/*
+ * Read and trace data in one direction, and try to send it.
+ * Returns false if the connection failed.
+ */
+static bool
+relay_input(conn_t *c, relay_t *r)
+{
+    ssize_t nr;
+
+    nr = recv(*r->from, r->buf, RELAY_BUFSIZE, 0);
+    if (nr > 0) {
+	fprintf(c->f, "%s %s data\n", timestamp(), r->name);
+	netdump(c->f, r->direction, (unsigned char *)r->buf, nr);
+	r->len = nr;
+	r->offset = 0;
+    }
+    if (nr < 0) {
+	if (c->done) {
+	    return false;
+	}
+	if (would_block()) {
+	    return true;
+	}
+	conn_fail(c, "%s recv: %s", r->name, socket_errtext());
+	return false;
+    }
+    if (nr == 0) {
+	fprintf(c->f, "%s %s EOF\n", timestamp(), r->name);
+	r->open = false;
+    }
+    return relay_flush(c, r);
+}
+
+/* Start relaying data on a connection. */
+static void
+conn_relay(conn_t *c)
+{
+    fprintf(c->f, "%s Connected\n", timestamp());
+    c->state = CS_RELAY;
+    relay_flush(c, &c->to_host);
+}
+
+/* Start connecting to the host. */
+static void
+conn_connect(conn_t *c, int family, const struct sockaddr *sa, socklen_t len)
+{
+    c->h = socket(family, SOCK_STREAM, 0);
+    if (c->h == INVALID_SOCKET) {
+	conn_fail(c, "socket: %s", socket_errtext());
+	return;
+    }
+    set_nonblocking(c->h);
+    if (connect(c->h, sa, len) == 0) {
+	conn_relay(c);
+    } else if (CONNECT_PENDING(socket_errno())) {
+	c->state = CS_CONNECTING;
+    } else {
+	conn_fail(c, "connect: %s", socket_errtext());
+    }
+}
+
+#if defined(HAVE_GETADDRINFO_A) /*[*/
+/*
+ * Start looking up the host name in the background, so a slow lookup does
+ * not hold up the other connections.
+ */
+static void
+conn_resolve(conn_t *c, const char *thru_host, unsigned thru_port)
+{
+    struct gaicb *list[1];
+    int rc;
+
+    snprintf(c->thru_host, sizeof(c->thru_host), "%s", thru_host);
+    snprintf(c->thru_port, sizeof(c->thru_port), "%u", thru_port);
+    memset(&c->hints, 0, sizeof(c->hints));
+    c->hints.ai_family = AF_UNSPEC;
+    c->hints.ai_socktype = SOCK_STREAM;
+    c->gai.ar_name = c->thru_host;
+    c->gai.ar_service = c->thru_port;
+    c->gai.ar_request = &c->hints;
+    c->gai.ar_result = NULL;
+    list[0] = &c->gai;
+    rc = getaddrinfo_a(GAI_NOWAIT, list, 1, NULL);
+    if (rc != 0) {
+	conn_fail(c, "getaddrinfo_a(%s): %s", thru_host, gai_strerror(rc));
+	return;
+    }
+    c->state = CS_RESOLVING;
+}
+
+/* Check for a finished host name lookup, and connect to the host. */
+static void
+conn_resolved(conn_t *c)
+{
+    struct addrinfo *ai;
+    int rc;
+
+    rc = gai_error(&c->gai);
+    if (rc == EAI_INPROGRESS) {
+	return;
+    }
+    if (rc != 0) {
+	conn_fail(c, "getaddrinfo_a(%s): %s", c->thru_host, gai_strerror(rc));
+	return;
+    }
+    ai = c->gai.ar_result;
+    c->gai.ar_result = NULL;
+    conn_connect(c, ai->ai_family, ai->ai_addr, ai->ai_addrlen);
+    freeaddrinfo(ai);
+}
+
+/* Cancel a host name lookup, waiting for it if it cannot be cancelled. */
+static void
+conn_resolve_cancel(conn_t *c)
+{
+    const struct gaicb *list[1];
+
+    if (c->state != CS_RESOLVING) {
+	return;
+    }
+    list[0] = &c->gai;
+    if (gai_cancel(&c->gai) == EAI_NOTCANCELED) {
+	while (gai_error(&c->gai) == EAI_INPROGRESS) {
+	    gai_suspend(list, 1, NULL);
+	}
+    }
+    if (c->gai.ar_result != NULL) {
+	freeaddrinfo(c->gai.ar_result);
+	c->gai.ar_result = NULL;
+    }
+}
+#else /*][*/
+/*
+ * Look up the host name and connect to the host.
+ * Without getaddrinfo_a(), the lookup blocks the other connections.
+ */
+static void
+conn_resolve(conn_t *c, const char *thru_host, unsigned thru_port)
+{
+    struct hostent *h;
+
+    h = gethostbyname(thru_host);
+    if (h == NULL) {
+	conn_fail(c, "gethostbyname(%s) failed", thru_host);
+	return;
+    }
+    if (h->h_addrtype == AF_INET) {
+	struct sockaddr_in sin_o;
+
+	memset(&sin_o, 0, sizeof(sin_o));
+	sin_o.sin_family = AF_INET;
+	memcpy(&sin_o.sin_addr, h->h_addr_list[0], h->h_length);
+	sin_o.sin_port = htons(thru_port);
+	conn_connect(c, AF_INET, (struct sockaddr *)&sin_o, sizeof(sin_o));
+    } else if (h->h_addrtype == AF_INET6) {
+	struct sockaddr_in6 sin6_o;
+
+	memset(&sin6_o, 0, sizeof(sin6_o));
+	sin6_o.sin6_family = AF_INET6;
+	memcpy(&sin6_o.sin6_addr, h->h_addr_list[0], h->h_length);
+	sin6_o.sin6_port = htons(thru_port);
+	conn_connect(c, AF_INET6, (struct sockaddr *)&sin6_o,
+		sizeof(sin6_o));
+    } else {
+	conn_fail(c, "Unknown address type %d", h->h_addrtype);
+    }
+}
+#endif /*]*/
+
+/* Process the passthru request and start connecting to the host. */
+static void
+conn_request(conn_t *c)
+{
+    ssize_t nr;
+    char *crlf;
+    char thru_host[256];
+    unsigned thru_port;
+    size_t extra;
+
+    nr = recv(c->e, c->req + c->req_len, sizeof(c->req) - c->req_len - 1, 0);
+    if (nr < 0) {
+	if (!would_block()) {
+	    conn_fail(c, "Emulator recv: %s", socket_errtext());
+	}
+	return;
+    }
+    if (nr == 0) {
+	conn_fail(c, "Empty connection");
+	return;
+    }
+    c->req_len += nr;
+    c->req[c->req_len] = '\0';
+    crlf = strstr(c->req, "\r\n");
+    if (crlf == NULL) {
+	if (c->req_len >= sizeof(c->req) - 1) {
+	    conn_fail(c, "Request line does not end in CR/LF");
+	}
+	return;
+    }
+    *crlf = '\0';
+    if (sscanf(c->req, "%255s %u", thru_host, &thru_port) != 2 ||
+	    thru_port == 0 || thru_port > 0xffff) {
+	conn_fail(c, "Malformed request line");
+	return;
+    }
+
+    /* Anything after the request is sent to the host once it connects. */
+    extra = c->req_len - (crlf + 2 - c->req);
+    memcpy(c->to_host.buf, crlf + 2, extra);
+    c->to_host.len = extra;
+    if (extra) {
+	netdump(c->f, '>', (unsigned char *)c->to_host.buf, extra);
+    }
+
+    /* Connect. */
+    fprintf(c->f, "%s Connecting to %s, port %u\n", timestamp(), thru_host,
+	    thru_port);
+    conn_resolve(c, thru_host, thru_port);
+}
+
+/* Finish a non-blocking connect to the host. */
+static void
+conn_connected(conn_t *c)
+{
+    int err = 0;
+    socklen_t len = sizeof(err);
+
+    if (getsockopt(c->h, SOL_SOCKET, SO_ERROR, (char *)&err, &len) < 0) {
+	conn_fail(c, "getsockopt: %s", socket_errtext());
+	return;
+    }
+    if (err != 0) {
+#if !defined(_WIN32) /*[*/
+	errno = err;
+#else /*][*/
+	WSASetLastError(err);
+#endif /*]*/
+	conn_fail(c, "connect: %s", socket_errtext());
+	return;
+    }
+    conn_relay(c);
+}
+
+/* Close a connection and free it. */
+static void
+conn_free(conn_t *c)
+{
+    time_t t;
+
+    SOCK_CLOSE(c->e);
+    if (c->h != INVALID_SOCKET) {
+	SOCK_CLOSE(c->h);
+    }
+#if defined(HAVE_GETADDRINFO_A) /*[*/
+    conn_resolve_cancel(c);
+#endif /*]*/
+    relay_free(&c->to_host);
+    relay_free(&c->to_emul);
+    t = time(NULL);
+    fprintf(c->f, "Stopped %s", asctime(gmtime(&t)));
+    if (c->f != single_f) {
+	fclose(c->f);
+    }
+    Free(c);
+}
+
+/* Accept a new connection. */
+static void
+conn_accept(socket_t s)
+{
+    struct sockaddr_in sin_a;
+    socklen_t a_len;
+    socket_t a;
+    conn_t *c;
+
+    memset(&sin_a, 0, sizeof(sin_a));
+    sin_a.sin_family = AF_INET;
+    a_len = sizeof(sin_a);
+    a = accept(s, (struct sockaddr *)&sin_a, &a_len);
+    if (a == INVALID_SOCKET) {
+	sockerr("accept");
+	return;
+    }
+    set_nonblocking(a);
+
+    c = (conn_t *)Calloc(1, sizeof(conn_t));
+    c->id = ++conn_count;
+    c->e = a;
+    c->h = INVALID_SOCKET;
+    c->state = CS_REQUEST;
+    if (multi) {
+	char *path = Asprintf("%s.%u%s", file, c->id, file_suffix);
+
+	c->f = open_trace(path);
+	Free(path);
+	if (c->f == NULL) {
+	    SOCK_CLOSE(a);
+	    Free(c);
+	    return;
+	}
+    } else {
+	c->f = single_f;
+    }
+    c->next = conns;
+    conns = c;
+
+    fprintf(c->f, "%s Connection %u from %s, port %u\n", timestamp(), c->id,
+	    inet_ntoa(sin_a.sin_addr), ntohs(sin_a.sin_port));
+    relay_init(&c->to_host, '>', "Emulator", &c->e, &c->h);
+    relay_init(&c->to_emul, '<', "Host", &c->h, &c->e);
+}
+
+/* Add a socket to the poll array, or add events to an existing entry. */
+static void
+add_poll(struct pollfd *fds, nfds_t *nfds, int *ix, socket_t s, short events)
+{
+    if (*ix < 0) {
+	*ix = (int)(*nfds)++;
+	fds[*ix].fd = s;
+	fds[*ix].events = 0;
+	fds[*ix].revents = 0;
+    }
+    fds[*ix].events |= events;
+}
+
+/* Add the events a relay is waiting for to the poll array. */
+static void
+relay_poll(conn_t *c, relay_t *r, struct pollfd *fds, nfds_t *nfds)
+{
+    int *from_ix = (r->from == &c->e)? &c->e_ix: &c->h_ix;
+    int *to_ix = (r->to == &c->e)? &c->e_ix: &c->h_ix;
+
+    if (relay_pending(r)) {
+	add_poll(fds, nfds, to_ix, *r->to, POLLOUT);
+    } else if (r->open) {
+	add_poll(fds, nfds, from_ix, *r->from, POLLIN);
+    }
+}
+
+/* Process the events for a relay. */
+static void
+relay_process(conn_t *c, relay_t *r, struct pollfd *fds)
+{
+    int from_ix = (r->from == &c->e)? c->e_ix: c->h_ix;
+    int to_ix = (r->to == &c->e)? c->e_ix: c->h_ix;
+
+    if (c->done) {
+	return;
+    }
+    if (relay_pending(r)) {
+	if (to_ix >= 0 &&
+		(fds[to_ix].revents & (POLLOUT | POLLERR | POLLHUP))) {
+	    relay_flush(c, r);
+	}
+    } else if (r->open && from_ix >= 0 &&
+	    (fds[from_ix].revents & (POLLIN | POLLERR | POLLHUP))) {
+	relay_input(c, r);
+    }
+}
+
+#if !defined(_WIN32) /*[*/
+/* Stop on a signal. */
+static void
+stop_signal(int sig _is_unused)
+{
+    stopping = 1;
+}
+#endif /*]*/
+
 int
 main(int argc, char *argv[])
 {
     int c;
     int port = 4200;
-    char *file = NULL;
-    FILE *f;
-    struct sockaddr_in sin, sin_a;
+    struct sockaddr_in sin;
     socket_t s;
-    socket_t a;
-    socket_t o;
-    socklen_t a_len;
-    char buf[16384];
-    size_t nr;
-    char thru_host[256];
-    unsigned thru_port;
-    struct hostent *h;
-    bool a_open = true, o_open = true;
     int on = 1;
-    int connect_result;
-    time_t t;
+    struct pollfd *fds = NULL;
+    size_t fds_size = 0;
 
 #if defined(_WIN32) /*[*/
     if (sockstart() < 0) {
@@ -113,8 +698,11 @@ main(int argc, char *argv[])
 
     /* Parse options. */
     opterr = 0;
-    while ((c = getopt(argc, argv, "p:f:")) != -1) {
+    while ((c = getopt(argc, argv, "mp:f:")) != -1) {
 	switch (c) {
+	case 'm':
+	    multi = true;
+	    break;
 	case 'p':
 	    port = atoi(optarg);
 	    if (port <= 0 || port > 0xffff) {
@@ -136,7 +724,10 @@ main(int argc, char *argv[])
 	mitm_usage();
     }
 
-    /* Open the output file. */
+    /*
+     * Open the output file. With -m, each connection gets its own file,
+     * named after the output file with the connection number appended.
+     */
     if (file == NULL) {
 #if !defined(_WIN32) /*[*/
 	file = Asprintf("/tmp/mitm.%d", (int)getpid());
@@ -151,19 +742,21 @@ main(int argc, char *argv[])
 		    (int)r);
 	    exit(1);
 	}
-	file = Asprintf("%s\\mitm.%d.txt", desktop, (int)getpid());
+	file = Asprintf("%s\\mitm.%d", desktop, (int)getpid());
+	file_suffix = ".txt";
+	if (!multi) {
+	    file = Asprintf("%s%s", file, file_suffix);
+	}
 #endif /*]*/
     }
-    f = fopen(file, "w");
-    if (f == NULL) {
-	perror(file);
-	exit(1);
+    if (!multi) {
+	single_f = open_trace(file);
+	if (single_f == NULL) {
+	    exit(1);
+	}
     }
-    fprintf(f, "Recorded by %s\n", build);
-    t = time(NULL);
-    fprintf(f, "Started %s", asctime(gmtime(&t)));
 
-    /* Wait for a connection. */
+    /* Listen for connections. */
     s = socket(AF_INET, SOCK_STREAM, 0);
     if (s == INVALID_SOCKET) {
 	sockerr("socket");
@@ -181,167 +774,137 @@ main(int argc, char *argv[])
 	sockerr("bind");
 	exit(1);
     }
-    if (listen(s, 1) < 0) {
+    if (listen(s, multi? SOMAXCONN: 1) < 0) {
 	sockerr("listen");
 	exit(1);
     }
-    memset(&sin_a, 0, sizeof(sin_a));
-    sin_a.sin_family = AF_INET;
-    a_len = sizeof(sin_a);
-    a = accept(s, (struct sockaddr *)&sin_a, &a_len);
-    if (a == INVALID_SOCKET) {
-	sockerr("accept");
-	exit(1);
-    }
-    SOCK_CLOSE(s);
 
-    /* Read the initial request. */
-    nr = recv(a, buf, sizeof(buf), 0);
-    if (nr < 0) {
-	sockerr("recv");
-	exit(1);
-    }
-    if (nr == 0) {
-	fprintf(stderr, "Empty connection\n");
-	exit(1);
-    }
-    if (nr < 2) {
-	fprintf(stderr, "Short read\n");
-	exit(1);
-    }
-    if (buf[nr - 2] != '\r' || buf[nr - 1] != '\n') {
-	fprintf(stderr, "Request line does not end in CR/LF\n");
-	exit(1);
-    }
-    buf[nr - 2] = '\0';
-    if (sscanf(buf, "%256s %u", thru_host, &thru_port) != 2) {
-	fprintf(stderr, "Malformed request line\n");
-	exit(1);
-    }
-
-    /* Connect. */
-    h = gethostbyname(thru_host);
-    if (h == NULL) {
-	fprintf(stderr, "gethostbyname(%s) failed\n", thru_host);
-    }
-    o = socket(h->h_addrtype, SOCK_STREAM, 0);
-    if (o == INVALID_SOCKET) {
-	sockerr("socket");
-	exit(1);
-    }
-    if (h->h_addrtype == AF_INET) {
-	struct sockaddr_in sin_o;
-
-	memset(&sin_o, 0, sizeof(sin_o));
-	sin_o.sin_family = AF_INET;
-	memcpy(&sin_o.sin_addr, h->h_addr_list[0], h->h_length);
-	sin_o.sin_port = htons(thru_port);
-	connect_result = connect(o, (struct sockaddr *)&sin_o, sizeof(sin_o));
-    } else if (h->h_addrtype == AF_INET6) {
-	struct sockaddr_in6 sin6_o;
-
-	memset(&sin6_o, 0, sizeof(sin6_o));
-	sin6_o.sin6_family = AF_INET6;
-	memcpy(&sin6_o.sin6_addr, h->h_addr_list[0], h->h_length);
-	sin6_o.sin6_port = htons(thru_port);
-	connect_result = connect(o, (struct sockaddr *)&sin6_o, sizeof(sin6_o));
-    } else {
-	fprintf(stderr, "Unknown address type %d\n", h->h_addrtype);
-	exit(1);
-    }
-    if (connect_result < 0) {
-	sockerr("connect");
-	exit(1);
-    }
-
-    /* Ignore broken pipes. */
+    /* Ignore broken pipes, and stop cleanly when asked to. */
 #if !defined(_WIN32) /*[*/
     signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, stop_signal);
+    signal(SIGTERM, stop_signal);
 #endif /*]*/
 
-    /* Shuffle and trace. */
-    while (a_open || o_open) {
-	fd_set rfds;
+    /*
+     * Shuffle and trace. Without -m, stop listening after the first
+     * connection, and exit when it is done.
+     */
+    while (!stopping && (s != INVALID_SOCKET || conns != NULL)) {
+	conn_t *cn;
+	conn_t **prev;
+	nfds_t nfds = 0;
+	size_t nconns;
+	int listen_ix = -1;
+	int timeout = -1;
 	int ns;
-	int maxfd = 0;
 
-	FD_ZERO(&rfds);
-	if (a_open) {
-	    FD_SET(a, &rfds);
-	    if (a > maxfd) {
-		maxfd = a;
-	    }
+	/* Build the poll array, with room for each live connection. */
+	nconns = 0;
+	for (cn = conns; cn != NULL; cn = cn->next) {
+	    nconns++;
+	}
+	if (fds_size < 1 + (2 * nconns)) {
+	    fds_size = 1 + (2 * nconns) + 16;
+	    fds = (struct pollfd *)Realloc(fds,
+		    fds_size * sizeof(struct pollfd));
 	}
-	if (o_open) {
-	    FD_SET(o, &rfds);
-	    if (o > maxfd) {
-		maxfd = o;
+	if (s != INVALID_SOCKET) {
+	    add_poll(fds, &nfds, &listen_ix, s, POLLIN);
+	}
+	for (cn = conns; cn != NULL; cn = cn->next) {
+	    cn->e_ix = cn->h_ix = -1;
+	    switch (cn->state) {
+	    case CS_REQUEST:
+		add_poll(fds, &nfds, &cn->e_ix, cn->e, POLLIN);
+		break;
+	    case CS_RESOLVING:
+		timeout = RESOLVE_POLL_MS;
+		break;
+	    case CS_CONNECTING:
+		add_poll(fds, &nfds, &cn->h_ix, cn->h, POLLOUT);
+		break;
+	    case CS_RELAY:
+		relay_poll(cn, &cn->to_host, fds, &nfds);
+		relay_poll(cn, &cn->to_emul, fds, &nfds);
+		break;
 	    }
 	}
 
-	ns = select(maxfd + 1, &rfds, NULL, NULL, NULL);
+	ns = poll(fds, nfds, timeout);
 	if (ns < 0) {
-	    sockerr("select");
+#if !defined(_WIN32) /*[*/
+	    if (errno == EINTR) {
+		continue;
+	    }
+#endif /*]*/
+	    sockerr("poll");
 	    exit(1);
 	}
-	if (a_open && FD_ISSET(a, &rfds)) {
-	    nr = recv(a, buf, sizeof(buf), 0);
-	    if (nr < 0) {
-		sockerr("emulator recv");
-		exit(1);
+
+	/* Process the connections. */
+	for (cn = conns; cn != NULL; cn = cn->next) {
+	    switch (cn->state) {
+	    case CS_REQUEST:
+		if (fds[cn->e_ix].revents) {
+		    conn_request(cn);
+		}
+		break;
+	    case CS_RESOLVING:
+#if defined(HAVE_GETADDRINFO_A) /*[*/
+		conn_resolved(cn);
+#endif /*]*/
+		break;
+	    case CS_CONNECTING:
+		if (fds[cn->h_ix].revents) {
+		    conn_connected(cn);
+		}
+		break;
+	    case CS_RELAY:
+		relay_process(cn, &cn->to_host, fds);
+		relay_process(cn, &cn->to_emul, fds);
+		if (!cn->to_host.open && !cn->to_emul.open &&
+			!relay_pending(&cn->to_host) &&
+			!relay_pending(&cn->to_emul)) {
+		    cn->done = true;
+		}
+		break;
 	    }
-	    if (nr == 0) {
-		fprintf(f, "Emulator EOF\n");
-		shutdown(o, 1);
-		a_open = false;
+	    fflush(cn->f);
+	}
+
+	/* Free the connections that are done. */
+	for (prev = &conns; (cn = *prev) != NULL; ) {
+	    if (cn->done) {
+		*prev = cn->next;
+		conn_free(cn);
 	    } else {
-		netdump(f, '>', (unsigned char *)buf, nr);
-		send(o, buf, nr, 0);
+		prev = &cn->next;
 	    }
 	}
-	if (o_open && FD_ISSET(o, &rfds)) {
-	    nr = recv(o, buf, sizeof(buf), 0);
-	    if (nr < 0) {
-		sockerr("host recv");
-		exit(1);
-	    }
-	    if (nr == 0) {
-		fprintf(f, "Host EOF\n");
-		shutdown(a, 1);
-		o_open = false;
-	    } else {
-		netdump(f, '<', (unsigned char *)buf, nr);
-		send(a, buf, nr, 0);
+
+	/* Accept a new connection. */
+	if (listen_ix >= 0 && fds[listen_ix].revents) {
+	    conn_accept(s);
+	    if (!multi && conns != NULL) {
+		SOCK_CLOSE(s);
+		s = INVALID_SOCKET;
 	    }
 	}
     }
 
-    t = time(NULL);
-    fprintf(f, "Stopped %s", asctime(gmtime(&t)));
-    return 0;
-}
-
-#if 0
-/* Socket error. */
-static void
-sockerr(const char *s)
-{
-#if !defined(_WIN32) /*[*/
-    perror(s);
-#else /*][*/
-    unsigned err = WSAGetLastError();
-    char buf[1024];
+    /* Clean up after a signal. */
+    while (conns != NULL) {
+	conn_t *cn = conns;
 
-    if (FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, NULL, err,
-		MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), buf, sizeof(buf),
-		NULL) == 0) {
-	snprintf(buf, sizeof(buf), "0x%x", err);
+	conns = cn->next;
+	conn_free(cn);
     }
-
-    fprintf(stderr, "%s: socket error %s", s, buf);
-#endif /*]*/
+    if (single_f != NULL) {
+	fclose(single_f);
+    }
+    return 0;
 }
-#endif
 
 /* Display a hex dump of a buffer. */
 static void
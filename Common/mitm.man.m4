@@ -26,18 +26,34 @@ XX_TH(XX_PRODUCT,1,XX_DATE)
 XX_SH(Name)
 XX_PRODUCT XX_DASH network stream trace facility
 XX_SH(Synopsis)
-XX_FB(XX_PRODUCT) [XX_DASHED(p) XX_FI(listenport)] [XX_DASHED(f) XX_FI(outfile)]
+XX_FB(XX_PRODUCT) [XX_DASHED(m)] ifelse(XX_PLATFORM,unix,`[XX_DASHED(z)] ')[XX_DASHED(p) XX_FI(listenport)] [XX_DASHED(f) XX_FI(outfile)]
 XX_SH(Description)
 XX_FB(XX_PRODUCT) is a proxy server that traces the data passing through it.
 It supports the Sun XX_FI(passthru) protocol, where the client writes the
 desired host name and port, separated by a space and terminated by a carriage
 return and line feed, at the beginning of the session.
 XX_LP
-Network data is written in hexadecimal to the specified file.
+Network data is written in hexadecimal to the specified file, preceded by
+a timestamp for each block of data received.
+XX_LP
+By default, XX_FB(XX_PRODUCT) accepts a single connection and exits when it
+is closed.
+With the XX_FB(XX_DASHED(m)) option, it accepts any number of concurrent
+connections until it is killed, writing each one to a separate file.
 XX_LP
 The name is derived from its position in the network stream: the man in the
 middle.
 XX_SH(Options)
+XX_TP(XX_FB(XX_DASHED(m)))
+Accepts multiple concurrent connections.
+The trace file for each connection is named after XX_FI(outfile), with a
+period and the connection number appended.
+ifelse(XX_PLATFORM,unix,`XX_TP(XX_FB(XX_DASHED(z)))
+Relays data without copying it through XX_FB(XX_PRODUCT), using
+XX_FI(splice)(2).
+A copy of the data is still made for the trace file.
+This option is only available on Linux.
+')dnl
 XX_TP(XX_FB(XX_DASHED(p)) XX_FI(listenport))
 Specifies the port to listen on.
 The default port is 4200.
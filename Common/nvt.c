@@ -1277,6 +1277,64 @@ ansi_printing(int ig1 _is_unused, int ig2 _is_unused)
     return DATA;
 }
 
+/*
+ * Write a run of printable ASCII characters in the ground state into the
+ * current row in one step, with the same effect as passing them through
+ * ansi_printing() one at a time. The run stops at the end of the row.
+ *
+ * Returns the number of characters consumed, or 0 if the first character
+ * needs to go through the state machine.
+ */
+static size_t
+ansi_printing_run(const unsigned char *buf, size_t len)
+{
+    int row_end;
+    size_t n;
+    size_t i;
+
+    if (state != DATA || pmi != 0 || held_wrap || insert_mode ||
+	    once_cset != -1 || csd[cset] != CSD_US ||
+	    cursor_addr / COLS >= scroll_bottom) {
+	return 0;
+    }
+
+    /* Find the run, stopping at anything that would touch a DBCS pair. */
+    row_end = ((cursor_addr / COLS) + 1) * COLS;
+    for (n = 0; n < len && cursor_addr + (int)n < row_end; n++) {
+	if ((buf[n] & 0x80) ||
+		nvt_fn[st[(int)DATA][buf[n]]] != &ansi_printing ||
+		ea_buf[cursor_addr + n].db != DBCS_NONE) {
+	    break;
+	}
+    }
+    if (n < 2) {
+	return 0;
+    }
+
+    scroll_to_bottom();
+    for (i = 0; i < n; i++) {
+	if (toggled(SCREEN_TRACE)) {
+	    trace_char((char)buf[i]);
+	}
+	task_store(buf[i]);
+    }
+    ctlr_add_nvt_run(cursor_addr, buf, (int)n, gr, fg, bg);
+
+    /* Leave the cursor where ansi_printing() would. */
+    if (cursor_addr + (int)n == row_end) {
+	cursor_move(row_end - 1);
+	if (wraparound_mode) {
+	    held_wrap = true;
+	}
+    } else {
+	cursor_move(cursor_addr + (int)n);
+    }
+    nvt_ch = buf[n - 1];
+    pe = 0;
+    task_host_output();
+    return n;
+}
+
 static enum state
 ansi_multibyte(int ig1, int ig2)
 {
@@ -1843,6 +1901,26 @@ nvt_process(unsigned int c)
     task_host_output();
 }
 
+/*
+ * Process a block of NVT data, as if each byte were passed to nvt_process().
+ * Runs of printable characters are written a row at a time.
+ */
+void
+nvt_process_run(const unsigned char *buf, size_t len)
+{
+    size_t i = 0;
+
+    while (i < len) {
+	size_t n = ansi_printing_run(buf + i, len - i);
+
+	if (n == 0) {
+	    nvt_process(buf[i++]);
+	} else {
+	    i += n;
+	}
+    }
+}
+
 void
 nvt_send_up(void)
 {
@@ -41,6 +41,9 @@
 # include <arpa/inet.h>
 # include <arpa/telnet.h>
 # include <sys/select.h>
+# include <sys/stat.h>
+# include <dirent.h>
+# include <poll.h>
 #else /*][*/
 # include "wincmn.h"
 # include "w3misc.h"
@@ -54,21 +57,30 @@
 #include <signal.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <time.h>
 
 #include "bind-opt.h"
 #include "resolver.h"
 #include "sa_malloc.h"
+#include "trace_binary.h"
+#include "utils.h"
 
 #define BSIZE		16384
 #define LINEDUMP_MAX	32
 
 #if !defined(_WIN32) /*[*/
 # define sockerr(s)     perror(s)
+# define SOCK_CLOSE(s)	close(s)
+# define WOULD_BLOCK()	(errno == EWOULDBLOCK || errno == EAGAIN)
 #else /*][*/
 # define sockerr(s)     win32_perror(s)
 # if !defined(SHUT_WR) /*[*/
 #  define SHUT_WR 0x01
 # endif /*]*/
+# define SOCK_CLOSE(s)	closesocket(s)
+# define WOULD_BLOCK()	(WSAGetLastError() == WSAEWOULDBLOCK)
+# define poll		WSAPoll
+typedef unsigned long nfds_t;
 #endif /*]*/
 
 char *me;
@@ -91,6 +103,11 @@ typedef enum {
 static bool step(FILE *f, socket_t s, step_t type);
 static int process_command(FILE *f, socket_t s);
 void trace_netdata(char *direction, unsigned char *buf, size_t len);
+static void hex_lines(FILE *out, const char *direction, unsigned char *buf,
+	size_t len);
+static FILE *open_trace(const char *path, bool to_text);
+static void load_scripts(const char *path);
+static void replay(socket_t s);
 
 #if defined(_WIN32) /*[*/
 static HANDLE stdin_thread = INVALID_HANDLE_VALUE;
@@ -102,6 +119,52 @@ static ssize_t stdin_nr;
 static int stdin_errno;
 #endif /*]*/
 
+/* Replay mode. */
+
+/* One record in a replay script. */
+typedef struct {
+    bool from_host;		/* true if sent by the host */
+    bool timed;			/* true if ms is valid */
+    unsigned long long ms;	/* trace timestamp, in milliseconds */
+    unsigned char *data;	/* data */
+    size_t len;			/* length of data */
+} rec_t;
+
+/* A trace file loaded for replay. */
+typedef struct {
+    char *name;			/* file name */
+    rec_t *recs;		/* records */
+    size_t nrecs;		/* number of records */
+} script_t;
+
+/* A replay session with an emulator. */
+typedef struct session {
+    struct session *next;
+    unsigned id;		/* session number */
+    socket_t s;			/* emulator socket */
+    script_t *script;		/* script being replayed */
+    size_t ix;			/* index of the current record */
+    size_t offset;		/* amount of the current record sent */
+    bool scheduled;		/* true if due is valid */
+    unsigned long long due;	/* time the current record is due */
+    bool blocked;		/* true if the last send would block */
+    size_t got;			/* emulator data toward the current record */
+    unsigned char tail[2];	/* last two bytes from the emulator */
+    bool draining;		/* true if the script is done */
+    bool done;			/* true if ready to be freed */
+    unsigned long long start;	/* start time */
+    unsigned long long nsent;	/* bytes sent */
+    unsigned long long nrcvd;	/* bytes received */
+    int pfd_ix;			/* index in the poll array */
+} session_t;
+
+static bool replay_mode = false;
+static double speed = 0.0;
+static unsigned long max_sessions = 0;
+static script_t *scripts = NULL;
+static size_t nscripts = 0;
+static session_t *sessions = NULL;
+
 void
 usage(const char *s)
 {
@@ -109,6 +172,9 @@ usage(const char *s)
 	fprintf(stderr, "%s\n", s);
     }
     fprintf(stderr, "usage: %s [-b] [-w] [-p port] file\n", me);
+    fprintf(stderr, "       %s -r [-s speed] [-n sessions] [-p port] "
+	    "file|directory\n", me);
+    fprintf(stderr, "       %s -t file\n", me);
     exit(1);
 }
 
@@ -166,6 +232,7 @@ main(int argc, char *argv[])
 #endif /*]*/
     bool bidir = false;
     bool wait = false;
+    bool to_text = false;
     const char *portstring = "4001";
 #if defined(_WIN32) /*[*/
     HANDLE socket_event;
@@ -178,11 +245,31 @@ main(int argc, char *argv[])
 	    me = argv[0];
     }
 
-    while ((c = getopt(argc, argv, "bwp:")) != -1) {
+    while ((c = getopt(argc, argv, "bwp:trs:n:")) != -1) {
+	char *ptr;
+
 	switch (c) {
 	case 'b':
 	    bidir = true;
 	    break;
+	case 'r':
+	    replay_mode = true;
+	    break;
+	case 's':
+	    speed = strtod(optarg, &ptr);
+	    if (ptr == optarg || *ptr != '\0' || speed <= 0.0) {
+		usage("Invalid speed");
+	    }
+	    break;
+	case 'n':
+	    max_sessions = strtoul(optarg, &ptr, 10);
+	    if (ptr == optarg || *ptr != '\0' || max_sessions == 0) {
+		usage("Invalid session count");
+	    }
+	    break;
+	case 't':
+	    to_text = true;
+	    break;
 	case 'w':
 	    wait = true;
 	    break;
@@ -197,6 +284,12 @@ main(int argc, char *argv[])
     if (argc - optind != 1) {
 	usage(NULL);
     }
+    if (replay_mode && (bidir || wait || to_text)) {
+	usage("-r cannot be used with -b, -w or -t");
+    }
+    if (!replay_mode && (speed != 0.0 || max_sessions != 0)) {
+	usage("-s and -n require -r");
+    }
 
 #if defined(_WIN32) /*[*/
     if (sockstart() < 0) {
@@ -204,11 +297,15 @@ main(int argc, char *argv[])
     }
 #endif /*]*/
 
-    /* Open the file. */
-    f = fopen(argv[optind], "r");
-    if (f == NULL) {
-	perror(argv[optind]);
-	exit(1);
+    /* Open the file, or load the scripts for replay. */
+    if (replay_mode) {
+	load_scripts(argv[optind]);
+	f = NULL;
+    } else {
+	f = open_trace(argv[optind], to_text);
+	if (to_text) {
+	    exit(0);
+	}
     }
 
     /* Listen on a socket. */
@@ -230,10 +327,21 @@ main(int argc, char *argv[])
 	sockerr("bind");
 	exit(1);
     }
-    if (listen(s, 1) < 0) {
+    if (listen(s, replay_mode? SOMAXCONN: 1) < 0) {
 	sockerr("listen");
 	exit(1);
     }
+    if (replay_mode) {
+	if (numeric_host_and_port(sa, addrlen, ahost, sizeof(ahost),
+		    aport, sizeof(aport), NULL)) {
+	    printf("Replaying on %s, port %s.\n", ahost, aport);
+	} else {
+	    printf("Replaying.\n");
+	}
+	fflush(stdout);
+	replay(s);
+	exit(0);
+    }
     if (!bidir) {
 #if !defined(_WIN32) /*[*/
     if ((flags = fcntl(s, F_GETFL)) < 0) {
@@ -284,6 +392,7 @@ main(int argc, char *argv[])
 	} else {
 	    printf("Waiting for connection.\n");
 	}
+	fflush(stdout);
 	for (;;) {
 #if !defined(_WIN32) /*[*/
 	    fd_set rfds;
@@ -533,15 +642,179 @@ done:
 void
 trace_netdata(char *direction, unsigned char *buf, size_t len)
 {
+    hex_lines(stdout, direction, buf, len);
+}
+
+/*
+ * Write data in hex, LINEDUMP_MAX bytes per line, in the same format as an
+ * emulator trace file.
+ * Each line is formatted locally and written with a single call.
+ */
+static void
+hex_lines(FILE *out, const char *direction, unsigned char *buf, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    char line[32 + (LINEDUMP_MAX * 2) + 2];
     size_t offset;
 
-    for (offset = 0; offset < len; offset++) {
-	if (!(offset % LINEDUMP_MAX)) {
-	    printf("%s%s 0x%-3x ", (offset ? "\n" : ""), direction, (int)offset);
+    if (len == 0) {
+	fputs("\n", out);
+	return;
+    }
+    for (offset = 0; offset < len; offset += LINEDUMP_MAX) {
+	size_t n = (len - offset < LINEDUMP_MAX)? len - offset: LINEDUMP_MAX;
+	int sl = snprintf(line, 32, "%s 0x%-3x ", direction, (int)offset);
+	char *s = line + ((sl < 32)? sl: 31);
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+	    *s++ = hex[buf[offset + i] >> 4];
+	    *s++ = hex[buf[offset + i] & 0xf];
+	}
+	*s++ = '\n';
+	fwrite(line, s - line, 1, out);
+    }
+}
+
+/* Fetch a big-endian number. */
+static unsigned long long
+get_be(const unsigned char *buf, int len)
+{
+    unsigned long long n = 0;
+
+    while (len--) {
+	n = (n << 8) | *buf++;
+    }
+    return n;
+}
+
+/*
+ * Render the records in a binary trace file as text, in the format of an
+ * emulator trace file. The magic string has already been read.
+ *
+ * Returns false if the file is damaged.
+ */
+static bool
+render_binary(FILE *in, FILE *out)
+{
+    unsigned char hdr[TRB_HDR_LEN];
+    unsigned char *data = NULL;
+    size_t data_size = 0;
+    bool line_start = true;
+    size_t nr;
+
+    while ((nr = fread(hdr, 1, TRB_HDR_LEN, in)) == TRB_HDR_LEN) {
+	size_t len = (size_t)get_be(hdr + 13, 4);
+	char dir[2];
+	char *bp;
+	char *nl;
+	size_t left;
+	size_t n;
+
+	if (len > data_size) {
+	    data_size = len;
+	    data = Realloc(data, data_size);
+	}
+	if (len && fread(data, len, 1, in) != 1) {
+	    fprintf(stderr, "Truncated record in binary trace file\n");
+	    Free(data);
+	    return false;
+	}
+
+	switch (hdr[0]) {
+	case TRB_HOST:
+	case TRB_EMUL:
+	    dir[0] = (char)hdr[0];
+	    dir[1] = '\0';
+	    hex_lines(out, dir, data, len);
+	    line_start = true;
+	    break;
+	case TRB_EVENT:
+	case TRB_TEXT:
+	    /* Timestamp events at the start of each line. */
+	    bp = (char *)data;
+	    left = len;
+	    while (left > 0) {
+		if (line_start && hdr[0] == TRB_EVENT) {
+		    time_t t = (time_t)get_be(hdr + 1, 8);
+		    struct tm *tm = localtime(&t);
+
+		    fprintf(out, "%d%02d%02d.%02d%02d%02d.%03d ",
+			    tm->tm_year + 1900,
+			    tm->tm_mon + 1,
+			    tm->tm_mday,
+			    tm->tm_hour,
+			    tm->tm_min,
+			    tm->tm_sec,
+			    (int)(get_be(hdr + 9, 4) / 1000L));
+		}
+		nl = memchr(bp, '\n', left);
+		n = (nl != NULL)? (size_t)(nl - bp + 1): left;
+		fwrite(bp, n, 1, out);
+		line_start = nl != NULL;
+		bp += n;
+		left -= n;
+	    }
+	    break;
+	default:
+	    fprintf(stderr, "Unknown record type 0x%02x in binary trace file\n",
+		    hdr[0]);
+	    Free(data);
+	    return false;
+	}
+    }
+    Free(data);
+    if (nr != 0) {
+	fprintf(stderr, "Truncated record in binary trace file\n");
+	return false;
+    }
+    return true;
+}
+
+/*
+ * Open a trace file.
+ *
+ * A binary trace file is rendered as text, either to standard output if
+ * to_text is true, or to a temporary file that is played back like a text
+ * trace file.
+ */
+static FILE *
+open_trace(const char *path, bool to_text)
+{
+    FILE *f;
+    FILE *t;
+    char magic[TRB_MAGIC_LEN];
+
+    f = fopen(path, "rb");
+    if (f == NULL) {
+	perror(path);
+	exit(1);
+    }
+    if (fread(magic, TRB_MAGIC_LEN, 1, f) != 1 ||
+	    memcmp(magic, TRB_MAGIC, TRB_MAGIC_LEN)) {
+	if (to_text) {
+	    fprintf(stderr, "%s: not a binary trace file\n", path);
+	    exit(1);
 	}
-	printf("%02x", buf[offset]);
+	rewind(f);
+	return f;
+    }
+
+    if (to_text) {
+	t = stdout;
+    } else if ((t = tmpfile()) == NULL) {
+	perror("tmpfile");
+	exit(1);
+    }
+    if (!render_binary(f, t)) {
+	exit(1);
+    }
+    fclose(f);
+    fflush(t);
+    if (t != stdout) {
+	rewind(t);
     }
-    printf("\n");
+    return t;
 }
 
 /*
@@ -920,6 +1193,589 @@ done:
     return false;
 }
 
+/* Return the current monotonic time, in milliseconds. */
+static unsigned long long
+now_ms(void)
+{
+#if !defined(_WIN32) /*[*/
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((unsigned long long)ts.tv_sec * 1000ULL) +
+	(ts.tv_nsec / 1000000L);
+#else /*][*/
+    return GetTickCount64();
+#endif /*]*/
+}
+
+/* Return the number of days from 1970-01-01 to a date. */
+static long
+days_from_civil(int y, int m, int d)
+{
+    long era;
+    long yoe;
+    long doy;
+
+    y -= (m <= 2);
+    era = ((y >= 0)? y: y - 399) / 400;
+    yoe = y - (era * 400);
+    doy = (((153 * (m + ((m > 2)? -3: 9))) + 2) / 5) + d - 1;
+    return (era * 146097) + (yoe * 365) + (yoe / 4) - (yoe / 100) + doy -
+	719468;
+}
+
+/*
+ * Parse the timestamp at the start of a trace file line
+ * (YYYYmmdd.HHMMSS.mmm).
+ *
+ * Returns true if there is one, with the time in milliseconds in *ms.
+ */
+static bool
+trace_timestamp(const char *line, unsigned long long *ms)
+{
+    int i;
+    int y, mo, d, h, mi, sec, msec;
+
+    for (i = 0; i < 19; i++) {
+	bool ok = (i == 8 || i == 15)? line[i] == '.':
+	    isdigit((unsigned char)line[i]);
+
+	if (!ok) {
+	    return false;
+	}
+    }
+    if (sscanf(line, "%4d%2d%2d.%2d%2d%2d.%3d", &y, &mo, &d, &h, &mi, &sec,
+		&msec) != 7) {
+	return false;
+    }
+    *ms = ((((((unsigned long long)days_from_civil(y, mo, d) * 24) + h) * 60
+		    + mi) * 60 + sec) * 1000) + msec;
+    return true;
+}
+
+/*
+ * Read a line from a file, of any length.
+ *
+ * Returns false at EOF.
+ */
+static bool
+read_line(FILE *f, char **buf, size_t *size)
+{
+    size_t len = 0;
+
+    if (*buf == NULL) {
+	*size = BUFSIZ;
+	*buf = Malloc(*size);
+    }
+    while (fgets(*buf + len, (int)(*size - len), f) != NULL) {
+	len += strlen(*buf + len);
+	if (len > 0 && (*buf)[len - 1] == '\n') {
+	    return true;
+	}
+	*size *= 2;
+	*buf = Realloc(*buf, *size);
+    }
+    return len > 0;
+}
+
+/* Return the value of a hex digit, or -1. */
+static int
+hexval(char c)
+{
+    static char hexes[] = "0123456789abcdef";
+    char *h;
+
+    if (c == '\0' || (h = strchr(hexes, c)) == NULL) {
+	return -1;
+    }
+    return (int)(h - hexes);
+}
+
+/*
+ * Add the data from a trace file data line to a script.
+ *
+ * Consecutive emulator lines are always merged into one record, since the
+ * emulator's output is matched as a unit. Consecutive host data blocks are
+ * merged when replaying at full speed, so they go out in fewer sends.
+ */
+static void
+script_add_line(script_t *script, const char *line, bool timed,
+	unsigned long long ms)
+{
+    bool from_host = line[0] == TRB_HOST;
+    const char *s;
+    size_t offset = 0;
+    rec_t *r = NULL;
+    int hi, lo;
+
+    /* Parse the offset. */
+    for (s = line + 4; hexval(*s) >= 0; s++) {
+	offset = (offset * 16) + hexval(*s);
+    }
+    if (s == line + 4 || (*s != ' ' && *s != '\t')) {
+	return;
+    }
+    while (*s == ' ' || *s == '\t') {
+	s++;
+    }
+
+    /* Find the record to append to, or create a new one. */
+    if (script->nrecs > 0) {
+	r = &script->recs[script->nrecs - 1];
+	if (r->from_host != from_host ||
+		(from_host && offset == 0 && speed != 0.0)) {
+	    r = NULL;
+	}
+    }
+    if (r == NULL) {
+	script->recs = Realloc(script->recs,
+		(script->nrecs + 1) * sizeof(rec_t));
+	r = &script->recs[script->nrecs++];
+	r->from_host = from_host;
+	r->timed = timed;
+	r->ms = ms;
+	r->data = NULL;
+	r->len = 0;
+    }
+
+    /* Append the data. */
+    r->data = Realloc(r->data, r->len + (strlen(s) / 2) + 1);
+    while ((hi = hexval(s[0])) >= 0 && (lo = hexval(s[1])) >= 0) {
+	r->data[r->len++] = (unsigned char)((hi << 4) | lo);
+	s += 2;
+    }
+}
+
+/* Load a trace file into a replay script. */
+static void
+load_script(const char *path)
+{
+    FILE *f = open_trace(path, false);
+    script_t *script;
+    char *line = NULL;
+    size_t size = 0;
+    bool timed = false;
+    unsigned long long ms = 0;
+    size_t nhost = 0;
+    size_t i;
+
+    scripts = Realloc(scripts, (nscripts + 1) * sizeof(script_t));
+    script = &scripts[nscripts];
+    script->name = NewString(path);
+    script->recs = NULL;
+    script->nrecs = 0;
+
+    while (read_line(f, &line, &size)) {
+	if (trace_timestamp(line, &ms)) {
+	    timed = true;
+	} else if ((line[0] == TRB_HOST || line[0] == TRB_EMUL) &&
+		!strncmp(line + 1, " 0x", 3)) {
+	    script_add_line(script, line, timed, ms);
+	}
+    }
+    Free(line);
+    fclose(f);
+
+    /* There is nothing to wait for after the last host record. */
+    while (script->nrecs > 0 && !script->recs[script->nrecs - 1].from_host) {
+	Free(script->recs[--script->nrecs].data);
+    }
+    for (i = 0; i < script->nrecs; i++) {
+	if (script->recs[i].from_host) {
+	    nhost++;
+	}
+    }
+    if (nhost == 0) {
+	fprintf(stderr, "%s: no host data, skipping\n", path);
+	Free(script->recs);
+	Free(script->name);
+	return;
+    }
+    printf("Loaded %s: %u records, %u from the host.\n", path,
+	    (unsigned)script->nrecs, (unsigned)nhost);
+    nscripts++;
+}
+
+/* Compare file names, for qsort. */
+static int
+name_cmp(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/*
+ * Load the replay scripts: a single trace file, or every file in a
+ * directory, in name order.
+ */
+static void
+load_scripts(const char *path)
+{
+    char **names = NULL;
+    size_t nnames = 0;
+    size_t i;
+#if !defined(_WIN32) /*[*/
+    struct stat st;
+    DIR *dir;
+    struct dirent *e;
+
+    if (stat(path, &st) < 0) {
+	perror(path);
+	exit(1);
+    }
+    if (!S_ISDIR(st.st_mode)) {
+	load_script(path);
+    } else {
+	if ((dir = opendir(path)) == NULL) {
+	    perror(path);
+	    exit(1);
+	}
+	while ((e = readdir(dir)) != NULL) {
+	    char *name = Asprintf("%s/%s", path, e->d_name);
+
+	    if (stat(name, &st) == 0 && S_ISREG(st.st_mode)) {
+		names = Realloc(names, (nnames + 1) * sizeof(char *));
+		names[nnames++] = name;
+	    } else {
+		Free(name);
+	    }
+	}
+	closedir(dir);
+    }
+#else /*][*/
+    DWORD attrs = GetFileAttributesA(path);
+    char *pattern;
+    HANDLE h;
+    WIN32_FIND_DATAA fd;
+
+    if (attrs == INVALID_FILE_ATTRIBUTES) {
+	win32_perror("%s", path);
+	exit(1);
+    }
+    if (!(attrs & FILE_ATTRIBUTE_DIRECTORY)) {
+	load_script(path);
+    } else {
+	pattern = Asprintf("%s\\*", path);
+	h = FindFirstFileA(pattern, &fd);
+	Free(pattern);
+	if (h != INVALID_HANDLE_VALUE) {
+	    do {
+		if (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+		    names = Realloc(names, (nnames + 1) * sizeof(char *));
+		    names[nnames++] = Asprintf("%s\\%s", path, fd.cFileName);
+		}
+	    } while (FindNextFileA(h, &fd));
+	    FindClose(h);
+	}
+    }
+#endif /*]*/
+
+    if (names != NULL) {
+	qsort(names, nnames, sizeof(char *), name_cmp);
+	for (i = 0; i < nnames; i++) {
+	    load_script(names[i]);
+	    Free(names[i]);
+	}
+	Free(names);
+    }
+    if (nscripts == 0) {
+	fprintf(stderr, "%s: no trace files to replay\n", path);
+	exit(1);
+    }
+}
+
+/* Set a socket to non-blocking mode. */
+static void
+set_nonblocking(socket_t s)
+{
+#if !defined(_WIN32) /*[*/
+    int flags;
+
+    if ((flags = fcntl(s, F_GETFL)) < 0 ||
+	    fcntl(s, F_SETFL, flags | O_NONBLOCK) < 0) {
+	perror("fcntl");
+	exit(1);
+    }
+#else /*][*/
+    u_long on = 1;
+
+    if (ioctlsocket(s, FIONBIO, &on) < 0) {
+	sockerr("ioctl(FIONBIO)");
+	exit(1);
+    }
+#endif /*]*/
+}
+
+/*
+ * Return the delay before sending a record, scaled by the speed factor.
+ * The delay is the time between the record and the one before it in the
+ * trace.
+ */
+static unsigned long long
+rec_delay(script_t *script, size_t ix)
+{
+    rec_t *r = &script->recs[ix];
+    rec_t *prev;
+
+    if (ix == 0) {
+	return 0;
+    }
+    prev = &script->recs[ix - 1];
+    if (!r->timed || !prev->timed || r->ms <= prev->ms) {
+	return 0;
+    }
+    return (unsigned long long)((r->ms - prev->ms) / speed);
+}
+
+/* The script is done. Send EOF to the emulator and wait for it to close. */
+static void
+session_drain(session_t *s)
+{
+    s->draining = true;
+    shutdown(s->s, SHUT_WR);
+}
+
+/*
+ * Advance a session through its script as far as it can go without
+ * waiting for the emulator or the clock.
+ *
+ * Emulator records are matched loosely, so a reply that differs in length
+ * from the trace does not stall the script. A record that ends in a telnet
+ * command (e.g., IAC EOR or IAC SE) is complete once the emulator has sent
+ * data ending in the same two bytes; any other record is complete once the
+ * emulator has sent as many bytes. Each reply is framed on its own, so
+ * nothing left over from one record counts toward the next.
+ */
+static void
+session_run(session_t *s)
+{
+    while (!s->done && !s->draining) {
+	rec_t *r;
+	int nw;
+
+	if (s->ix >= s->script->nrecs) {
+	    session_drain(s);
+	    return;
+	}
+	r = &s->script->recs[s->ix];
+
+	if (!r->from_host) {
+	    if (r->len >= 2 && r->data[r->len - 2] == IAC) {
+		if (s->got < 2 || memcmp(s->tail, r->data + r->len - 2, 2)) {
+		    return;
+		}
+	    } else if (s->got < r->len) {
+		return;
+	    }
+	    s->got = 0;
+	    memset(s->tail, 0, sizeof(s->tail));
+	    s->ix++;
+	    continue;
+	}
+
+	if (speed != 0.0 && s->offset == 0) {
+	    if (!s->scheduled) {
+		s->due = now_ms() + rec_delay(s->script, s->ix);
+		s->scheduled = true;
+	    }
+	    if (s->due > now_ms()) {
+		return;
+	    }
+	}
+	nw = send(s->s, (char *)r->data + s->offset,
+		(int)(r->len - s->offset), 0);
+	if (nw < 0) {
+	    if (WOULD_BLOCK()) {
+		s->blocked = true;
+		return;
+	    }
+	    sockerr("playback: emulator send");
+	    s->done = true;
+	    return;
+	}
+	s->blocked = false;
+	s->nsent += nw;
+	s->offset += nw;
+	if (s->offset < r->len) {
+	    s->blocked = true;
+	    return;
+	}
+	s->offset = 0;
+	s->scheduled = false;
+	s->ix++;
+    }
+}
+
+/* Process input from the emulator. */
+static void
+session_input(session_t *s)
+{
+    char buf[BSIZE];
+    int nr;
+
+    nr = recv(s->s, buf, BSIZE, 0);
+    if (nr < 0) {
+	if (!WOULD_BLOCK()) {
+	    sockerr("playback: emulator recv");
+	    s->done = true;
+	}
+	return;
+    }
+    if (nr == 0) {
+	s->done = true;
+	return;
+    }
+    s->nrcvd += nr;
+    if (s->draining) {
+	return;
+    }
+    s->got += nr;
+    if (nr >= 2) {
+	memcpy(s->tail, buf + nr - 2, 2);
+    } else {
+	s->tail[0] = s->tail[1];
+	s->tail[1] = (unsigned char)buf[0];
+    }
+    session_run(s);
+}
+
+/* Replay traces to emulators until enough sessions have completed. */
+static void
+replay(socket_t listen_s)
+{
+    struct pollfd *pfds = NULL;
+    size_t npfds = 0;
+    unsigned long accepted = 0;
+    unsigned long finished = 0;
+    unsigned long complete = 0;
+    unsigned long long total_sent = 0;
+    unsigned long long total_rcvd = 0;
+    unsigned long long start = 0;
+
+#if !defined(_WIN32) /*[*/
+    signal(SIGPIPE, SIG_IGN);
+#endif /*]*/
+    set_nonblocking(listen_s);
+
+    while (max_sessions == 0 || finished < max_sessions) {
+	session_t *s;
+	session_t **prev;
+	size_t nsessions = 0;
+	nfds_t nfds = 0;
+	int timeout = -1;
+	unsigned long long now = (speed != 0.0)? now_ms(): 0;
+
+	/* Set up the poll array. */
+	for (s = sessions; s != NULL; s = s->next) {
+	    nsessions++;
+	}
+	if (nsessions + 1 > npfds) {
+	    npfds = nsessions + 1;
+	    pfds = Realloc(pfds, npfds * sizeof(struct pollfd));
+	}
+	if (max_sessions == 0 || accepted < max_sessions) {
+	    pfds[nfds].fd = listen_s;
+	    pfds[nfds].events = POLLIN;
+	    pfds[nfds++].revents = 0;
+	}
+	for (s = sessions; s != NULL; s = s->next) {
+	    s->pfd_ix = (int)nfds;
+	    pfds[nfds].fd = s->s;
+	    pfds[nfds].events = POLLIN | (s->blocked? POLLOUT: 0);
+	    pfds[nfds++].revents = 0;
+	    if (s->scheduled && !s->blocked && !s->draining) {
+		int t = (s->due > now)? (int)(s->due - now): 0;
+
+		if (timeout < 0 || t < timeout) {
+		    timeout = t;
+		}
+	    }
+	}
+
+	if (poll(pfds, nfds, timeout) < 0) {
+	    if (errno == EINTR) {
+		continue;
+	    }
+	    sockerr("poll");
+	    exit(2);
+	}
+
+	/* Run the sessions. */
+	for (s = sessions; s != NULL; s = s->next) {
+	    short revents = pfds[s->pfd_ix].revents;
+
+	    if (revents & (POLLIN | POLLHUP | POLLERR)) {
+		session_input(s);
+	    }
+	    if (!s->done) {
+		session_run(s);
+	    }
+	}
+
+	/* Clean up finished sessions. */
+	prev = &sessions;
+	while ((s = *prev) != NULL) {
+	    if (!s->done) {
+		prev = &s->next;
+		continue;
+	    }
+	    *prev = s->next;
+	    if (s->draining) {
+		printf("Session %u (%s): complete", s->id, s->script->name);
+	    } else {
+		printf("Session %u (%s): emulator disconnected at record %u "
+			"of %u", s->id, s->script->name, (unsigned)s->ix + 1,
+			(unsigned)s->script->nrecs);
+	    }
+	    printf(", %llu bytes sent, %llu bytes received, %.3fs.\n",
+		    s->nsent, s->nrcvd, (now_ms() - s->start) / 1000.0);
+	    fflush(stdout);
+	    finished++;
+	    if (s->draining) {
+		complete++;
+	    }
+	    total_sent += s->nsent;
+	    total_rcvd += s->nrcvd;
+	    SOCK_CLOSE(s->s);
+	    Free(s);
+	}
+
+	/* Accept new connections. */
+	if (nfds > 0 && pfds[0].fd == listen_s &&
+		(pfds[0].revents & POLLIN)) {
+	    while (max_sessions == 0 || accepted < max_sessions) {
+		socket_t s2 = accept(listen_s, NULL, NULL);
+
+		if (s2 < 0) {
+		    if (!WOULD_BLOCK()) {
+			sockerr("accept");
+		    }
+		    break;
+		}
+		set_nonblocking(s2);
+		s = (session_t *)Calloc(1, sizeof(session_t));
+		s->id = (unsigned)++accepted;
+		s->s = s2;
+		s->script = &scripts[(s->id - 1) % nscripts];
+		s->start = now_ms();
+		if (start == 0) {
+		    start = s->start;
+		}
+		s->next = sessions;
+		sessions = s;
+		session_run(s);
+	    }
+	}
+    }
+
+    printf("%lu sessions, %lu complete, %llu bytes sent, %llu bytes "
+	    "received, %.3fs.\n", finished, complete, total_sent, total_rcvd,
+	    (now_ms() - start) / 1000.0);
+    fflush(stdout);
+    if (complete < finished) {
+	exit(2);
+    }
+}
+
 /* Local copy of ut_getenv(), which always fails. */
 const char *
 ut_getenv(const char *name)
@@ -1547,6 +1547,8 @@ opt(unsigned char c)
 void
 trace_netdata(char direction, unsigned const char *buf, size_t len)
 {
+    static const char hex[] = "0123456789abcdef";
+    char line[32 + (LINEDUMP_MAX * 2) + 2];
     size_t offset;
     struct timeval ts;
 
@@ -1560,14 +1562,26 @@ trace_netdata(char direction, unsigned const char *buf, size_t len)
 	vtrace_nts("%c +%gs\n", direction, tdiff);
     }
     ds_ts = ts;
-    for (offset = 0; offset < len; offset++) {
-	if (!(offset % LINEDUMP_MAX)) {
-	    vtrace_nts("%s%c 0x%-3x ",
-		    (offset ? "\n" : ""), direction, (unsigned)offset);
+    if (len == 0) {
+	vtrace_nts("\n");
+	return;
+    }
+
+    /* Format each line locally and trace it with a single call. */
+    for (offset = 0; offset < len; offset += LINEDUMP_MAX) {
+	size_t n = (len - offset < LINEDUMP_MAX)? len - offset: LINEDUMP_MAX;
+	char *s = line + snprintf(line, 32, "%c 0x%-3x ", direction,
+		(unsigned)offset);
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+	    *s++ = hex[buf[offset + i] >> 4];
+	    *s++ = hex[buf[offset + i] & 0xf];
 	}
-	vtrace_nts("%02x", buf[offset]);
+	*s++ = '\n';
+	*s = '\0';
+	vtrace_nts("%s", line);
     }
-    vtrace_nts("\n");
 }
 
 /*
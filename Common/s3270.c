@@ -75,6 +75,7 @@
 #include "query.h"
 #include "rpq.h"
 #include "save_restore.h"
+#include "s3270_modules.h"
 #include "screen.h"
 #include "selectc.h"
 #include "sio_glue.h"
@@ -196,33 +197,7 @@ main(int argc, char *argv[])
      * Call the module registration functions, to build up the tables of
      * actions, options and callbacks.
      */
-    codepage_register();
-    ctlr_register();
-    ft_register();
-    host_register();
-    idle_register();
-    kybd_register();
-    task_register();
-    query_register();
-    nvt_register();
-    pr3287_session_register();
-    print_screen_register();
-    save_restore_register();
-    s3270_register();
-    toggles_register();
-    trace_register();
-    screentrace_register();
-    xio_register();
-    sio_glue_register();
-    hio_register();
-    proxy_register();
-    model_register();
-    net_register();
-    login_macro_register();
-    vstatus_register();
-    prefer_register();
-    telnet_new_environ_register();
-    rpq_register();
+    s3270_modules_register(s3270_register);
 
     argc = parse_command_line(argc, (const char **)argv, &cl_hostname);
 
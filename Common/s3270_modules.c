@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 Paul Mattes.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the names of Paul Mattes nor the names of his contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *	s3270_modules.c
+ *		The list of modules that make up s3270, shared by s3270 and
+ *		the data stream benchmark.
+ */
+
+#include "globals.h"
+
+#include "codepage.h"
+#include "ctlrc.h"
+#include "ft.h"
+#include "host.h"
+#include "httpd-core.h"
+#include "httpd-io.h"
+#include "idle.h"
+#include "kybd.h"
+#include "login_macro.h"
+#include "model.h"
+#include "nvt.h"
+#include "pr3287_session.h"
+#include "prefer.h"
+#include "print_screen.h"
+#include "proxy_toggle.h"
+#include "query.h"
+#include "rpq.h"
+#include "save_restore.h"
+#include "s3270_modules.h"
+#include "sio_glue.h"
+#include "task.h"
+#include "telnet.h"
+#include "telnet_new_environ.h"
+#include "toggles.h"
+#include "trace.h"
+#include "screentrace.h"
+#include "vstatus.h"
+#include "xio.h"
+
+/**
+ * Call the module registration functions, to build up the tables of
+ * actions, options and callbacks.
+ *
+ * @param[in] product_register	Registration function for the program
+ * 				itself, or NULL. It is called at a fixed point
+ * 				in the list, because the order in which state
+ * 				change callbacks are registered matters.
+ */
+void
+s3270_modules_register(void (*product_register)(void))
+{
+    codepage_register();
+    ctlr_register();
+    ft_register();
+    host_register();
+    idle_register();
+    kybd_register();
+    task_register();
+    query_register();
+    nvt_register();
+    pr3287_session_register();
+    print_screen_register();
+    save_restore_register();
+    if (product_register != NULL) {
+	product_register();
+    }
+    toggles_register();
+    trace_register();
+    screentrace_register();
+    xio_register();
+    sio_glue_register();
+    hio_register();
+    proxy_register();
+    model_register();
+    net_register();
+    login_macro_register();
+    vstatus_register();
+    prefer_register();
+    telnet_new_environ_register();
+    rpq_register();
+}
@@ -388,7 +388,7 @@ wait_thread(LPVOID parameter)
 static void
 allocate_wait_group(void)
 {
-    vtrace("sched: Allocating wait group %d\n", num_wait_groups);
+    vctrace(TC_SCHED, "sched: Allocating wait group %d\n", num_wait_groups);
     waitgroups = (waitgroup_t *)Realloc(waitgroups, (num_wait_groups + 1) * sizeof(waitgroup_t));
     waitgroups[num_wait_groups].ha[0] = done_event;
     waitgroups[num_wait_groups].nha = 1;
@@ -500,7 +500,8 @@ sync_wait_threads(DWORD ret)
     }
     for (i = 1; i < num_wait_groups; i++) {
 	if (waitgroups[i].nha > 1 && waitgroups[i].ret != WAIT_OBJECT_0) {
-	    vtrace("sched: Got sub-event 0x%lx from %d\n", waitgroups[i].ret, i);
+	    vctrace(TC_SCHED, "sched: Got sub-event 0x%lx from %d\n",
+		waitgroups[i].ret, i);
 	}
     }
 
@@ -556,11 +557,11 @@ purge_inputs(void)
     if (hold_first != NULL) {
 #if defined(HAVE_POLL) /*[*/
 	if (appres.ut_env && getenv("ORDER") != NULL) {
-	    vtrace("sched: Moved to rear:");
+	    vctrace(TC_SCHED, "sched: Moved to rear:");
 	    for (ip = hold_first; ip != NULL; ip = ip->next) {
-		vtrace(" %d", ip->source);
+		vctrace(TC_SCHED, " %d", ip->source);
 	    }
-	    vtrace("\n");
+	    vctrace(TC_SCHED, "\n");
 	}
 #endif /*]*/
 	if (prev != NULL) {
@@ -723,25 +724,29 @@ process_some_events(bool block, bool *processed_any)
     }
 
     /* Trace what we're about to do. */
-    vtrace("sched: Waiting for ");
+    if (trace_on(TC_SCHED)) {
+	vctrace(TC_SCHED, "sched: Waiting for ");
 #if defined(_WIN32) /*[*/
-    vtrace("%d handle%s", (int)ha_total, (ha_total == 1)? "": "s");
+	vctrace(TC_SCHED, "%d handle%s", (int)ha_total,
+		(ha_total == 1)? "": "s");
 #else /*][*/
-    vtrace("%d event%s", ne, (ne == 1)? "": "s");
+	vctrace(TC_SCHED, "%d event%s", ne, (ne == 1)? "": "s");
 #endif /*]*/
-    tmo_str = trace_tmo(tmo, tmo_buf, sizeof(tmo_buf));
-    vtrace("%s%s\n", tmo_str? " or ": "", tmo_str? tmo_str: "");
+	tmo_str = trace_tmo(tmo, tmo_buf, sizeof(tmo_buf));
+	vctrace(TC_SCHED, "%s%s\n", tmo_str? " or ": "",
+		tmo_str? tmo_str: "");
 #if defined(HAVE_POLL) /*[*/
-    if (appres.ut_env && getenv("ORDER") != NULL) {
-	nfds_t n;
+	if (appres.ut_env && getenv("ORDER") != NULL) {
+	    nfds_t n;
 
-	vtrace("sched: Order:");
-	for (n = 0; n < nfds; n++) {
-	    vtrace(" %d", fds[n].fd);
+	    vctrace(TC_SCHED, "sched: Order:");
+	    for (n = 0; n < nfds; n++) {
+		vctrace(TC_SCHED, " %d", fds[n].fd);
+	    }
+	    vctrace(TC_SCHED, "\n");
 	}
-	vtrace("\n");
-    }
 #endif /*]*/
+    }
 
     /* Wait for events. */
 #if defined(_WIN32) /*[*/
@@ -771,15 +776,17 @@ process_some_events(bool block, bool *processed_any)
     /* Trace what we got. */
 #if defined(_WIN32) /*[*/
     if (ret != WAIT_OBJECT_0) {
-	vtrace("sched: Got event 0x%lx\n", ret);
+	vctrace(TC_SCHED, "sched: Got event 0x%lx\n", ret);
     }
 #elif defined(HAVE_POLL) /*[*/
-    events = count_revents(fds, nfds);
-    vtrace("sched: Got %u fd%s, %d event%s\n",
-	    ns, (ns == 1)? "": "s",
-	    events, (events == 1)? "": "s");
+    if (trace_on(TC_SCHED)) {
+	events = count_revents(fds, nfds);
+	vctrace(TC_SCHED, "sched: Got %u fd%s, %d event%s\n",
+		ns, (ns == 1)? "": "s",
+		events, (events == 1)? "": "s");
+    }
 #else /*][*/
-    vtrace("sched: Got %u event%s\n", ns, (ns == 1)? "": "s");
+    vctrace(TC_SCHED, "sched: Got %u event%s\n", ns, (ns == 1)? "": "s");
 #endif /*]*/
 
 #if defined(_WIN32) /*[*/
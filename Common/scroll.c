@@ -39,6 +39,7 @@
 #include "3270ds.h"
 #include "actions.h"
 #include "ctlrc.h"
+#include "ea_compress.h"
 #include "kybd.h"
 #include "names.h"
 #include "popups.h"
@@ -57,8 +58,14 @@ bool	scroll_initted = false;
 
 /* Statics */
 
-/* Saved screens. */
-static struct ea **ea_save = (struct ea **) NULL;
+/*
+ * Saved lines, compressed. A NULL entry is a line that has never been
+ * saved.
+ */
+static unsigned char **ea_save = NULL;
+
+/* The screen image saved before scrolling back. */
+static struct ea *ea_image = NULL;
 
 /* Number of lines saved. */
 static int      n_saved = 0;
@@ -67,11 +74,15 @@ static int      scroll_next = 0;
 static int      scrolled_back = 0;
 static bool  need_saving = true;
 static bool  vscreen_swapped = false;
-static char    *sbuf = NULL;
-static int      sa_bufsize;
-static char    *zbuf = NULL;
 static struct ea *defaults_buf = NULL;
 
+/* The compressed form of defaults_buf, shared by all padding lines. */
+static unsigned char *zdefaults = NULL;
+
+/* Work buffers for compressing a line. */
+static struct ea *row_buf = NULL;
+static unsigned char *zrow_buf = NULL;
+
 /* Thumb state: */
 /*   Fraction of blank area above thumb (0.0 to 1.0) */
 static float    thumb_top = 0.0;
@@ -89,6 +100,7 @@ static bool	scroll_has_3270;
 static void sync_scroll(int sb);
 static void save_image(void);
 static void scroll_reset(void);
+static void free_saved(void);
 
 /*
  * Initialize (or re-initialize) the scrolling parameters and save area.
@@ -97,8 +109,17 @@ void
 scroll_buf_init(void)
 {
     register int i;
-    int sa_size;
-    unsigned char *s;
+    size_t zlen;
+
+    if (ea_save != NULL) {
+	free_saved();
+	Free(ea_save);
+	Free(ea_image);
+	Free(defaults_buf);
+	Free(zdefaults);
+	Free(row_buf);
+	Free(zrow_buf);
+    }
 
     /* Set the number of rows to save, as a multiple of maxROWS. */
     scroll_max = appres.interactive.save_lines;
@@ -108,19 +129,10 @@ scroll_buf_init(void)
     if (scroll_max < maxROWS * 5) {
 	scroll_max = maxROWS * 5;
     }
-    if (sbuf != NULL) {
-	Free(sbuf);
-	Free(zbuf);
-	Free(defaults_buf);
-	Free(ea_save);
-    }
-    sa_size = scroll_max + maxROWS;
-    ea_save = (struct ea **)Calloc(sizeof(struct ea *), sa_size);
-    sa_bufsize = (sa_size *
-	    (sizeof(unsigned char) + sizeof(struct ea))) * maxCOLS;
-    sbuf = Malloc(sa_bufsize);
-    zbuf = Malloc(maxCOLS);
-    memset(zbuf, '\0', maxCOLS);
+    ea_save = (unsigned char **)Calloc(sizeof(unsigned char *), scroll_max);
+    ea_image = (struct ea *)Calloc(maxROWS * maxCOLS, sizeof(struct ea));
+    row_buf = (struct ea *)Malloc(maxCOLS * sizeof(struct ea));
+    zrow_buf = (unsigned char *)Malloc(EA_COMPRESS_MAX(maxCOLS));
     defaults_buf = Calloc(maxCOLS, sizeof(struct ea));
     for (i = 0; i < maxCOLS; i++) {
 	/*
@@ -131,10 +143,9 @@ scroll_buf_init(void)
 	defaults_buf[i].bg = HOST_COLOR_BLACK;
 	defaults_buf[i].gr = XAH_INTENSIFY & 0x0f;
     }
-    s = (unsigned char *)sbuf;
-    for (i = 0; i < sa_size; s += (maxCOLS * sizeof(struct ea)), i++) {
-	ea_save[i] = (struct ea *)s;
-    }
+    zlen = ea_compress_row(defaults_buf, maxCOLS, zrow_buf);
+    zdefaults = (unsigned char *)Malloc(zlen);
+    memcpy(zdefaults, zrow_buf, zlen);
     scroll_reset();
     scroll_initted = true;
 }
@@ -154,13 +165,62 @@ screen_set_thumb_traced(float top, float shown, int saved, int screen,
     screen_set_thumb(top, shown, saved, screen, back);
 }
 
+/*
+ * Free the saved lines.
+ */
+static void
+free_saved(void)
+{
+    int i;
+
+    for (i = 0; i < scroll_max; i++) {
+	if (ea_save[i] != zdefaults) {
+	    Free(ea_save[i]);
+	}
+	ea_save[i] = NULL;
+    }
+}
+
+/*
+ * Save one line, compressed, at the next position in the save area.
+ * A NULL row is a blank (default) line.
+ */
+static void
+save_line(const struct ea *row, int ncols)
+{
+    unsigned char **slot = &ea_save[scroll_next];
+
+    if (*slot != zdefaults) {
+	Free(*slot);
+    }
+    if (row == NULL) {
+	*slot = zdefaults;
+    } else {
+	size_t zlen;
+
+	memcpy(row_buf, row, ncols * sizeof(struct ea));
+	if (ncols < maxCOLS) {
+	    memcpy(row_buf + ncols, defaults_buf,
+		    (maxCOLS - ncols) * sizeof(struct ea));
+	}
+	zlen = ea_compress_row(row_buf, maxCOLS, zrow_buf);
+	*slot = (unsigned char *)Malloc(zlen);
+	memcpy(*slot, zrow_buf, zlen);
+    }
+    scroll_next = (scroll_next + 1) % scroll_max;
+    if (n_saved < scroll_max) {
+	n_saved++;
+    }
+}
+
 /*
  * Reset the scrolling parameters and erase the save area.
  */
 static void
 scroll_reset(void)
 {
-    memset(sbuf, 0, sa_bufsize);
+    free_saved();
+    memset(ea_image, 0, maxROWS * maxCOLS * sizeof(struct ea));
     scroll_next = 0;
     n_saved = 0;
     scrolled_back = 0;
@@ -192,32 +252,10 @@ scroll_save(int n)
 
     /* Save the screen contents. */
     for (row = 0; row < n; row++) {
-	if (row < ROWS) {
-	    memmove(ea_save[scroll_next],
-		    ea_buf + (row * COLS),
-		    COLS * sizeof(struct ea));
-	    if (COLS < maxCOLS) {
-		memcpy(ea_save[scroll_next] + COLS, defaults_buf,
-			(maxCOLS - COLS) * sizeof(struct ea));
-	    }
-	} else {
-	    memcpy(ea_save[scroll_next], defaults_buf,
-		    maxCOLS * sizeof(struct ea));
-	}
-	scroll_next = (scroll_next + 1) % scroll_max;
-	if (n_saved < scroll_max) {
-	    n_saved++;
-	}
+	save_line((row < ROWS)? ea_buf + (row * COLS): NULL, COLS);
     }
     if (n == ROWS && n < maxROWS) {
-	for (row = n; row < maxROWS; row++) {
-	    memcpy(ea_save[scroll_next], defaults_buf,
-		    maxCOLS * sizeof(struct ea));
-	}
-	scroll_next = (scroll_next + 1) % scroll_max;
-	if (n_saved < scroll_max) {
-	    n_saved++;
-	}
+	save_line(NULL, COLS);
     }
 
     /*
@@ -229,12 +267,7 @@ scroll_save(int n)
 	int pad;
 
 	for (pad = maxROWS - (scroll_next % maxROWS); pad; pad--) {
-	    memcpy(ea_save[scroll_next], defaults_buf,
-		    maxCOLS * sizeof(struct ea));
-	    scroll_next = (scroll_next + 1) % scroll_max;
-	    if (n_saved < scroll_max) {
-		n_saved++;
-	    }
+	    save_line(NULL, COLS);
 	}
 
     }
@@ -281,7 +314,7 @@ save_image(void)
 #endif /*]*/
 
     for (i = 0; i < maxROWS; i++) {
-	memmove(ea_save[scroll_max + i],
+	memmove(ea_image + (i * maxCOLS),
 		(ea_buf + (i * COLS)), COLS * sizeof(struct ea));
     }
     need_saving = false;
@@ -357,12 +390,16 @@ sync_scroll(int sb)
     /* Update the screen. */
     for (i = 0; i < maxROWS; i++) {
 	if (i < sb) {
-	    memmove((ea_buf + (i * COLS)),
-		    ea_save[(scroll_first + i) % scroll_max],
-		    COLS * sizeof(struct ea));
+	    unsigned char *z = ea_save[(scroll_first + i) % scroll_max];
+
+	    if (z != NULL) {
+		ea_expand_row(z, ea_buf + (i * COLS), COLS);
+	    } else {
+		memset(ea_buf + (i * COLS), 0, COLS * sizeof(struct ea));
+	    }
 	} else {
 	    memmove((ea_buf + (i * COLS)),
-		    ea_save[scroll_max + i - sb],
+		    ea_image + ((i - sb) * maxCOLS),
 		    COLS * sizeof(struct ea));
 	}
     }
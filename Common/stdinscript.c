@@ -198,16 +198,16 @@ stdin_input(iosrc_t fd _is_unused, ioid_t id _is_unused)
 	tv.tv_usec = 0;
 	ns = select(fileno(stdin) + 1, &rfds, NULL, NULL, &tv);
 	if (ns == 0) {
-	    vtrace("s3stdin read blocked\n");
+	    vctrace(TC_SCRIPT, "s3stdin read blocked\n");
 	    return;
 	}
 
 	nr = read(fileno(stdin), &c, 1);
 	if (nr < 0) {
-	    vtrace("s3stdin read error: %s\n", strerror(errno));
+	    vctrace(TC_SCRIPT, "s3stdin read error: %s\n", strerror(errno));
 	    x3270_exit(1);
 	} else if (nr == 0) {
-	    vtrace("s3stdin EOF\n");
+	    vctrace(TC_SCRIPT, "s3stdin EOF\n");
 	    if (stdin_nr == 0) {
 		x3270_exit(0);
 	    } else {
@@ -233,7 +233,7 @@ stdin_input(iosrc_t fd _is_unused, ioid_t id _is_unused)
 	stdin_buf = Malloc(1);
     }
     stdin_buf[stdin_nr] = '\0';
-    vtrace("s3stdin read '%s'\n", stdin_buf);
+    vctrace(TC_SCRIPT, "s3stdin read '%s'\n", stdin_buf);
     if (!json_input(stdin_buf, &need_more)) {
 	json_free(pj_out);
 	push_cb(stdin_buf, strlen(stdin_buf), &stdin_cb, NULL);
@@ -258,15 +258,15 @@ stdin_input(iosrc_t fd _is_unused, ioid_t id _is_unused)
     bool need_more = false;
 
     if (stdin_nr < 0) {
-	vtrace("s3stdin read error: %s\n", strerror(stdin_errno));
+	vctrace(TC_SCRIPT, "s3stdin read error: %s\n", strerror(stdin_errno));
 	x3270_exit(1);
     }
     if (stdin_nr == 0) {
-	vtrace("s3stdin EOF\n");
+	vctrace(TC_SCRIPT, "s3stdin EOF\n");
 	x3270_exit(0);
     }
 
-    vtrace("s3stdin read '%.*s'\n", (int)stdin_nr, stdin_buf);
+    vctrace(TC_SCRIPT, "s3stdin read '%.*s'\n", (int)stdin_nr, stdin_buf);
     if (!json_input(stdin_buf, &need_more)) {
 	if (stdin_nr > 0 && stdin_buf[stdin_nr] == '\n') {
 	    stdin_nr--;
@@ -57,6 +57,7 @@
 #include "bind-opt.h"
 #include "child.h"
 #include "childscript.h"
+#include "codepage.h"
 #include "copyright.h"
 #include "ctlrc.h"
 #include "unicodec.h"
@@ -103,12 +104,30 @@
 #define WRONG_COOKIE_BASE	1000
 #define WRONG_COOKIE_VAR	1000
 
+/* Maximum number of strings in one Wait(StringAt). */
+#define MAX_WAIT_STRINGS	16
+
 /* Globals */
 struct macro_def *macro_defs = NULL;
 char *security_cookie;
 
 /* Statics */
 
+/*
+ * A compiled Wait(StringAt) string. Once it has been compared against the
+ * screen, it is only compared again when one of the rows it spans changes.
+ */
+typedef struct {
+    int baddr;			/* buffer address */
+    char *string;		/* string to match */
+    size_t len;			/* length of string */
+    int rows;			/* rows spanned when last compared, 0 if never */
+    unsigned epoch;		/* screen text cache epoch then */
+    bool start_zero;		/* zero-intensity state at the start of the
+				   first row when last compared */
+    unsigned long generation;	/* ctlr_generation when last compared */
+} match_string_t;
+
 typedef struct task {
     /* Common fields. */
     struct task *next;		/**< next task on the stack */
@@ -158,8 +177,9 @@ typedef struct task {
 
     struct {
 	int baddr;	/* location for wait operations */
-	char *string;	/* string to wait for */
-	bool force_utf8;/* true if string is UTF-8 */
+	match_string_t *strings; /* strings to wait for */
+	int nstrings;	/* number of strings */
+	bool force_utf8;/* true if strings are UTF-8 */
     } match;
 
     /* Expect() fields. */
@@ -308,7 +328,7 @@ static struct {
     { KwUnlock,        0, 0, TS_WAIT_UNLOCK },
     { KwSeconds,       0, 0, TS_TIME_WAIT },
     { KwCursorAt,      1, 2, TS_WAIT_CURSOR_AT },
-    { KwStringAt,      2, 3, TS_WAIT_STRING_AT },
+    { KwStringAt,      2, 3 * MAX_WAIT_STRINGS, TS_WAIT_STRING_AT },
     { KwInputFieldAt,  1, 2, TS_WAIT_IFIELD_AT },
     { NULL, 0, 0 }
 };
@@ -366,7 +386,7 @@ trace_task_output(task_t *s, const char *fmt, ...)
     char *m;
     char c;
 
-    if (!toggled(TRACING)) {
+    if (!trace_on(TC_SCRIPT)) {
 	return;
     }
 
@@ -378,8 +398,8 @@ trace_task_output(task_t *s, const char *fmt, ...)
     st = msgbuf;
     while ((c = *st++)) {
 	if (c == '\n') {
-	    vtrace("Output for " TASK_NAME_FMT ": '%.*s'\n", TASK_sNAME(s),
-		    (int)((st - 1) - m), m);
+	    vctrace(TC_SCRIPT, "Output for " TASK_NAME_FMT ": '%.*s'\n",
+		    TASK_sNAME(s), (int)((st - 1) - m), m);
 	    m = st;
 	    continue;
 	}
@@ -674,7 +694,7 @@ static void
 task_set_state(task_t *s, enum task_state state, const char *why)
 {
     if (s->state != state) {
-	vtrace(TASK_NAME_FMT " %s -> %s (%s)\n", TASK_sNAME(s),
+	vctrace(TC_SCRIPT, TASK_NAME_FMT " %s -> %s (%s)\n", TASK_sNAME(s),
 		task_state_name[s->state],
 		task_state_name[state],
 		why);
@@ -682,21 +702,49 @@ task_set_state(task_t *s, enum task_state state, const char *why)
     }
 }
 
+/**
+ * Free a set of compiled match strings.
+ *
+ * @param[in] strings	strings to free
+ * @param[in] nstrings	number of strings
+ */
+static void
+free_match_strings(match_string_t *strings, int nstrings)
+{
+    int i;
+
+    for (i = 0; i < nstrings; i++) {
+	Free(strings[i].string);
+    }
+    Free(strings);
+}
+
 /**
  * Set match parameters.
  *
  * @param[in] s		task to modify
  * @param[in] baddr	buffer address, or -1
- * @param[in] string	string to match, or NULL
- * @param[in] force_utf8 true if string is encoded in UTF-8
+ * @param[in] strings	compiled strings to match, or NULL; the task takes
+ *  ownership of them
+ * @param[in] nstrings	number of strings
+ * @param[in] force_utf8 true if strings are encoded in UTF-8
  */
 static void
-task_set_match(task_t *s, int baddr, const char *string, bool force_utf8)
+task_set_match(task_t *s, int baddr, match_string_t *strings, int nstrings,
+	bool force_utf8)
 {
-    vtrace(TASK_NAME_FMT " wait @%d%s\n", TASK_sNAME(s),
-	    baddr, (string != NULL)? txAsprintf(" '%s'", string): "");
+    int i;
+
+    vctrace(TC_SCRIPT, TASK_NAME_FMT " wait @%d%s\n", TASK_sNAME(s),
+	    baddr, (nstrings > 0)? txAsprintf(" '%s'", strings[0].string): "");
+    for (i = 1; i < nstrings; i++) {
+	vctrace(TC_SCRIPT, TASK_NAME_FMT " wait @%d '%s'\n", TASK_sNAME(s),
+		strings[i].baddr, strings[i].string);
+    }
+    free_match_strings(s->match.strings, s->match.nstrings);
     s->match.baddr = baddr;
-    s->match.string = NewString(string);
+    s->match.strings = strings;
+    s->match.nstrings = nstrings;
     s->match.force_utf8 = force_utf8;
 }
 
@@ -721,7 +769,8 @@ new_task(enum task_type type, taskq_t *q)
     s->fatal = false;
     s->is_ft = false;
     s->match.baddr = -1;
-    s->match.string = NULL;
+    s->match.strings = NULL;
+    s->match.nstrings = 0;
     s->match.force_utf8 = false;
 
     return s;
@@ -811,7 +860,7 @@ free_task(task_t *t)
 	Replace(t->macro.cmds, NULL);
 	t->macro.cmd_next = NULL;
     }
-    Replace(t->match.string, NULL);
+    free_match_strings(t->match.strings, t->match.nstrings);
     
     /* Free the structure. */
     Free(t);
@@ -825,7 +874,7 @@ task_pop(void)
     unsigned long msec;
     struct timeval t1;
 
-    vtrace(TASK_NAME_FMT " complete, %s\n", TASK_NAME,
+    vctrace(TC_SCRIPT, TASK_NAME_FMT " complete, %s\n", TASK_NAME,
 	    current_task->success? "success": "failure");
 
     /*
@@ -852,7 +901,7 @@ task_pop(void)
 	taskq_t *q = current_task->taskq;
 
 	assert(q != NULL);
-	vtrace("CB(%s)[#%u] complete\n", q->name, q->index);
+	vctrace(TC_SCRIPT, "CB(%s)[#%u] complete\n", q->name, q->index);
 
 	/* Do not delete the taskq yet -- someone might be walking it. */
 	q->top = NULL;
@@ -1338,12 +1387,36 @@ silent_failure:
 #undef fail
 }
 
+/**
+ * Canonicalize an action and its arguments.
+ *
+ * @param[in] entry	Action
+ * @param[in] args	Arguments
+ *
+ * @return Action and arguments as text, which the caller must free
+ */
+static char *
+canonicalize_command(action_elt_t *entry, const char **args)
+{
+    int i;
+    varbuf_t r;
+
+    vb_init(&r);
+    vb_appendf(&r, "%s(", entry->t.name);
+    for (i = 0; args[i] != NULL; i++) {
+	vb_appendf(&r, "%s%s", i? ",": "", qscatv(args[i]));
+    }
+    vb_appends(&r, ")");
+    return vb_consume(&r);
+}
+
 /**
  * Interpret and execute a script or macro command.
  *
  * @param[in] cause	Origin of action
  * @param[in] entry	Action to execute
  * @param[in] args	Arguments
+ * @param[in] canon	Canonicalized action and arguments, or NULL
  * @param[out] last	Returned action and paramters, canonicalized
  * @param[in] last_len	Length of the last
  * @param[in] cbx	Context
@@ -1352,12 +1425,12 @@ silent_failure:
  */
 static bool
 execute_command_backend(enum iaction cause, action_elt_t *entry,
-	const char **args, char *last, size_t last_len, struct task_cbx *cbx)
+	const char **args, const char *canon, char *last, size_t last_len,
+	struct task_cbx *cbx)
 {
     bool stat = true;
     int i;
-    varbuf_t r;
-    char *s;
+    char *s = NULL;
 
     /* Check for restrictions. */
     if (entry->t.ia_restrict != IA_NONE && cause != entry->t.ia_restrict) {
@@ -1377,13 +1450,10 @@ execute_command_backend(enum iaction cause, action_elt_t *entry,
     }
 
     /* Record the action. */
-    vb_init(&r);
-    vb_appendf(&r, "%s(", entry->t.name);
-    for (i = 0; args[i] != NULL; i++) {
-	vb_appendf(&r, "%s%s", i? ",": "", qscatv(args[i]));
+    if (canon == NULL) {
+	canon = s = canonicalize_command(entry, args);
     }
-    vb_appends(&r, ")");
-    strncpy(last, (s = vb_consume(&r)), last_len - 1);
+    strncpy(last, canon, last_len - 1);
     last[last_len - 1] = '\0';
     Free(s);
 
@@ -1430,7 +1500,76 @@ execute_command_split(enum iaction cause, cmd_t *cmd, char *last,
 	Free(error);
 	return false;
     }
-    return execute_command_backend(cause, entry, cmd->args, last, last_len, cbx);
+    return execute_command_backend(cause, entry, cmd->args, NULL, last,
+	    last_len, cbx);
+}
+
+/*
+ * Parsed-command cache.
+ *
+ * Keymap bindings, macros and scripts tend to run the same command strings
+ * over and over. The result of parse_command() is kept in a small
+ * direct-mapped cache keyed by the command text, so a repeated command skips
+ * tokenizing and the action lookup. Entries are invalidated when the action
+ * table changes. An entry in use by a running action is pinned, so a nested
+ * command cannot free the arguments out from under it.
+ */
+#define PCACHE_SIZE	128	/* number of entries, must be a power of 2 */
+#define PCACHE_MAXLEN	256	/* longest command text cached */
+typedef struct {
+    char *command;		/* command text, or NULL if the entry is empty */
+    unsigned hash;		/* hash of the command text */
+    unsigned generation;	/* actions_generation when parsed */
+    action_elt_t *entry;	/* action, or NULL for a comment */
+    char **args;		/* arguments */
+    char *canon;		/* canonicalized action and arguments */
+    size_t next;		/* offset of the next command in the text */
+    unsigned pinned;		/* number of executions in progress */
+} pcache_t;
+static pcache_t pcache[PCACHE_SIZE];
+
+/**
+ * Hash a command string.
+ *
+ * @param[in] s		Command text
+ * @param[out] hashp	Returned hash value
+ *
+ * @return true if the text is short enough to be cached
+ */
+static bool
+pcache_hash(const char *s, unsigned *hashp)
+{
+    unsigned h = 2166136261u;	/* FNV-1a */
+    const char *t;
+
+    for (t = s; *t; t++) {
+	if (t - s >= PCACHE_MAXLEN) {
+	    return false;
+	}
+	h = (h ^ (unsigned char)*t) * 16777619u;
+    }
+    *hashp = h;
+    return true;
+}
+
+/**
+ * Free the contents of a parsed-command cache entry.
+ *
+ * @param[in] pc	Entry to free
+ */
+static void
+pcache_free(pcache_t *pc)
+{
+    int i;
+
+    if (pc->args != NULL) {
+	for (i = 0; pc->args[i] != NULL; i++) {
+	    Free(pc->args[i]);
+	}
+    }
+    Replace(pc->args, NULL);
+    Replace(pc->canon, NULL);
+    Replace(pc->command, NULL);
 }
 
 /**
@@ -1454,6 +1593,32 @@ execute_command(enum iaction cause, const char *s, const char **np, char *last,
     char **args;
     char *error;
     int i;
+    unsigned hash;
+    pcache_t *pc = NULL;
+
+    if (pcache_hash(s, &hash)) {
+	pc = &pcache[hash & (PCACHE_SIZE - 1)];
+    }
+
+    if (pc != NULL &&
+	    pc->command != NULL &&
+	    pc->hash == hash &&
+	    pc->generation == actions_generation &&
+	    !strcmp(pc->command, s)) {
+	/* Cache hit. */
+	if (np != NULL) {
+	    *np = s + pc->next;
+	}
+	if (pc->entry == NULL) {
+	    /* A comment. */
+	    return true;
+	}
+	pc->pinned++;
+	stat = execute_command_backend(cause, pc->entry,
+		(const char **)pc->args, pc->canon, last, last_len, cbx);
+	pc->pinned--;
+	return stat;
+    }
 
     /* Parse the command. */
     stat = parse_command(s, 0, np, &entry, &args, &error);
@@ -1463,14 +1628,34 @@ execute_command(enum iaction cause, const char *s, const char **np, char *last,
 	return stat;
     }
 
+    /* Remember it, unless it is too long or the slot is busy. */
+    if (pc != NULL && !pc->pinned) {
+	pcache_free(pc);
+	pc->command = NewString(s);
+	pc->hash = hash;
+	pc->generation = actions_generation;
+	pc->entry = entry;
+	pc->args = args;
+	pc->next = (np != NULL && *np != NULL)? (size_t)(*np - s): strlen(s);
+	if (entry == NULL) {
+	    return true;
+	}
+	pc->canon = canonicalize_command(entry, (const char **)args);
+	pc->pinned++;
+	stat = execute_command_backend(cause, entry, (const char **)args,
+		pc->canon, last, last_len, cbx);
+	pc->pinned--;
+	return stat;
+    }
+
     if (entry == NULL) {
 	/* A comment. */
 	return true;
     }
 
     /* Run it. */
-    stat = execute_command_backend(cause, entry, (const char **)args, last,
-	    last_len, cbx);
+    stat = execute_command_backend(cause, entry, (const char **)args, NULL,
+	    last, last_len, cbx);
 
     /* Free the arguments. */
     for (i = 0; args[i] != NULL; i++) {
@@ -1550,7 +1735,7 @@ run_macro(void)
     bool es;
     bool fatal = false;
 
-    vtrace(TASK_NAME_FMT " running\n", TASK_NAME);
+    vctrace(TC_SCRIPT, TASK_NAME_FMT " running\n", TASK_NAME);
 
     /*
      * Keep executing commands off the line until one pauses or
@@ -1568,7 +1753,7 @@ run_macro(void)
 	 * Check for command failure.
 	 */
 	if (!s->success) {
-	    vtrace(TASK_NAME_FMT " failed\n", TASK_NAME);
+	    vctrace(TC_SCRIPT, TASK_NAME_FMT " failed\n", TASK_NAME);
 
 	    /* Propagate it. */
 	    if (s->next != NULL) {
@@ -1578,8 +1763,10 @@ run_macro(void)
 	}
 
 	task_set_state(s, TS_RUNNING, "executing");
-	vtrace(TASK_NAME_FMT " '%s'\n", TASK_NAME,
-		scatv((a != NULL)? a: (*s->macro.cmd_next)->action));
+	if (trace_on(TC_SCRIPT)) {
+	    vctrace(TC_SCRIPT, TASK_NAME_FMT " '%s'\n", TASK_NAME,
+		    scatv((a != NULL)? a: (*s->macro.cmd_next)->action));
+	}
 	s->success = true;
 
 	if (s->type == ST_MACRO &&
@@ -1610,7 +1797,7 @@ run_macro(void)
 
 	/* Macro could not execute.  Abort it. */
 	if (!es) {
-	    vtrace(TASK_NAME_FMT " error\n", TASK_NAME);
+	    vctrace(TC_SCRIPT, TASK_NAME_FMT " error\n", TASK_NAME);
 
 	    /* Propagate it. */
 	    s->success = false;
@@ -1632,7 +1819,8 @@ run_macro(void)
 		!(((old_kybdlock ^ kybdlock) & KL_FT) && is_nonblocking_connect(s->next))) {
 	    task_set_state(s, TS_KBWAIT, "keyboard locked");
 	    if ((old_kybdlock ^ kybdlock) & KL_FT) {
-		vtrace(TASK_NAME_FMT " setting is_ft\n", TASK_sNAME(s));
+		vctrace(TC_SCRIPT, TASK_NAME_FMT " setting is_ft\n",
+		    TASK_sNAME(s));
 		s->is_ft = true;
 	    }
 	}
@@ -1760,7 +1948,8 @@ push_cb_backend(const char *buf, size_t len, cmd_t **cmds, const tcb_t *cb,
 	q->output_wait_needed = find_owait(cb);
 	LLIST_APPEND(&q->llist, taskq);
 	name = q->unique_name = Asprintf("CB(%s)[#%u]", q->name, q->index);
-	vtrace("%s started%s\n", name, q->output_wait_needed? " (owait)": "");
+	vctrace(TC_SCRIPT, "%s started%s\n", name,
+	    q->output_wait_needed? " (owait)": "");
     } else {
 	q = current_task->taskq;
     }
@@ -1971,7 +2160,7 @@ task_disconnect_abort(task_t *s)
 {
     task_t *t = s;
 
-    vtrace("Canceling " TASK_NAME_FMT "\n", TASK_sNAME(s));
+    vctrace(TC_SCRIPT, "Canceling " TASK_NAME_FMT "\n", TASK_sNAME(s));
 
     while (t != NULL && t->type != ST_CB) {
 	t = t->next;
@@ -2124,6 +2313,195 @@ task_ft_complete(const char *msg, bool is_error)
     }
 }
 
+/*
+ * Text rendering of the screen buffer, for Ascii(), AsciiField() and
+ * Wait(String).
+ *
+ * Rows of the live screen are rendered once and cached until the row changes
+ * (tracked by ctlr_row_generation) or the zero-intensity state inherited from
+ * an earlier field attribute changes, so repeated dumps of an unchanged
+ * screen are just copies, and a change to one row re-renders only that row.
+ */
+
+/* Cached rendering of one row. */
+typedef struct {
+    unsigned long generation;	/* ctlr_generation when rendered, 0 if never */
+    bool start_zero;		/* in a zero-intensity field at column 0 */
+    bool end_zero;		/* in a zero-intensity field after the last
+				   column */
+    varbuf_t text;		/* rendered text */
+    size_t *offset;		/* offset into text of each column, plus end */
+    int *shown;			/* number of columns before each one that
+				   produced text */
+} row_text_t;
+
+/* Cached rendering of the live screen. */
+typedef struct {
+    int rows, cols;		/* dimensions rendered */
+    bool monocase;		/* monocase mode when rendered */
+    char *codepage;		/* host code page when rendered */
+    unsigned epoch;		/* bumped each time the above change */
+    row_text_t *row;		/* rows */
+} screen_text_t;
+
+/* Screen text caches, indexed by force_utf8. */
+static screen_text_t screen_text[2];
+
+/**
+ * Render one buffer position as text.
+ *
+ * @param[in] buf	display buffer
+ * @param[in] baddr	buffer address
+ * @param[in] next	following buffer position, for DBCS
+ * @param[in,out] is_zero true if in a zero-intensity field
+ * @param[in] force_utf8 true to force UTF-8 encoding
+ * @param[out] r	buffer to append to
+ *
+ * @return false if the position is the right half of a DBCS character and
+ *  nothing was rendered
+ */
+static bool
+render_text(struct ea *buf, int baddr, struct ea *next, bool *is_zero,
+	bool force_utf8, varbuf_t *r)
+{
+    struct ea *ea = &buf[baddr];
+    char mb[16];
+    ucs4_t uc;
+    size_t xlen;
+
+    if (ea->fa) {
+	*is_zero = FA_IS_ZERO(ea->fa);
+	vb_appends(r, " ");
+	return true;
+    }
+    if (*is_zero) {
+	vb_appends(r, " ");
+	return true;
+    }
+    if (IS_RIGHT(ctlr_dbcs_state(baddr))) {
+	return false;
+    }
+    if (is_nvt(ea, false, &uc)) {
+	/* NVT-mode text. */
+	if (uc >= UPRIV2_Aunderbar && uc <= UPRIV2_Zunderbar) {
+	    uc -= UPRIV2;
+	}
+	if (toggled(MONOCASE)) {
+	    uc = u_toupper(uc);
+	}
+	xlen = unicode_to_multibyte_f(uc, mb, sizeof(mb), force_utf8);
+    } else if (IS_LEFT(ctlr_dbcs_state(baddr))) {
+	/* 3270-mode DBCS text. */
+	xlen = ebcdic_to_multibyte_f((ea->ec << 8) | next->ec, mb, sizeof(mb),
+		force_utf8);
+    } else {
+	/* 3270-mode text. */
+	xlen = ebcdic_to_multibyte_fx(ea->ec, ea->cs, mb, sizeof(mb),
+		EUO_BLANK_UNDEF | (toggled(MONOCASE)? EUO_TOUPPER: 0),
+		&uc, force_utf8);
+    }
+    if (xlen > 1) {
+	vb_append(r, mb, xlen - 1);
+    }
+    return true;
+}
+
+/**
+ * Get the text cache for the live screen, discarding its contents if the
+ * screen geometry or the settings that affect rendering have changed.
+ * Moving ea_buf (scrolling or switching to the alternate buffer) marks
+ * every row changed, so the rows are simply re-rendered in place.
+ *
+ * @param[in] force_utf8 true to force UTF-8 encoding
+ *
+ * @return Cache
+ */
+static screen_text_t *
+screen_text_get(bool force_utf8)
+{
+    screen_text_t *st = &screen_text[force_utf8];
+    const char *codepage = get_canonical_codepage();
+    int i;
+
+    if (st->rows == ROWS &&
+	    st->cols == COLS &&
+	    st->monocase == toggled(MONOCASE) &&
+	    st->codepage != NULL &&
+	    !strcmp(st->codepage, codepage)) {
+	return st;
+    }
+
+    for (i = 0; i < st->rows; i++) {
+	vb_free(&st->row[i].text);
+	Free(st->row[i].offset);
+	Free(st->row[i].shown);
+    }
+    Free(st->row);
+    st->epoch++;
+    st->rows = ROWS;
+    st->cols = COLS;
+    st->monocase = toggled(MONOCASE);
+    Replace(st->codepage, NewString(codepage));
+    st->row = (row_text_t *)Calloc(ROWS, sizeof(row_text_t));
+    for (i = 0; i < ROWS; i++) {
+	vb_init(&st->row[i].text);
+	st->row[i].offset = (size_t *)Malloc((COLS + 1) * sizeof(size_t));
+	st->row[i].shown = (int *)Malloc((COLS + 1) * sizeof(int));
+    }
+    return st;
+}
+
+/**
+ * Get the rendering of one row of the live screen, rendering it if the
+ * row has changed since it was last rendered.
+ *
+ * @param[in] st	cache
+ * @param[in] row	row number
+ * @param[in] force_utf8 true to force UTF-8 encoding
+ * @param[in,out] zero	zero-intensity state at the start of the row, or -1
+ *  if not known; returned as the state at the start of the next row
+ *
+ * @return Rendered row
+ */
+static row_text_t *
+screen_text_row(screen_text_t *st, int row, bool force_utf8, int *zero)
+{
+    row_text_t *rt = &st->row[row];
+    int first = row * COLS;
+    bool is_zero;
+    int shown = 0;
+    int col;
+
+    if (*zero < 0) {
+	*zero = FA_IS_ZERO(get_field_attribute(first));
+    }
+    if (rt->generation != 0 &&
+	    ctlr_row_generation[row] <= rt->generation &&
+	    rt->start_zero == (bool)*zero) {
+	*zero = rt->end_zero;
+	return rt;
+    }
+
+    vb_reset(&rt->text);
+    vb_append(&rt->text, "", 0);
+    is_zero = rt->start_zero = (bool)*zero;
+    for (col = 0; col < COLS; col++) {
+	rt->offset[col] = vb_len(&rt->text);
+	rt->shown[col] = shown;
+	if (render_text(ea_buf, first + col,
+		    &ea_buf[(first + col + 1) % (ROWS * COLS)], &is_zero,
+		    force_utf8, &rt->text)) {
+	    shown++;
+	}
+    }
+    rt->offset[COLS] = vb_len(&rt->text);
+    rt->shown[COLS] = shown;
+    rt->end_zero = is_zero;
+    *zero = is_zero;
+    rt->generation = ctlr_generation;
+    return rt;
+}
+
 /**
  * Grabs a string from an offset on the screen.
  * Returns the string.
@@ -2137,67 +2515,51 @@ task_ft_complete(const char *msg, bool is_error)
  * @param[in] len	length of match string
  * @param[in] buf	display buffer
  * @param[in] force_utf8 true to force string to UTF-8 encoding
+ * @param[out] rows	if not NULL, returned number of rows spanned
  */
 static char *
-grab_string(int baddr, size_t len, struct ea *buf, bool force_utf8)
+grab_string(int baddr, size_t len, struct ea *buf, bool force_utf8,
+	int *rows)
 {
     int i;
     bool is_zero = false;
     varbuf_t r;
     char *ret;
+    int nrows = 0;
 
     vb_init(&r);
 
-    is_zero = FA_IS_ZERO(get_field_attribute(baddr));
-
-    for (i = 0; vb_len(&r) < len; i++) {
-	char mb[16];
-	ucs4_t uc;
-	size_t j;
-	size_t xlen;
-	struct ea *ea = &buf[(baddr + i) % (ROWS * COLS)];
-
-	if (ea->fa) {
-	    is_zero = FA_IS_ZERO(ea->fa);
-	    vb_appends(&r, " ");
-	} else if (is_zero) {
-	    vb_appends(&r, " ");
-	} else if (IS_RIGHT(ctlr_dbcs_state(baddr + i))) {
-	    continue;
-	} else {
-	    if (is_nvt(ea, false, &uc)) {
-		/* NVT-mode text. */
-		if (uc >= UPRIV2_Aunderbar && uc <= UPRIV2_Zunderbar) {
-		    uc -= UPRIV2;
-		}
-		if (toggled(MONOCASE)) {
-		    uc = u_toupper(uc);
-		}
-		xlen = unicode_to_multibyte_f(uc, mb, sizeof(mb), force_utf8);
-		for (j = 0; j < xlen - 1; j++) {
-		    vb_appendf(&r, "%c", mb[j]);
-		}
-	    } else {
-		/* 3270-mode text. */
-		if (IS_LEFT(ctlr_dbcs_state(baddr + i))) {
-		    xlen = ebcdic_to_multibyte_f((ea->ec << 8) |
-			    buf[(baddr + i + 1) % (ROWS * COLS)].ec,
-			    mb, sizeof(mb), force_utf8);
-		    for (j = 0; j < xlen - 1; j++) {
-			vb_appendf(&r, "%c", mb[j]);
-		    }
-		} else {
-		    xlen = ebcdic_to_multibyte_fx(ea->ec, ea->cs, mb,
-			    sizeof(mb),
-			    EUO_BLANK_UNDEF |
-			     (toggled(MONOCASE)? EUO_TOUPPER: 0),
-			    &uc, force_utf8);
-		    for (j = 0; j < xlen - 1; j++) {
-			vb_appendf(&r, "%c", mb[j]);
-		    }
-		}
+    if (buf == ea_buf) {
+	screen_text_t *st = screen_text_get(force_utf8);
+	int zero = -1;
+
+	/* Copy whole positions from the cached rows until there is enough. */
+	while (vb_len(&r) < len) {
+	    row_text_t *rt = screen_text_row(st, baddr / COLS, force_utf8,
+		    &zero);
+	    int col = baddr % COLS;
+	    int end = col;
+
+	    while (end < COLS &&
+		    rt->offset[end] - rt->offset[col] < len - vb_len(&r)) {
+		end++;
 	    }
+	    vb_append(&r, vb_buf(&rt->text) + rt->offset[col],
+		    rt->offset[end] - rt->offset[col]);
+	    baddr = (baddr + (end - col)) % (ROWS * COLS);
+	    nrows++;
+	}
+    } else {
+	is_zero = FA_IS_ZERO(get_field_attribute(baddr));
+	for (i = 0; vb_len(&r) < len; i++) {
+	    render_text(buf, (baddr + i) % (ROWS * COLS),
+		    &buf[(baddr + i + 1) % (ROWS * COLS)], &is_zero,
+		    force_utf8, &r);
 	}
+	nrows = ((baddr % COLS) + i + COLS - 1) / COLS;
+    }
+    if (rows != NULL) {
+	*rows = nrows;
     }
 
     ret = NewString(vb_buf(&r));
@@ -2208,6 +2570,63 @@ grab_string(int baddr, size_t len, struct ea *buf, bool force_utf8)
     return ret;
 }
 
+/**
+ * Compare compiled Wait(StringAt) strings against the live screen. A string
+ * that did not match is compared again only if one of the rows it spanned has
+ * changed since, or the zero-intensity state at the start of its first row
+ * has changed.
+ *
+ * @param[in,out] strings strings to compare
+ * @param[in] nstrings	number of strings
+ * @param[in] force_utf8 true if strings are encoded in UTF-8
+ *
+ * @return Index of the first string that matches, or -1
+ */
+static int
+match_strings(match_string_t *strings, int nstrings, bool force_utf8)
+{
+    screen_text_t *st = screen_text_get(force_utf8);
+    int i;
+
+    for (i = 0; i < nstrings; i++) {
+	match_string_t *m = &strings[i];
+	int row, j;
+	bool start_zero;
+	char *current_string;
+	bool matched;
+
+	if (m->baddr >= ROWS * COLS) {
+	    continue;
+	}
+	row = m->baddr / COLS;
+	start_zero = FA_IS_ZERO(get_field_attribute(row * COLS));
+	if (m->rows > 0 && m->epoch == st->epoch &&
+		m->start_zero == start_zero) {
+	    for (j = 0; j < m->rows && j < ROWS; j++) {
+		if (ctlr_row_generation[(row + j) % ROWS] > m->generation) {
+		    break;
+		}
+	    }
+	    if (j == m->rows || j == ROWS) {
+		/* Nothing it covers has changed. */
+		continue;
+	    }
+	}
+
+	current_string = grab_string(m->baddr, m->len, ea_buf, force_utf8,
+		&m->rows);
+	matched = !strcmp(current_string, m->string);
+	Free(current_string);
+	m->epoch = st->epoch;
+	m->start_zero = start_zero;
+	m->generation = ctlr_generation;
+	if (matched) {
+	    return i;
+	}
+    }
+    return -1;
+}
+
 /**
  * Run one task queue.
  *
@@ -2217,6 +2636,7 @@ static bool
 run_taskq(void)
 {
     bool any = false;
+    int matched;
 
     while (true) {
 	bool need_run = false;
@@ -2241,7 +2661,8 @@ run_taskq(void)
 		return any;
 	    } else {
 		if (current_task->is_ft) {
-		    vtrace(TASK_NAME_FMT " clearing is_ft\n", TASK_NAME);
+		    vctrace(TC_SCRIPT, TASK_NAME_FMT " clearing is_ft\n",
+			TASK_NAME);
 		}
 		current_task->is_ft = false;
 	    }
@@ -2356,17 +2777,14 @@ run_taskq(void)
 		any = true;
 		break;
 	    }
-	    if (current_task->match.baddr < ROWS * COLS) {
-		char *current_string = grab_string(current_task->match.baddr,
-			strlen(current_task->match.string), ea_buf,
-			current_task->match.force_utf8);
-
-		if (!strcmp(current_string, current_task->match.string)) {
-		    Free(current_string);
-		    any = true;
-		    break;
+	    if ((matched = match_strings(current_task->match.strings,
+			    current_task->match.nstrings,
+			    current_task->match.force_utf8)) >= 0) {
+		if (current_task->match.nstrings > 1) {
+		    action_output("%d", matched + 1);
 		}
-		Free(current_string);
+		any = true;
+		break;
 	    }
 	    return any;
 	case TS_WAIT_IFIELD_AT:
@@ -2493,6 +2911,36 @@ set_output_needed(bool needed)
  * Macro- and script-specific actions.
  */
 
+/*
+ * Dump a range of live screen locations as text, from the cache.
+ * Returns true if anything was dumped.
+ */
+static bool
+dump_range_cached(int first, int len, bool force_utf8)
+{
+    screen_text_t *st = screen_text_get(force_utf8);
+    bool any = false;
+    int zero = -1;
+
+    while (len > 0) {
+	row_text_t *rt = screen_text_row(st, first / COLS, force_utf8, &zero);
+	int col = first % COLS;
+	int n = COLS - col;
+
+	if (n > len) {
+	    n = len;
+	}
+	any = rt->shown[col + n] > rt->shown[col];
+	if (any || n < len) {
+	    action_output("%.*s", (int)(rt->offset[col + n] - rt->offset[col]),
+		    vb_buf(&rt->text) + rt->offset[col]);
+	}
+	first = (first + n) % (ROWS * COLS);
+	len -= n;
+    }
+    return any;
+}
+
 /*
  * Dump a range of screen locations.
  * Returns true if anything was dumped.
@@ -2506,8 +2954,6 @@ dump_range(int first, int len, bool in_ascii, struct ea *buf,
     bool is_zero = false;
     varbuf_t r;
 
-    vb_init(&r);
-
     /*
      * If the client has looked at the live screen, then if they later
      * execute 'Wait(output)', they will need to wait for output from the
@@ -2525,6 +2971,11 @@ dump_range(int first, int len, bool in_ascii, struct ea *buf,
 	set_output_needed(true);
     }
 
+    if (in_ascii && buf == ea_buf) {
+	return dump_range_cached(first, len, force_utf8);
+    }
+
+    vb_init(&r);
     is_zero = FA_IS_ZERO(get_field_attribute(first));
 
     for (i = 0; i < len; i++) {
@@ -2534,52 +2985,9 @@ dump_range(int first, int len, bool in_ascii, struct ea *buf,
 	    any = false;
 	}
 	if (in_ascii) {
-	    char mb[16];
-	    ucs4_t uc;
-	    size_t j;
-	    size_t xlen;
-
-	    if (buf[first + i].fa) {
-		is_zero = FA_IS_ZERO(buf[first + i].fa);
-		vb_appends(&r, " ");
-	    } else if (is_zero) {
-		vb_appends(&r, " ");
-	    } else if (IS_RIGHT(ctlr_dbcs_state(first + i))) {
+	    if (!render_text(buf, first + i, &buf[first + i + 1], &is_zero,
+			force_utf8, &r)) {
 		continue;
-	    } else {
-		if (is_nvt(&buf[first + i], false, &uc)) {
-		    /* NVT-mode text. */
-		    if (uc >= UPRIV2_Aunderbar && uc <= UPRIV2_Zunderbar) {
-			uc -= UPRIV2;
-		    }
-		    if (toggled(MONOCASE)) {
-			uc = u_toupper(uc);
-		    }
-		    xlen = unicode_to_multibyte_f(uc, mb, sizeof(mb),
-			    force_utf8);
-		    for (j = 0; j < xlen - 1; j++) {
-			vb_appendf(&r, "%c", mb[j]);
-		    }
-		} else {
-		    /* 3270-mode text. */
-		    if (IS_LEFT(ctlr_dbcs_state(first + i))) {
-			xlen = ebcdic_to_multibyte_f((buf[first + i].ec << 8) |
-				buf[first + i + 1].ec,
-				mb, sizeof(mb), force_utf8);
-			for (j = 0; j < xlen - 1; j++) {
-			    vb_appendf(&r, "%c", mb[j]);
-			}
-		    } else {
-			xlen = ebcdic_to_multibyte_fx(buf[first + i].ec,
-				buf[first + i].cs, mb, sizeof(mb),
-				EUO_BLANK_UNDEF |
-				 (toggled(MONOCASE)? EUO_TOUPPER: 0),
-				&uc, force_utf8);
-			for (j = 0; j < xlen - 1; j++) {
-			    vb_appendf(&r, "%c", mb[j]);
-			}
-		    }
-		}
 	    }
 	} else {
 	    ebc_t ebc = 0;
@@ -2786,6 +3194,63 @@ calc_cs(unsigned char cs)
     }
 }
 
+/* Cached ReadBuffer() output for the live screen. */
+typedef struct {
+    unsigned long generation;	/* ctlr_generation when rendered, 0 if never */
+    int rows, cols;		/* dimensions rendered */
+    bool force_utf8;		/* UTF-8 forced when rendered */
+    char *codepage;		/* host code page when rendered */
+    char **line;		/* rendered lines */
+} rb_cache_t;
+
+/* ReadBuffer() caches, indexed by mode. */
+static rb_cache_t rb_cache[3];
+
+/*
+ * Check a ReadBuffer() cache for validity.
+ */
+static bool
+rb_cache_valid(rb_cache_t *rbc, bool force_utf8)
+{
+    return rbc->generation == ctlr_generation &&
+	rbc->rows == ROWS &&
+	rbc->cols == COLS &&
+	rbc->force_utf8 == force_utf8 &&
+	!strcmp(rbc->codepage, get_canonical_codepage());
+}
+
+/*
+ * Empty a ReadBuffer() cache, in preparation for filling it.
+ */
+static void
+rb_cache_reset(rb_cache_t *rbc, bool force_utf8)
+{
+    int i;
+
+    for (i = 0; i < rbc->rows; i++) {
+	Free(rbc->line[i]);
+    }
+    Free(rbc->line);
+    rbc->generation = 0;
+    rbc->rows = ROWS;
+    rbc->cols = COLS;
+    rbc->force_utf8 = force_utf8;
+    Replace(rbc->codepage, NewString(get_canonical_codepage()));
+    rbc->line = (char **)Calloc(ROWS, sizeof(char *));
+}
+
+/*
+ * Output one line of ReadBuffer() output, saving it in the cache.
+ */
+static void
+rb_output(rb_cache_t *rbc, int row, const char *s)
+{
+    action_output("%s", s);
+    if (rbc != NULL) {
+	Replace(rbc->line[row], NewString(s));
+    }
+}
+
 /*
  * Internals of the ReadBuffer action.
  * Operates on the supplied 'buf' parameter, which might be the live
@@ -2806,6 +3271,7 @@ do_read_buffer(const char **params, unsigned num_params, struct ea *buf,
     bool field = false;
     int field_baddr = 0;
     bool any = false;
+    rb_cache_t *rbc = NULL;
 
     if (num_params > 0) {
 	unsigned i;
@@ -2842,6 +3308,19 @@ do_read_buffer(const char **params, unsigned num_params, struct ea *buf,
 	set_output_needed(true);
     }
 
+    if (!field && buf == ea_buf) {
+	rbc = &rb_cache[mode];
+	if (rb_cache_valid(rbc, force_utf8)) {
+	    int row;
+
+	    for (row = 0; row < ROWS; row++) {
+		action_output("%s", rbc->line[row]);
+	    }
+	    return true;
+	}
+	rb_cache_reset(rbc, force_utf8);
+    }
+
     if (field) {
 	if (!formatted) {
 	    popup_an_error(AnReadBuffer "(): no field");
@@ -2863,7 +3342,7 @@ do_read_buffer(const char **params, unsigned num_params, struct ea *buf,
     for (;;) {
 	if (!field && !(baddr % COLS)) {
 	    if (baddr) {
-		action_output("%s", vb_buf(&r) + 1);
+		rb_output(rbc, (baddr / COLS) - 1, vb_buf(&r) + 1);
 	    }
 	    vb_reset(&r);
 	}
@@ -3051,7 +3530,14 @@ do_read_buffer(const char **params, unsigned num_params, struct ea *buf,
 	}
 	any = true;
     }
-    action_output("%s%s", field? "Contents: ": "", vb_buf(&r) + 1);
+    if (field) {
+	action_output("Contents: %s", vb_buf(&r) + 1);
+    } else {
+	rb_output(rbc, ROWS - 1, vb_buf(&r) + 1);
+	if (rbc != NULL) {
+	    rbc->generation = ctlr_generation;
+	}
+    }
     vb_free(&r);
     return true;
 }
@@ -3160,10 +3646,10 @@ call_run(task_t *s)
 {
     bool success;
 
-    vtrace("Running " TASK_NAME_FMT "\n", TASK_NAME);
+    vctrace(TC_SCRIPT, "Running " TASK_NAME_FMT "\n", TASK_NAME);
     if ((*current_task->cbx.cb->run)(current_task->cbx.handle, &success)) {
 	/* CB is complete. */
-	vtrace(TASK_NAME_FMT " is complete, %s\n", TASK_NAME,
+	vctrace(TC_SCRIPT, TASK_NAME_FMT " is complete, %s\n", TASK_NAME,
 		success? "success": "failure");
 	current_task->success = success;
 	if (current_task->next) {
@@ -3185,7 +3671,7 @@ task_done(bool success)
 
     assert(current_task->type == ST_CB);
 
-    vtrace(TASK_NAME_FMT " child task done, %s\n", TASK_NAME,
+    vctrace(TC_SCRIPT, TASK_NAME_FMT " child task done, %s\n", TASK_NAME,
 	    success? "success": "failure");
 
     /* Tell the callback its child is done. */
@@ -3538,7 +4024,8 @@ Wait_action(ia_t ia _is_unused, unsigned argc, const char **argv)
     const char **pr;
     int i;
     int match_baddr = -1;
-    const char *match_string = NULL;
+    match_string_t *match_strings_c = NULL;
+    int nmatch = 0;
     char *next_why;
 #define CONNECTED_CHECK do { \
     if (next_state != TS_TIME_WAIT && !(CONNECTED || HALF_CONNECTED)) { \
@@ -3636,21 +4123,38 @@ Wait_action(ia_t ia _is_unused, unsigned argc, const char **argv)
 	}
 	break;
     case TS_WAIT_STRING_AT:
-	CONNECTED_CHECK;
-	if (!parse_rco(AnWait, KwStringAt, np - 2, pr + 1, &match_baddr)) {
+	/*
+	 * One string is [row, col,] or offset, string. More than one is a
+	 * list of row, col, string triples.
+	 */
+	if (np - 1 > 3 && (np - 1) % 3 != 0) {
+	    popup_an_error(AnWait "(%s) requires row, column, string triples",
+		    KwStringAt);
 	    return false;
 	}
 	CONNECTED_CHECK;
-	match_string = pr[np - 1];
-	if (match_baddr < ROWS * COLS) {
-	    char *current_string = grab_string(match_baddr,
-		    strlen(match_string), ea_buf, ia == IA_HTTPD);
-
-	    if (!strcmp(current_string, match_string)) {
-		Free(current_string);
-		return true;
+	nmatch = (np - 1 > 3)? (np - 1) / 3: 1;
+	match_strings_c = (match_string_t *)Calloc(nmatch,
+		sizeof(match_string_t));
+	for (i = 0; i < nmatch; i++) {
+	    const char **triple = (nmatch > 1)? pr + 1 + (i * 3): pr + 1;
+
+	    if (!parse_rco(AnWait, KwStringAt, (nmatch > 1)? 2: np - 2,
+			triple, &match_strings_c[i].baddr)) {
+		free_match_strings(match_strings_c, i);
+		return false;
 	    }
-	    Free(current_string);
+	    match_strings_c[i].string = NewString((nmatch > 1)? triple[2]:
+		    pr[np - 1]);
+	    match_strings_c[i].len = strlen(match_strings_c[i].string);
+	}
+	match_baddr = match_strings_c[0].baddr;
+	if ((i = match_strings(match_strings_c, nmatch, ia == IA_HTTPD)) >= 0) {
+	    if (nmatch > 1) {
+		action_output("%d", i + 1);
+	    }
+	    free_match_strings(match_strings_c, nmatch);
+	    return true;
 	}
 	break;
     case TS_WAIT_IFIELD_AT:
@@ -3676,7 +4180,7 @@ Wait_action(ia_t ia _is_unused, unsigned argc, const char **argv)
 	    find_wait_kw(next_state));
     task_set_state(current_task, next_state, next_why);
     if (match_baddr >= 0) {
-	task_set_match(current_task, match_baddr, match_string,
+	task_set_match(current_task, match_baddr, match_strings_c, nmatch,
 		ia == IA_HTTPD);
     }
 
@@ -3716,7 +4220,7 @@ pause_timed_out(ioid_t id)
     } FOREACH_LLIST_END(&taskq, q, taskq_t *);
 
     if (!found) {
-	vtrace("pause_timed_out: no match\n");
+	vctrace(TC_SCRIPT, "pause_timed_out: no match\n");
 	return;
     }
 
@@ -4075,7 +4579,7 @@ expect_timed_out(ioid_t id)
     } FOREACH_LLIST_END(&taskq, q, taskq_t *);
 
     if (!found) {
-	vtrace("expect_timed_out: no match\n");
+	vctrace(TC_SCRIPT, "expect_timed_out: no match\n");
 	return;
     }
 
@@ -4114,7 +4618,7 @@ wait_timed_out(ioid_t id)
     } FOREACH_LLIST_END(&taskq, q, taskq_t *);
 
     if (!found) {
-	vtrace("wait_timed_out: no match\n");
+	vctrace(TC_SCRIPT, "wait_timed_out: no match\n");
 	return;
     }
 
@@ -4255,19 +4759,19 @@ abortq(taskq_t *q)
 
 	/* Don't abort a peer script. */
 	if (s->type == ST_CB && (s->cbx.cb->flags & CB_PEER)) {
-	    vtrace("Abort skipping peer\n");
+	    vctrace(TC_SCRIPT, "Abort skipping peer\n");
 	    continue;
 	}
 
 	/* Abort the cb. */
 	if (s->type == ST_CB) {
-	    vtrace("Canceling " TASK_NAME_FMT "\n", TASK_sNAME(s));
+	    vctrace(TC_SCRIPT, "Canceling " TASK_NAME_FMT "\n", TASK_sNAME(s));
 	    task_result(s, "Canceled", false);
 	    (*s->cbx.cb->done)(s->cbx.handle, true, true);
 	}
 
 	/* Free the task -- this is not a pop */
-	vtrace("Freeing " TASK_NAME_FMT "\n", TASK_sNAME(s));
+	vctrace(TC_SCRIPT, "Freeing " TASK_NAME_FMT "\n", TASK_sNAME(s));
 	free_task(s);
 
 	/* Take it out of the taskq. */
@@ -4293,7 +4797,7 @@ abort_script_by_cb(const char *cb_name)
     /* child_ignore_output(); */ /* Needed? */
 #endif /*]*/
 
-    vtrace("Canceling all pending scripts for %s\n", cb_name);
+    vctrace(TC_SCRIPT, "Canceling all pending scripts for %s\n", cb_name);
 
     FOREACH_LLIST(&taskq, q, taskq_t *) {
 	if (!strcmp(cb_name, q->cb->shortname)) {
@@ -4318,7 +4822,7 @@ abort_queue(const char *unique_name)
     /* child_ignore_output(); */ /* Needed? */
 #endif /*]*/
 
-    vtrace("Canceling all pending scripts for %s\n", unique_name);
+    vctrace(TC_SCRIPT, "Canceling all pending scripts for %s\n", unique_name);
 
     FOREACH_LLIST(&taskq, q, taskq_t *) {
 	if (!strcmp(unique_name, q->unique_name)) {
@@ -4341,7 +4845,7 @@ abort_script(void)
     child_ignore_output();
 #endif /*]*/
 
-    vtrace("Canceling all pending scripts\n");
+    vctrace(TC_SCRIPT, "Canceling all pending scripts\n");
 
     /*
      * - Call the kill callbacks for every cb.
@@ -4357,19 +4861,20 @@ abort_script(void)
 
 	    /* Don't abort a peer script. */
 	    if (s->type == ST_CB && (s->cbx.cb->flags & CB_PEER)) {
-		vtrace("Abort skipping peer\n");
+		vctrace(TC_SCRIPT, "Abort skipping peer\n");
 		continue;
 	    }
 
 	    /* Abort the cb. */
 	    if (s->type == ST_CB) {
-		vtrace("Canceling " TASK_NAME_FMT "\n", TASK_sNAME(s));
+		vctrace(TC_SCRIPT, "Canceling " TASK_NAME_FMT "\n",
+		    TASK_sNAME(s));
 		task_result(s, "Canceled", false);
 		(*s->cbx.cb->done)(s->cbx.handle, true, true);
 	    }
 
 	    /* Free the task -- this is not a pop */
-	    vtrace("Freeing " TASK_NAME_FMT "\n", TASK_sNAME(s));
+	    vctrace(TC_SCRIPT, "Freeing " TASK_NAME_FMT "\n", TASK_sNAME(s));
 	    free_task(s);
 
 	    /* Take it out of the taskq. */
@@ -4550,7 +5055,7 @@ wrong_cookie_timeout(ioid_t id)
     } FOREACH_LLIST_END(&taskq, q, taskq_t *);
 
     if (!found) {
-	vtrace("cookie_timed_out: no match\n");
+	vctrace(TC_SCRIPT, "cookie_timed_out: no match\n");
 	return;
     }
 
@@ -4849,7 +5354,7 @@ sample_continue_input(void *handle, const char *text)
 {
     sample_per_type_t *state = (sample_per_type_t *)handle;
 
-    vtrace("Continuing RequestInput\n");
+    vctrace(TC_SCRIPT, "Continuing RequestInput\n");
     action_output("You said '%s'", text);
 
     /* Remember for next time. */
@@ -4867,7 +5372,7 @@ sample_abort_input(void *handle)
 {
     sample_per_type_t *state = (sample_per_type_t *)handle;
 
-    vtrace("Canceling RequestInput\n");
+    vctrace(TC_SCRIPT, "Canceling RequestInput\n");
     if (state != NULL) {
 	Replace(state->previous, NewString("[canceled]"));
     }
@@ -4879,7 +5384,7 @@ sample_abort_session(void *handle)
 {
     sample_per_type_t *state = (sample_per_type_t *)handle;
 
-    vtrace("Canceling input request session\n");
+    vctrace(TC_SCRIPT, "Canceling input request session\n");
     if (state != NULL) {
 	Replace(state->previous, NULL);
 	Free(state);
@@ -224,6 +224,7 @@ static ntim_t ntim = NTIM_UNKNOWN;
 static ntim_t parse_ntim(const char *value);
 
 static bool telnet_fsm(unsigned char c);
+static size_t telnet_nvt_run(const unsigned char *buf, size_t len);
 static void net_rawout(unsigned const char *buf, size_t len);
 static void check_in3270(void);
 static void store3270in(unsigned char c);
@@ -934,7 +935,7 @@ send_nop(ioid_t id _is_unused)
 
     if (cstate >= TELNET_PENDING) {
 	net_rawout(nop, sizeof(nop));
-	vtrace("SENT NOP\n");
+	vctrace(TC_TELNET, "SENT NOP\n");
     }
     nop_timeout_id = AddTimeOut(appres.nop_seconds * 1000, send_nop);
 }
@@ -1497,11 +1498,13 @@ net_input(iosrc_t fd _is_unused, ioid_t id _is_unused)
 	} else if (socket_errno() != SE_ECONNRESET) {
 	    popup_a_sockerr("Socket read");
 	}
+	trace_flight_dump("socket error");
 	host_disconnect(true);
 	return;
     } else if (nr == 0) {
 	/* Host disconnected. */
 	vtrace("RCVD disconnect\n");
+	trace_flight_dump("host disconnected");
 	host_disconnect(false);
 	return;
     }
@@ -1533,8 +1536,15 @@ net_input(iosrc_t fd _is_unused, ioid_t id _is_unused)
 	    nvt_process((unsigned int) *cp);
 	} else {
 #endif /*]*/
+	    size_t run = telnet_nvt_run(cp, (netrbuf + nr) - cp);
+
+	    if (run > 0) {
+		cp += run - 1;
+		continue;
+	    }
 	    if (!telnet_fsm(*cp)) {
 		ctlr_dbcs_postprocess();
+		trace_flight_dump("TELNET protocol error");
 		host_disconnect(true);
 		return;
 	    }
@@ -1551,6 +1561,7 @@ net_input(iosrc_t fd _is_unused, ioid_t id _is_unused)
 #if defined(_WIN32) /*[*/
     if (events.lNetworkEvents & FD_CLOSE) {
 	vtrace("RCVD disconnect\n");
+	trace_flight_dump("host disconnected");
 	host_disconnect(false);
     }
 #endif /*]*/
@@ -1599,7 +1610,8 @@ send_naws(void)
     sprintf(naws_msg + naws_len, "%c%c", IAC, SE);
     naws_len += 2;
     net_rawout((unsigned char *)naws_msg, naws_len);
-    vtrace("SENT %s NAWS %d %d %s\n", cmd(SB), XMIT_COLS, XMIT_ROWS, cmd(SE));
+    vctrace(TC_TELNET, "SENT %s NAWS %d %d %s\n", cmd(SB), XMIT_COLS,
+	    XMIT_ROWS, cmd(SE));
 }
 
 
@@ -1669,6 +1681,68 @@ force_local(char *s)
 #define force_local(s)
 #endif /*]*/
 
+/*
+ * Trace a byte of NVT data.
+ */
+static void
+trace_nvt_data(unsigned char c)
+{
+    const char *see_chr;
+    const char *space;
+    size_t sl;
+
+    if (!nvt_data) {
+	ntvtrace("<.. ");
+	nvt_data = 4;
+	nvt_any = false;
+	nvt_last_cmd = false;
+    }
+    see_chr = ctl_see((int) c);
+    sl = strlen(see_chr);
+    if (sl > 1) {
+	space = nvt_any? " ": "";
+    } else {
+	space = nvt_last_cmd? " ": "";
+    }
+    nvt_data += strlen(space) + sl;
+    if (nvt_data >= TRACELINE) {
+	ntvtrace(" ...\n... ");
+	nvt_data = 4 + sl;
+    }
+    ntvtrace("%s%s", space, see_chr);
+    nvt_last_cmd = sl > 1;
+    nvt_any = true;
+}
+
+/*
+ * Pass a run of printable NVT data to the NVT emulator in one step, as
+ * telnet_fsm() would a byte at a time.
+ *
+ * Returns the number of bytes consumed, or 0 if the first byte needs to go
+ * through telnet_fsm().
+ */
+static size_t
+telnet_nvt_run(const unsigned char *buf, size_t len)
+{
+    size_t n;
+    size_t i;
+
+    if (telnet_state != TNS_DATA || cstate == TELNET_PENDING || !IN_NVT ||
+	    IN_E || syncing) {
+	return 0;
+    }
+    for (n = 0; n < len && buf[n] >= ' ' && buf[n] < 0x7f; n++) {
+    }
+    if (n < 2) {
+	return 0;
+    }
+    for (i = 0; i < n; i++) {
+	trace_nvt_data(buf[i]);
+    }
+    nvt_process_run(buf, n);
+    return n;
+}
+
 /*
  * telnet_fsm
  *	Telnet finite-state machine.
@@ -1699,29 +1773,7 @@ telnet_fsm(unsigned char c)
 	    ps_process();
 	}
 	if (IN_NVT && !IN_E) {
-	    const char *space;
-
-	    if (!nvt_data) {
-		ntvtrace("<.. ");
-		nvt_data = 4;
-		nvt_any = false;
-		nvt_last_cmd = false;
-	    }
-	    see_chr = ctl_see((int) c);
-	    sl = strlen(see_chr);
-	    if (sl > 1) {
-		space = nvt_any? " ": "";
-	    } else {
-		space = nvt_last_cmd? " ": "";
-	    }
-	    nvt_data += strlen(space) + sl;
-	    if (nvt_data >= TRACELINE) {
-		ntvtrace(" ...\n... ");
-		nvt_data = 4 + sl;
-	    }
-	    ntvtrace("%s%s", space, see_chr);
-	    nvt_last_cmd = sl > 1;
-	    nvt_any = true;
+	    trace_nvt_data(c);
 	    if (!syncing) {
 		if (((linemode && appres.linemode.onlcr) ||
 		     (!linemode && charmode_onlcr))
@@ -1736,7 +1788,7 @@ telnet_fsm(unsigned char c)
 	break;
     case TNS_IAC:	/* process a telnet command */
 	if (c != EOR && c != IAC) {
-	    vtrace("RCVD %s ", cmd(c));
+	    vctrace(TC_TELNET, "RCVD %s ", cmd(c));
 	}
 	switch (c) {
 	case IAC:	/* escaped IAC, insert it */
@@ -1782,7 +1834,7 @@ telnet_fsm(unsigned char c)
 	    } else {
 		popup_an_error("EOR received when not in 3270 mode, ignored");
 	    }
-	    vtrace("RCVD EOR\n");
+	    vctrace(TC_TELNET, "RCVD EOR\n");
 	    ibptr = ibuf;
 	    telnet_state = TNS_DATA;
 	    break;
@@ -1806,7 +1858,7 @@ telnet_fsm(unsigned char c)
 	    sbptr = sbbuf;
 	    break;
 	case DM:
-	    vtrace("\n");
+	    vctrace(TC_TELNET, "\n");
 	    if (syncing) {
 		syncing = 0;
 #if !defined(_WIN32) /*[*/
@@ -1819,17 +1871,17 @@ telnet_fsm(unsigned char c)
 	    break;
 	case GA:
 	case NOP:
-	    vtrace("\n");
+	    vctrace(TC_TELNET, "\n");
 	    telnet_state = TNS_DATA;
 	    break;
 	default:
-	    vtrace("???\n");
+	    vctrace(TC_TELNET, "???\n");
 	    telnet_state = TNS_DATA;
 	    break;
 	}
 	break;
     case TNS_WILL:	/* telnet WILL DO OPTION command */
-	vtrace("%s\n", opt(c));
+	vctrace(TC_TELNET, "%s\n", opt(c));
 	switch (c) {
 	case TELOPT_SGA:
 	case TELOPT_BINARY:
@@ -1842,14 +1894,14 @@ telnet_fsm(unsigned char c)
 		    hisopts[c] = 1;
 		    do_opt[2] = c;
 		    net_rawout(do_opt, sizeof(do_opt));
-		    vtrace("SENT %s %s\n", cmd(DO), opt(c));
+		    vctrace(TC_TELNET, "SENT %s %s\n", cmd(DO), opt(c));
 
 		    /* For UTS, volunteer to do EOR when they do. */
 		    if (c == TELOPT_EOR && !myopts[c]) {
 			myopts[c] = 1;
 			will_opt[2] = c;
 			net_rawout(will_opt, sizeof(will_opt));
-			vtrace("SENT %s %s\n", cmd(WILL), opt(c));
+			vctrace(TC_TELNET, "SENT %s %s\n", cmd(WILL), opt(c));
 		    }
 
 		    check_in3270();
@@ -1860,18 +1912,18 @@ telnet_fsm(unsigned char c)
 	default:
 	    dont_opt[2] = c;
 	    net_rawout(dont_opt, sizeof(dont_opt));
-	    vtrace("SENT %s %s\n", cmd(DONT), opt(c));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(DONT), opt(c));
 	    break;
 	}
 	telnet_state = TNS_DATA;
 	break;
     case TNS_WONT:	/* telnet WONT DO OPTION command */
-	vtrace("%s\n", opt(c));
+	vctrace(TC_TELNET, "%s\n", opt(c));
 	if (hisopts[c]) {
 	    hisopts[c] = 0;
 	    dont_opt[2] = c;
 	    net_rawout(dont_opt, sizeof(dont_opt));
-	    vtrace("SENT %s %s\n", cmd(DONT), opt(c));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(DONT), opt(c));
 	    check_in3270();
 	    check_linemode(false);
 	} else if (c == TELOPT_TN3270E && myopts[c]) {
@@ -1882,14 +1934,14 @@ telnet_fsm(unsigned char c)
 	    myopts[c] = 0;
 	    wont_opt[2] = c;
 	    net_rawout(wont_opt, sizeof(wont_opt));
-	    vtrace("SENT %s %s\n", cmd(WONT), opt(c));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(WONT), opt(c));
 	    check_in3270();
 	    check_linemode(false);
 	}
 	telnet_state = TNS_DATA;
 	break;
     case TNS_DO:	/* telnet PLEASE DO OPTION command */
-	vtrace("%s\n", opt(c));
+	vctrace(TC_TELNET, "%s\n", opt(c));
 	switch (c) {
 	case TELOPT_BINARY:
 	case TELOPT_EOR:
@@ -1936,7 +1988,7 @@ telnet_fsm(unsigned char c)
 		}
 		will_opt[2] = c;
 		net_rawout(will_opt, sizeof(will_opt));
-		vtrace("SENT %s %s\n", cmd(WILL), opt(c));
+		vctrace(TC_TELNET, "SENT %s %s\n", cmd(WILL), opt(c));
 		check_in3270();
 		check_linemode(false);
 	    }
@@ -1953,7 +2005,7 @@ telnet_fsm(unsigned char c)
 		 * follows is TLS.
 		 */
 		net_rawout(follows_msg, sizeof(follows_msg));
-		vtrace("SENT %s %s FOLLOWS %s\n", cmd(SB),
+		vctrace(TC_TELNET, "SENT %s %s FOLLOWS %s\n", cmd(SB),
 			opt(TELOPT_STARTTLS), cmd(SE));
 		need_tls_follows = true;
 	    }
@@ -1962,18 +2014,18 @@ telnet_fsm(unsigned char c)
 	wont:
 	    wont_opt[2] = c;
 	    net_rawout(wont_opt, sizeof(wont_opt));
-	    vtrace("SENT %s %s\n", cmd(WONT), opt(c));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(WONT), opt(c));
 	    break;
 	}
 	telnet_state = TNS_DATA;
 	break;
     case TNS_DONT:	/* telnet PLEASE DON'T DO OPTION command */
-	vtrace("%s\n", opt(c));
+	vctrace(TC_TELNET, "%s\n", opt(c));
 	if (myopts[c]) {
 	    myopts[c] = 0;
 	    wont_opt[2] = c;
 	    net_rawout(wont_opt, sizeof(wont_opt));
-	    vtrace("SENT %s %s\n", cmd(WONT), opt(c));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(WONT), opt(c));
 	    check_in3270();
 	    check_linemode(false);
 	}
@@ -1997,7 +2049,8 @@ telnet_fsm(unsigned char c)
 		size_t tt_len, tb_len;
 		char *tt_out;
 
-		vtrace("%s %s\n", opt(sbbuf[0]), telquals[sbbuf[1]]);
+		vctrace(TC_TELNET, "%s %s\n", opt(sbbuf[0]),
+			telquals[sbbuf[1]]);
 		if (lus != NULL && try_lu == NULL) {
 		    /* None of the LUs worked. */
 		    connect_error("Cannot connect to specified LU");
@@ -2025,8 +2078,8 @@ telnet_fsm(unsigned char c)
 
 		vstatus_lu(connected_lu);
 
-		vtrace("SENT %s %s %s %s%s%s %s\n", cmd(SB), opt(TELOPT_TTYPE),
-			telquals[TELQUAL_IS], termtype,
+		vctrace(TC_TELNET, "SENT %s %s %s %s%s%s %s\n", cmd(SB),
+			opt(TELOPT_TTYPE), telquals[TELQUAL_IS], termtype,
 			(try_lu != NULL && *try_lu)? "@": "",
 			(try_lu != NULL && *try_lu)? try_lu: "",
 			cmd(SE));
@@ -2053,14 +2106,14 @@ telnet_fsm(unsigned char c)
 		if (!telnet_new_environ(sbbuf + 2, (sbptr - sbbuf - 3),
 			    &reply_buf, &reply_buflen, &trace_in,
 			    &trace_out)) {
-		    vtrace("%s %s [error]\n", opt(sbbuf[0]),
+		    vctrace(TC_TELNET, "%s %s [error]\n", opt(sbbuf[0]),
 			    telquals[sbbuf[1]]);
 		} else {
-		    vtrace("%s\n", trace_in);
+		    vctrace(TC_TELNET, "%s\n", trace_in);
 		    Free(trace_in);
 		    net_rawout(reply_buf, reply_buflen);
 		    Free(reply_buf);
-		    vtrace("SENT %s\n", trace_out);
+		    vctrace(TC_TELNET, "SENT %s\n", trace_out);
 		    Free(trace_out);
 		}
 
@@ -2074,7 +2127,8 @@ telnet_fsm(unsigned char c)
 		if (deferred_will_ttype && myopts[TELOPT_TTYPE]) {
 		    will_opt[2] = TELOPT_TTYPE;
 		    net_rawout(will_opt, sizeof(will_opt));
-		    vtrace("SENT %s %s\n", cmd(WILL), opt(TELOPT_TTYPE));
+		    vctrace(TC_TELNET, "SENT %s %s\n", cmd(WILL),
+			    opt(TELOPT_TTYPE));
 		    check_in3270();
 		    check_linemode(false);
 		    deferred_will_ttype = false;
@@ -2135,7 +2189,7 @@ tn3270e_request(void)
     net_hexnvt_out_framed((unsigned char *)tt_out, tb_len, true);
     Free(tt_out);
 
-    vtrace("SENT %s %s DEVICE-TYPE REQUEST %s%s%s %s\n",
+    vctrace(TC_TELNET, "SENT %s %s DEVICE-TYPE REQUEST %s%s%s %s\n",
 	cmd(SB), opt(TELOPT_TN3270E), xtn,
 	(try_lu != NULL && *try_lu)? " CONNECT ": "",
 	(try_lu != NULL && *try_lu)? try_lu: "",
@@ -2150,12 +2204,12 @@ tn3270e_request(void)
 static void
 backoff_tn3270e(const char *why)
 {
-    vtrace("Aborting TN3270E: %s\n", why);
+    vctrace(TC_TELNET, "Aborting TN3270E: %s\n", why);
 
     /* Tell the host 'no'. */
     wont_opt[2] = TELOPT_TN3270E;
     net_rawout(wont_opt, sizeof(wont_opt));
-    vtrace("SENT %s %s\n", cmd(WONT), opt(TELOPT_TN3270E));
+    vctrace(TC_TELNET, "SENT %s %s\n", cmd(WONT), opt(TELOPT_TN3270E));
 
     /* Restore the LU list; we may need to run it again in TN3270 mode. */
     setup_lus();
@@ -2186,22 +2240,22 @@ tn3270e_negotiate(void)
 	}
     }
 
-    vtrace("TN3270E ");
+    vctrace(TC_TELNET, "TN3270E ");
 
     switch (sbbuf[1]) {
     case TN3270E_OP_SEND:
 	if (sbbuf[2] == TN3270E_OP_DEVICE_TYPE) {
 	    /* Host wants us to send our device type. */
-	    vtrace("SEND DEVICE-TYPE SE\n");
+	    vctrace(TC_TELNET, "SEND DEVICE-TYPE SE\n");
 	    tn3270e_request();
 	} else {
-	    vtrace("SEND ??%u SE\n", sbbuf[2]);
+	    vctrace(TC_TELNET, "SEND ??%u SE\n", sbbuf[2]);
 	}
 	break;
 
     case TN3270E_OP_DEVICE_TYPE:
 	/* Device type negotiation. */
-	vtrace("DEVICE-TYPE ");
+	vctrace(TC_TELNET, "DEVICE-TYPE ");
 	switch (sbbuf[2]) {
 	case TN3270E_OP_IS: {
 	    int tnlen, snlen;
@@ -2241,8 +2295,8 @@ tn3270e_negotiate(void)
 		connected_lu = reported_lu;
 	    }
 
-	    vtrace("IS %s CONNECT %s SE\n", tnlen? connected_type: "",
-		    snlen? connected_lu: "");
+	    vctrace(TC_TELNET, "IS %s CONNECT %s SE\n",
+		    tnlen? connected_type: "", snlen? connected_lu: "");
 
 	    if (snlen) {
 		vstatus_lu(connected_lu);
@@ -2254,7 +2308,7 @@ tn3270e_negotiate(void)
 	    }
 	case TN3270E_OP_REJECT:
 	    /* Device type failure. */
-	    vtrace("REJECT REASON %s SE\n", rsn(sbbuf[4]));
+	    vctrace(TC_TELNET, "REJECT REASON %s SE\n", rsn(sbbuf[4]));
 	    if (sbbuf[4] == TN3270E_REASON_UNSUPPORTED_REQ) {
 		backoff_tn3270e("Host rejected request type");
 		break;
@@ -2273,19 +2327,19 @@ tn3270e_negotiate(void)
 
 	    break;
 	default:
-	    vtrace("??%u SE\n", sbbuf[2]);
+	    vctrace(TC_TELNET, "??%u SE\n", sbbuf[2]);
 	    break;
 	}
 	break;
 
     case TN3270E_OP_FUNCTIONS:
 	/* Functions negotiation. */
-	vtrace("FUNCTIONS ");
+	vctrace(TC_TELNET, "FUNCTIONS ");
 
 	switch (sbbuf[2]) {
 	case TN3270E_OP_REQUEST:
 	    /* Host is telling us what functions they want. */
-	    vtrace("REQUEST %s SE\n",
+	    vctrace(TC_TELNET, "REQUEST %s SE\n",
 		    tn3270e_function_names(sbbuf+3, sblen-3));
 
 	    tn3270e_fdecode(sbbuf+3, sblen-3, &e_rcvd);
@@ -2294,7 +2348,7 @@ tn3270e_negotiate(void)
 		b8_copy(&e_funcs, &e_rcvd);
 		tn3270e_subneg_send(TN3270E_OP_IS, &e_funcs);
 		tn3270e_negotiated = 1;
-		vtrace("TN3270E option negotiation complete.\n");
+		vctrace(TC_TELNET, "TN3270E option negotiation complete.\n");
 		check_in3270();
 	    } else {
 		/*
@@ -2308,7 +2362,8 @@ tn3270e_negotiate(void)
 
 	case TN3270E_OP_IS:
 	    /* They accept our last request, or a subset thereof. */
-	    vtrace("IS %s SE\n", tn3270e_function_names(sbbuf+3, sblen-3));
+	    vctrace(TC_TELNET, "IS %s SE\n",
+		    tn3270e_function_names(sbbuf+3, sblen-3));
 	    tn3270e_fdecode(sbbuf+3, sblen-3, &e_rcvd);
 	    if (b8_none_added(&e_funcs, &e_rcvd)) {
 		/* They want what we want, or less.  Done. */
@@ -2322,7 +2377,7 @@ tn3270e_negotiate(void)
 		break;
 	    }
 	    tn3270e_negotiated = 1;
-	    vtrace("TN3270E option negotiation complete.\n");
+	    vctrace(TC_TELNET, "TN3270E option negotiation complete.\n");
 
 	    /*
 	     * If the host does not support BIND_IMAGE, then we
@@ -2338,13 +2393,13 @@ tn3270e_negotiate(void)
 	    break;
 
 	default:
-	    vtrace("??%u SE\n", sbbuf[2]);
+	    vctrace(TC_TELNET, "??%u SE\n", sbbuf[2]);
 	    break;
 	}
 	break;
 
     default:
-	vtrace("??%u SE\n", sbbuf[1]);
+	vctrace(TC_TELNET, "??%u SE\n", sbbuf[1]);
     }
 
     /* Good enough for now. */
@@ -2411,7 +2466,7 @@ tn3270e_subneg_send(unsigned char op, b8_t *funcs)
     net_rawout(proto_buf, proto_len);
 
     /* Complete and send out the trace text. */
-    vtrace("SENT %s %s FUNCTIONS %s %s %s\n",
+    vctrace(TC_TELNET, "SENT %s %s FUNCTIONS %s %s %s\n",
 	    cmd(SB), opt(TELOPT_TN3270E),
 	    (op == TN3270E_OP_REQUEST)? "REQUEST": "IS",
 	    tn3270e_function_names(proto_buf + 5, proto_len - 7),
@@ -2660,11 +2715,10 @@ process_eor(void)
 
     if (IN_E) {
 	tn3270e_header *h = (tn3270e_header *)ibuf;
-	unsigned char *s;
 	enum pds rv;
 	bool bid_success;
 
-	vtrace("RCVD TN3270E(%s%s %s %u)\n",
+	vctrace(TC_TELNET, "RCVD TN3270E(%s%s %s %u)\n",
 		e_dt(h->data_type),
 		e_rq(h->data_type, h->request_flag),
 		e_rsp(h->data_type, h->response_flag),
@@ -2762,9 +2816,7 @@ process_eor(void)
 	    tn3270e_submode = E_NVT;
 	    check_in3270();
 	    trace_envt_in(ibuf + EH_SIZE, ibptr - (ibuf + EH_SIZE));
-	    for (s = ibuf + EH_SIZE; s < ibptr; s++) {
-		nvt_process((unsigned int)*s);
-	    }
+	    nvt_process_run(ibuf + EH_SIZE, ibptr - (ibuf + EH_SIZE));
 	    if (h->response_flag == TN3270E_RSF_ALWAYS_RESPONSE) {
 		tn3270e_ack();
 	    }
@@ -2840,7 +2892,7 @@ net_exception(iosrc_t fd _is_unused, ioid_t id _is_unused)
 void
 net_cookedout(const char *buf, size_t len)
 {
-    if (toggled(TRACING)) {
+    if (trace_on(TC_NET)) {
 	size_t i;
 	bool any = false;
 	bool last_cmd = false;
@@ -3087,7 +3139,7 @@ check_in3270(void)
 
 	/* If we fell out of TN3270E, remove the state. */
 	if (!myopts[TELOPT_TN3270E]) {
-	    vtrace("Aborting TN3270E: negotiated off\n");
+	    vctrace(TC_TELNET, "Aborting TN3270E: negotiated off\n");
 	    tn3270e_init();
 	}
 	vtrace("Now operating in %s mode.\n", state_name[new_cstate]);
@@ -3243,22 +3295,39 @@ opt(unsigned char c)
 
 #define LINEDUMP_MAX	32
 
+/*
+ * Trace network data in hex, LINEDUMP_MAX bytes per line.
+ * Each line is formatted locally and traced with a single call.
+ */
 void
 trace_netdata(char direction, unsigned const char *buf, size_t len)
 {
+    static const char hex[] = "0123456789abcdef";
+    char line[32 + (LINEDUMP_MAX * 2) + 2];
     size_t offset;
 
-    if (!toggled(TRACING)) {
+    trace_netdata_record(direction, buf, len);
+    if (!trace_on(TC_NET)) {
 	    return;
     }
-    for (offset = 0; offset < len; offset++) {
-	if (!(offset % LINEDUMP_MAX)) {
-	    ntvtrace("%s%c 0x%-3x ", (offset? "\n": ""), direction,
-		    (unsigned)offset);
+    if (len == 0) {
+	ntvtrace("\n");
+	return;
+    }
+    for (offset = 0; offset < len; offset += LINEDUMP_MAX) {
+	size_t n = (len - offset < LINEDUMP_MAX)? len - offset: LINEDUMP_MAX;
+	char *s = line + snprintf(line, 32, "%c 0x%-3x ", direction,
+		(unsigned)offset);
+	size_t i;
+
+	for (i = 0; i < n; i++) {
+	    *s++ = hex[buf[offset + i] >> 4];
+	    *s++ = hex[buf[offset + i] & 0xf];
 	}
-	ntvtrace("%02x", buf[offset]);
+	*s++ = '\n';
+	*s = '\0';
+	ntvtrace("%s", line);
     }
-    ntvtrace("\n");
 }
 
 /* Trace incoming E-mode NVT data. */
@@ -3332,7 +3401,7 @@ net_output(void)
 	h->seq_number[0] = (e_xmit_seq >> 8) & 0xff;
 	h->seq_number[1] = e_xmit_seq & 0xff;
 
-	vtrace("SENT TN3270E(%s NO-RESPONSE %u)\n",
+	vctrace(TC_TELNET, "SENT TN3270E(%s NO-RESPONSE %u)\n",
 		IN_TN3270E? "3270-DATA":
 		((IN_E_NVT)? "NVT-DATA": "SSCP-LU-DATA"),
 		e_xmit_seq);
@@ -3364,7 +3433,7 @@ net_output(void)
     *xoptr++ = EOR;
     net_rawout(xobuf, xoptr - xobuf);
 
-    vtrace("SENT EOR\n");
+    vctrace(TC_TELNET, "SENT EOR\n");
     ns_rsent++;
     stats_poke();
 #undef BSTART
@@ -3393,7 +3462,8 @@ tn3270e_ack(void)
     rsp_buf[rsp_len++] = TN3270E_POS_DEVICE_END;
     rsp_buf[rsp_len++] = IAC;
     rsp_buf[rsp_len++] = EOR;
-    vtrace("SENT TN3270E(RESPONSE POSITIVE-RESPONSE %u) DEVICE-END\n",
+    vctrace(TC_TELNET,
+	    "SENT TN3270E(RESPONSE POSITIVE-RESPONSE %u) DEVICE-END\n",
 	    h_in->seq_number[0] << 8 | h_in->seq_number[1]);
     net_rawout(rsp_buf, rsp_len);
 }
@@ -3431,7 +3501,7 @@ tn3270e_nak(enum pds rv)
     }
     rsp_buf[rsp_len++] = IAC;
     rsp_buf[rsp_len++] = EOR;
-    vtrace("SENT TN3270E(RESPONSE NEGATIVE-RESPONSE %u) %s\n",
+    vctrace(TC_TELNET, "SENT TN3270E(RESPONSE NEGATIVE-RESPONSE %u) %s\n",
 	    h_in->seq_number[0] << 8 | h_in->seq_number[1], neg);
     net_rawout(rsp_buf, rsp_len);
 }
@@ -3536,12 +3606,12 @@ net_linemode(void)
 	if (hisopts[TELOPT_ECHO]) {
 	    dont_opt[2] = TELOPT_ECHO;
 	    net_rawout(dont_opt, sizeof(dont_opt));
-	    vtrace("SENT %s %s\n", cmd(DONT), opt(TELOPT_ECHO));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(DONT), opt(TELOPT_ECHO));
 	}
 	if (hisopts[TELOPT_SGA]) {
 	    dont_opt[2] = TELOPT_SGA;
 	    net_rawout(dont_opt, sizeof(dont_opt));
-	    vtrace("SENT %s %s\n", cmd(DONT), opt(TELOPT_SGA));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(DONT), opt(TELOPT_SGA));
 	}
     } else {
 	hisopts[TELOPT_ECHO] = 0;
@@ -3560,12 +3630,12 @@ net_charmode(void)
 	if (!hisopts[TELOPT_ECHO]) {
 	    do_opt[2] = TELOPT_ECHO;
 	    net_rawout(do_opt, sizeof(do_opt));
-	    vtrace("SENT %s %s\n", cmd(DO), opt(TELOPT_ECHO));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(DO), opt(TELOPT_ECHO));
 	}
 	if (!hisopts[TELOPT_SGA]) {
 	    do_opt[2] = TELOPT_SGA;
 	    net_rawout(do_opt, sizeof(do_opt));
-	    vtrace("SENT %s %s\n", cmd(DO), opt(TELOPT_SGA));
+	    vctrace(TC_TELNET, "SENT %s %s\n", cmd(DO), opt(TELOPT_SGA));
 	}
     } else {
 	hisopts[TELOPT_ECHO] = 1;
@@ -3587,7 +3657,7 @@ net_break(char c)
 
 	/* I don't know if we should first send TELNET synch ? */
 	net_rawout(buf, sizeof(buf));
-	vtrace("SENT BREAK\n");
+	vctrace(TC_TELNET, "SENT BREAK\n");
     } else if (c != '\0') {
 	net_rawout((unsigned char *)&c, 1);
     }
@@ -3606,7 +3676,7 @@ net_interrupt(char c)
 
 	/* I don't know if we should first send TELNET synch ? */
 	net_rawout(buf, sizeof(buf));
-	vtrace("SENT IP\n");
+	vctrace(TC_TELNET, "SENT IP\n");
     } else if (c != '\0') {
 	net_rawout((unsigned char *)&c, 1);
     }
@@ -3630,7 +3700,7 @@ net_abort(void)
 	case E_SSCP:
 	case E_3270:
 	    net_rawout(buf, sizeof(buf));
-	    vtrace("SENT AO\n");
+	    vctrace(TC_TELNET, "SENT AO\n");
 	    break;
 	}
     }
@@ -3875,14 +3945,14 @@ continue_tls(unsigned char *sbbuf, int len)
     /* Make sure the option is FOLLOWS. */
     if (len < 2 || sbbuf[1] != TLS_FOLLOWS) {
 	/* Trace the junk. */
-	vtrace("%s ? %s\n", opt(TELOPT_STARTTLS), cmd(SE));
+	vctrace(TC_TELNET, "%s ? %s\n", opt(TELOPT_STARTTLS), cmd(SE));
 	connect_error("TLS negotiation failure");
 	host_disconnect(true);
 	return;
     }
 
     /* Trace what we got. */
-    vtrace("%s FOLLOWS %s\n", opt(TELOPT_STARTTLS), cmd(SE));
+    vctrace(TC_TELNET, "%s FOLLOWS %s\n", opt(TELOPT_STARTTLS), cmd(SE));
 
     /* Negotiate. */
     net_starttls_continue();
@@ -52,6 +52,7 @@
 #include "model.h"
 #include "names.h"
 #include "nvt.h"
+#include "opts.h"
 #include "popups.h"
 #include "print_screen.h"
 #include "product.h"
@@ -63,10 +64,12 @@
 #include "telnet_core.h"
 #include "toggles.h"
 #include "trace.h"
+#include "trace_binary.h"
 #include "trace_gui.h"
 #include "txa.h"
 #include "utf8.h"
 #include "utils.h"
+#include "varbuf.h"
 #if defined(_WIN32) /*[*/
 # include "w3misc.h"
 # include "windirs.h"
@@ -82,6 +85,21 @@
 /* Maximum size of a tracefile header. */
 #define MAX_HEADER_SIZE		(32*1024)
 
+/* Size of the trace output buffer. */
+#define TRACE_OBUF_SIZE		(64*1024)
+
+/* Initial size of the trace message formatting buffer. */
+#define TRACE_FBUF_SIZE		1024
+
+/* How long buffered trace output can wait to be written, in msec. */
+#define TRACE_FLUSH_MS		250
+
+/* Default flight recorder categories. */
+#define FREC_DEFAULT_CATEGORIES	"ds,net"
+
+/* Minimum size of the flight recorder. */
+#define MIN_FREC_SIZE		(4*1024)
+
 /* Minimum size of a trace file. */
 #define MIN_TRACEFILE_SIZE	(64*1024)
 #define MIN_TRACEFILE_SIZE_NAME	"64K"
@@ -112,12 +130,56 @@ static char    *tracef_bufptr = NULL;
 static off_t	tracef_size = 0;
 static off_t	tracef_max = 0;
 static char    *onetime_tracefile_name = NULL;
+static char    *trace_obuf = NULL;	/* buffered output */
+static size_t	trace_obuf_len = 0;
+static char    *trace_fbuf = NULL;	/* formatted message */
+static size_t	trace_fbuf_size = 0;
+static ioid_t	trace_flush_id = NULL_IOID;
+static bool	trace_flushing = false;
+static bool	trace_binary = false;	/* trace file is binary */
+static unsigned	trace_categories = TC_ALL; /* categories sent to the file */
+static bool	trace_categories_set = false;
+#if !defined(_WIN32) /*[*/
+static pid_t	trace_pid = -1;
+#endif /*]*/
 
-static void	vwtrace(bool do_ts, const char *fmt, va_list args);
+/*
+ * The flight recorder: a fixed-size ring that holds the most recent trace
+ * output in the selected categories, whether or not a trace file is open.
+ */
+static struct {
+    bool initted;		/* resources have been read */
+    char *buf;			/* ring buffer */
+    size_t size;		/* size of buf */
+    size_t head;		/* offset of the next byte to write */
+    bool wrapped;		/* true if buf has filled */
+    unsigned categories;	/* TC_xxx categories captured */
+} frec;
+
+static void	vwtrace(bool do_ts, unsigned category, const char *fmt,
+		    va_list args);
 static void	wtrace(bool do_ts, const char *fmt, ...);
-static char    *create_tracefile_header(const char *mode);
+static char    *create_tracefile_header(const char *mode, bool snap);
 static void	stop_tracing(void);
 
+/* Trace category names. */
+static struct {
+    const char *name;
+    unsigned category;
+} category_names[] = {
+    { "ds",	TC_DS },
+    { "net",	TC_NET },
+    { "telnet",	TC_TELNET },
+    { "script",	TC_SCRIPT },
+    { "httpd",	TC_HTTPD },
+    { "sched",	TC_SCHED },
+    { "other",	TC_EVENT },
+    { "events",	TC_EVENTS },
+    { "all",	TC_ALL },
+    { "none",	0 },
+    { NULL,	0 }
+};
+
 /* Globals */
 bool		trace_skipping = false;
 char	       *tracefile_name = NULL;
@@ -132,6 +194,119 @@ rcba(int baddr)
     return txAsprintf("(%d,%d)", baddr/COLS + 1, baddr%COLS + 1);
 }
 
+/*
+ * Returns true if trace output in the given category goes to the trace file.
+ * Binary trace files hold raw network data, so the network data decodes are
+ * not formatted for them.
+ */
+static bool
+file_wants(unsigned category)
+{
+    return tracef != NULL && (trace_categories & category) &&
+	(!trace_binary || !(category & TC_NET));
+}
+
+/*
+ * Returns true if trace output in the given category goes anywhere: to the
+ * trace file, to the flight recorder, or into a trace file header.
+ * Callers with expensive trace output check this before formatting it.
+ */
+bool
+trace_on(unsigned category)
+{
+    return (toggled(TRACING) && file_wants(category)) ||
+	(frec.categories & category) ||
+	tracef_bufptr != NULL;
+}
+
+/*
+ * Parse a list of trace category names.
+ * Returns true for success, false (with an error pop-up) for failure.
+ */
+static bool
+parse_categories(const char *what, const char *value, unsigned *categoriesp)
+{
+    char *cats;
+    char *c;
+    char *token;
+    unsigned categories = 0;
+
+    c = cats = NewString(value);
+    while ((token = strtok(c, ", \t")) != NULL) {
+	int i;
+
+	c = NULL;
+	for (i = 0; category_names[i].name != NULL; i++) {
+	    if (!strcasecmp(token, category_names[i].name)) {
+		categories |= category_names[i].category;
+		break;
+	    }
+	}
+	if (category_names[i].name == NULL) {
+	    popup_an_error("Invalid %s: %s", what, token);
+	    Free(cats);
+	    return false;
+	}
+    }
+    Free(cats);
+    *categoriesp = categories;
+    return true;
+}
+
+/* Format a set of trace categories. */
+static const char *
+format_categories(unsigned categories)
+{
+    varbuf_t r;
+    int i;
+
+    if (categories == TC_ALL) {
+	return "all";
+    }
+    if (!categories) {
+	return "none";
+    }
+    vb_init(&r);
+    for (i = 0; category_names[i].name != NULL; i++) {
+	unsigned c = category_names[i].category;
+
+	/* Skip the names for groups of categories. */
+	if ((c & (c - 1)) == 0 && (categories & c)) {
+	    vb_appendf(&r, "%s%s", vb_len(&r)? " ": "",
+		    category_names[i].name);
+	}
+    }
+    return txdFree(vb_consume(&r));
+}
+
+/* Set the trace file categories from the resource, if not set already. */
+static void
+trace_categories_init(void)
+{
+    char *cat_res;
+
+    if (trace_categories_set) {
+	return;
+    }
+    trace_categories_set = true;
+    cat_res = get_resource(ResTraceCategories);
+    if (cat_res != NULL) {
+	(void) parse_categories(ResTraceCategories, cat_res,
+		&trace_categories);
+    }
+}
+
+/* Write data stream trace output. */
+static void
+ds_wtrace(const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    vwtrace(false, TC_DS, fmt, args);
+    va_end(args);
+}
+
 /* Data Stream trace print, handles line wraps */
 
 /*
@@ -157,7 +332,7 @@ trace_ds_s(char *s, bool can_break)
     wchar_t *w_chunk;		/* transient wchar_t buffer */
     char *mb_chunk;		/* transient multibyte buffer */
 
-    if (!toggled(TRACING) || tracef == NULL || !len) {
+    if (!trace_on(TC_DS) || !len) {
 	return;
     }
 
@@ -180,7 +355,7 @@ trace_ds_s(char *s, bool can_break)
     }
 
     if (!can_break && dscnt + wlen >= TRACE_DS_WRAP) {
-	wtrace(false, "...\n... ");
+	ds_wtrace("...\n... ");
 	dscnt = 0;
     }
 
@@ -200,7 +375,7 @@ trace_ds_s(char *s, bool can_break)
 	    mblen = 0;
 	}
 
-	wtrace(false, "%.*s ...\n... ", mblen, mb_chunk);
+	ds_wtrace("%.*s ...\n... ", mblen, mb_chunk);
 	dscnt = 4;
 	w_cur += plen;
 	wlen -= plen;
@@ -213,11 +388,11 @@ trace_ds_s(char *s, bool can_break)
 	mblen = wcstombs(mb_chunk, w_chunk, len0);
 	if (mblen == 0 || mblen == (size_t)-1)
 	    Error("trace_ds_s: wcstombs 2 failed");
-	wtrace(false, "%.*s", mblen, mb_chunk);
+	ds_wtrace("%.*s", mblen, mb_chunk);
 	dscnt += wlen;
     }
     if (nl) {
-	wtrace(false, "\n");
+	ds_wtrace("\n");
 	dscnt = 0;
     }
     Free(mb_chunk);
@@ -235,7 +410,7 @@ trace_ds(const char *fmt, ...)
     va_list args;
     char *s;
 
-    if (!toggled(TRACING) || tracef == NULL) {
+    if (!trace_on(TC_DS)) {
 	return;
     }
 
@@ -253,13 +428,29 @@ vtrace(const char *fmt, ...)
 {
     va_list args;
 
-    if (!toggled(TRACING) || tracef == NULL) {
+    if (!trace_on(TC_EVENT)) {
+	return;
+    }
+
+    /* print out message */
+    va_start(args, fmt);
+    vwtrace(true, TC_EVENT, fmt, args);
+    va_end(args);
+}
+
+/* Conditional event trace in a particular category. */
+void
+vctrace(unsigned category, const char *fmt, ...)
+{
+    va_list args;
+
+    if (!trace_on(category)) {
 	return;
     }
 
     /* print out message */
     va_start(args, fmt);
-    vwtrace(true, fmt, args);
+    vwtrace(true, category, fmt, args);
     va_end(args);
 }
 
@@ -269,50 +460,286 @@ ntvtrace(const char *fmt, ...)
 {
     va_list args;
 
-    if (!toggled(TRACING) || tracef == NULL) {
+    if (!trace_on(TC_NET)) {
 	return;
     }
 
     /* print out message */
     va_start(args, fmt);
-    vwtrace(false, fmt, args);
+    vwtrace(false, TC_NET, fmt, args);
     va_end(args);
 }
 
 /*
  * Generate a timestamp for the trace file.
+ * The date and time are only reformatted when the second changes.
  */
 static char *
 gen_ts(void)
 {
+    static char ts[64];
+    static size_t ts_len = 0;
+    static time_t last_t = (time_t)-1;
     struct timeval tv;
     time_t t;
-    struct tm *tm;
 
     gettimeofday(&tv, NULL);
     t = tv.tv_sec;
-    tm = localtime(&t);
-    return txAsprintf("%d%02d%02d.%02d%02d%02d.%03d ",
-	    tm->tm_year + 1900,
-	    tm->tm_mon + 1,
-	    tm->tm_mday,
-	    tm->tm_hour,
-	    tm->tm_min,
-	    tm->tm_sec,
+    if (t != last_t) {
+	struct tm *tm = localtime(&t);
+
+	snprintf(ts, sizeof(ts), "%d%02d%02d.%02d%02d%02d.",
+		tm->tm_year + 1900,
+		tm->tm_mon + 1,
+		tm->tm_mday,
+		tm->tm_hour,
+		tm->tm_min,
+		tm->tm_sec);
+	ts_len = strlen(ts);
+	last_t = t;
+    }
+    snprintf(ts + ts_len, sizeof(ts) - ts_len, "%03d ",
 	    (int)(tv.tv_usec / 1000L));
+    return ts;
+}
+
+/* Write buffered output to the trace file. */
+static void
+trace_flush(void)
+{
+    size_t len = trace_obuf_len;
+
+    if (trace_flush_id != NULL_IOID) {
+	RemoveTimeOut(trace_flush_id);
+	trace_flush_id = NULL_IOID;
+    }
+    if (tracef == NULL || !len || trace_flushing) {
+	return;
+    }
+
+    trace_flushing = true;
+    trace_obuf_len = 0;
+    if (fwrite(trace_obuf, len, 1, tracef) != 1 || fflush(tracef) == EOF) {
+	int error = errno;
+
+	if (error != EPIPE && !IS_EILSEQ(error)) {
+	    popup_an_errno(error, "Write to trace file failed");
+	}
+	if (!IS_EILSEQ(error)) {
+	    stop_tracing();
+	}
+    }
+    trace_flushing = false;
+}
+
+/* The flush timer has expired. */
+static void
+trace_flush_timeout(ioid_t id _is_unused)
+{
+    trace_flush_id = NULL_IOID;
+    trace_flush();
+}
+
+/* Write out any buffered trace output when the process exits. */
+static void
+trace_atexit(void)
+{
+#if !defined(_WIN32) /*[*/
+    /* Don't write the parent's output from a child process. */
+    if (getpid() != trace_pid) {
+	return;
+    }
+#endif /*]*/
+    trace_flush();
+}
+
+#if !defined(_WIN32) /*[*/
+/* Signals that crash the process, and their handlers before tracing. */
+static int fatal_signals[] = { SIGSEGV, SIGBUS, SIGABRT, SIGFPE };
+static void (*fatal_handlers[array_count(fatal_signals)])(int);
+static bool fatal_caught = false;
+
+/*
+ * Write out any buffered trace output when the process crashes, so the
+ * output closest to the crash is not lost, then let the signal take its
+ * course.
+ */
+static void
+trace_fatal_signal(int sig)
+{
+    size_t i;
+
+    if (getpid() == trace_pid && tracef != NULL && trace_obuf_len &&
+	    !trace_flushing) {
+	ssize_t nw;
+
+	nw = write(fileno(tracef), trace_obuf, trace_obuf_len);
+	(void)nw;
+    }
+    for (i = 0; i < array_count(fatal_signals); i++) {
+	if (fatal_signals[i] == sig) {
+	    signal(sig, fatal_handlers[i]);
+	}
+    }
+    raise(sig);
+}
+
+/*
+ * Catch the fatal signals while a trace file is open, or put back the
+ * handlers they had before.
+ */
+static void
+trace_catch_fatal(bool catch)
+{
+    size_t i;
+
+    if (catch == fatal_caught) {
+	return;
+    }
+    for (i = 0; i < array_count(fatal_signals); i++) {
+	if (catch) {
+	    fatal_handlers[i] = signal(fatal_signals[i], trace_fatal_signal);
+	} else {
+	    signal(fatal_signals[i], fatal_handlers[i]);
+	}
+    }
+    fatal_caught = catch;
+}
+#endif /*]*/
+
+/* Add text to the trace output buffer. */
+static void
+trace_append(const char *s, size_t len)
+{
+    if (trace_obuf_len + len > TRACE_OBUF_SIZE) {
+	trace_flush();
+    }
+    if (tracef == NULL) {
+	return;
+    }
+    if (trace_obuf_len + len > TRACE_OBUF_SIZE) {
+	/* Too big to buffer. */
+	if (!trace_flushing && fwrite(s, len, 1, tracef) == 1) {
+	    tracef_size += len;
+	}
+	return;
+    }
+    if (trace_obuf == NULL) {
+	trace_obuf = Malloc(TRACE_OBUF_SIZE);
+    }
+    memcpy(trace_obuf + trace_obuf_len, s, len);
+    trace_obuf_len += len;
+    tracef_size += len;
+}
+
+/* Add text to the flight recorder. */
+static void
+frec_append(const char *s, size_t len)
+{
+    size_t n;
+
+    if (len > frec.size) {
+	/* Keep just the end. */
+	s += len - frec.size;
+	len = frec.size;
+    }
+    n = frec.size - frec.head;
+    if (n > len) {
+	n = len;
+    }
+    memcpy(frec.buf + frec.head, s, n);
+    if (len > n) {
+	memcpy(frec.buf, s + n, len - n);
+    }
+    frec.head += len;
+    if (frec.head >= frec.size) {
+	frec.head -= frec.size;
+	frec.wrapped = true;
+    }
+}
+
+/* Arrange for buffered trace file output to be written. */
+static void
+trace_schedule_flush(void)
+{
+    /* Standard output is shared, so keep it up to date. */
+    if (tracef == stdout) {
+	trace_flush();
+    } else if (trace_obuf_len && trace_flush_id == NULL_IOID) {
+	trace_flush_id = AddTimeOut(TRACE_FLUSH_MS, trace_flush_timeout);
+    }
+}
+
+/* Store a big-endian number. */
+static void
+put_be(unsigned char *buf, unsigned long long n, int len)
+{
+    while (len--) {
+	buf[len] = (unsigned char)(n & 0xff);
+	n >>= 8;
+    }
+}
+
+/* Add a record to a binary trace file. */
+static void
+trace_record(char type, const void *data, size_t len)
+{
+    unsigned char hdr[TRB_HDR_LEN];
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    hdr[0] = (unsigned char)type;
+    put_be(hdr + 1, (unsigned long long)tv.tv_sec, 8);
+    put_be(hdr + 9, (unsigned long long)tv.tv_usec, 4);
+    put_be(hdr + 13, (unsigned long long)len, 4);
+    trace_append((char *)hdr, TRB_HDR_LEN);
+    trace_append(data, len);
+}
+
+/*
+ * Record raw network data in a binary trace file.
+ * Does nothing if the trace file is not binary.
+ */
+void
+trace_netdata_record(char direction, unsigned const char *buf, size_t len)
+{
+    if (!toggled(TRACING) || tracef == NULL || !trace_binary ||
+	    !(trace_categories & TC_NET) || tracef_bufptr != NULL) {
+	return;
+    }
+    trace_record((direction == '<')? TRB_HOST: TRB_EMUL, buf, len);
+    trace_schedule_flush();
+}
+
+/* Add text to the trace file and to the flight recorder. */
+static void
+trace_output(const char *s, size_t len, bool to_file, bool to_frec)
+{
+    if (to_file) {
+	trace_append(s, len);
+    }
+    if (to_frec) {
+	frec_append(s, len);
+    }
 }
 
 /*
- * Write to the trace file, varargs style.
- * This is the only function that actually does output to the trace file --
- * all others are wrappers around this function.
+ * Write to the trace file and flight recorder, varargs style.
+ * This is the only function that actually does trace output -- all others
+ * are wrappers around this function.
+ *
+ * File output is buffered, and written out when the buffer fills, after
+ * TRACE_FLUSH_MS, or when tracing stops or the process exits.
  */
 static void
-vwtrace(bool do_ts, const char *fmt, va_list args)
+vwtrace(bool do_ts, unsigned category, const char *fmt, va_list args)
 {
-    size_t n2w_left, n2w, nw;
+    bool to_file = category? file_wants(category): tracef != NULL;
+    bool to_frec = (frec.categories & category) != 0;
+    va_list args_copy;
+    int len;
+    size_t n2w_left, n2w;
     char *ts;
-    char *buf = NULL;
     char *bp;
 
     /* Ugly hack to write into a memory buffer. */
@@ -324,51 +751,52 @@ vwtrace(bool do_ts, const char *fmt, va_list args)
 	return;
     }
 
-    if (tracef == NULL) {
+    if (!to_file && !to_frec) {
 	return;
     }
 
-    ts = NULL;
+    /* Format the message, growing the buffer if needed. */
+    if (trace_fbuf == NULL) {
+	trace_fbuf_size = TRACE_FBUF_SIZE;
+	trace_fbuf = Malloc(trace_fbuf_size);
+    }
+    va_copy(args_copy, args);
+    len = vsnprintf(trace_fbuf, trace_fbuf_size, fmt, args_copy);
+    va_end(args_copy);
+    if (len < 0) {
+	return;
+    }
+    if ((size_t)len >= trace_fbuf_size) {
+	trace_fbuf_size = len + 1;
+	Replace(trace_fbuf, Malloc(trace_fbuf_size));
+	vsnprintf(trace_fbuf, trace_fbuf_size, fmt, args);
+    }
 
-    buf = Vasprintf(fmt, args);
-    n2w_left = strlen(buf);
-    bp = buf;
+    /* Binary trace files get the text as one record, without timestamps. */
+    if (to_file && trace_binary) {
+	trace_record(do_ts? TRB_EVENT: TRB_TEXT, trace_fbuf, len);
+	to_file = false;
+    }
 
-    while (n2w_left > 0) {
+    /* Buffer it, with a timestamp at the start of each line. */
+    ts = NULL;
+    n2w_left = len;
+    bp = trace_fbuf;
+    while ((to_file || to_frec) && n2w_left > 0) {
 	char *nl;
-	bool wrote_nl = false;
 
 	if (do_ts && !wrote_ts) {
 	    if (ts == NULL) {
 		ts = gen_ts();
 	    }
-	    fwrite(ts, strlen(ts), 1, tracef);
-	    fflush(tracef);
+	    trace_output(ts, strlen(ts), to_file, to_frec);
 	    wrote_ts = true;
 	}
 
-	nl = strchr(bp, '\n');
+	nl = memchr(bp, '\n', n2w_left);
+	n2w = (nl != NULL)? (size_t)(nl - bp + 1): n2w_left;
+	trace_output(bp, n2w, to_file, to_frec);
 	if (nl != NULL) {
-	    wrote_nl = true;
-	    n2w = nl - bp + 1;
-	} else {
-	    n2w = n2w_left;
-	}
-
-	nw = fwrite(bp, n2w, 1, tracef);
-	if (nw == 1) {
-	    fflush(tracef);
-	} else {
-	    if (errno != EPIPE && !IS_EILSEQ(errno)) {
-		popup_an_errno(errno, "Write to trace file failed");
-	    }
-	    if (!IS_EILSEQ(errno)) {
-		stop_tracing();
-		goto done;
-	    }
-	}
-
-	if (wrote_nl) {
 	    wrote_ts = false;
 	}
 
@@ -376,24 +804,20 @@ vwtrace(bool do_ts, const char *fmt, va_list args)
 	n2w_left -= n2w;
     }
 
-    tracef_size = ftello(tracef);
-
-done:
-    if (buf != NULL) {
-	Free(buf);
+    if (tracef != NULL) {
+	trace_schedule_flush();
     }
-    return;
 }
 
 /* Write to the trace file. */
 static void
 wtrace(bool do_ts, const char *fmt, ...)
 {
-    if (tracef != NULL) {
+    if (tracef != NULL || tracef_bufptr != NULL) {
 	va_list args;
 
 	va_start(args, fmt);
-	vwtrace(do_ts, fmt, args);
+	vwtrace(do_ts, 0, fmt, args);
 	va_end(args);
     }
 }
@@ -401,10 +825,16 @@ wtrace(bool do_ts, const char *fmt, ...)
 static void
 stop_tracing(void)
 {
+    trace_flush();
+    trace_obuf_len = 0;
     if (tracef != NULL && tracef != stdout) {
 	fclose(tracef);
     }
     tracef = NULL;
+    trace_binary = false;
+#if !defined(_WIN32) /*[*/
+    trace_catch_fatal(false);
+#endif /*]*/
     if (toggled(TRACING)) {
 	toggle_toggle(TRACING);
 	menubar_retoggle(TRACING);
@@ -429,6 +859,10 @@ trace_rollover_check(void)
 
 	/* Close up this file. */
 	wtrace(true, "Trace rolled over\n");
+	trace_flush();
+	if (tracef == NULL) {
+	    return;
+	}
 	fclose(tracef);
 	tracef = NULL;
 
@@ -447,16 +881,20 @@ trace_rollover_check(void)
 	rename(tracefile_name, alt_filename);
 	Free(alt_filename);
 	alt_filename = NULL;
-	tracef = fopen(tracefile_name, "w");
+	tracef = fopen(tracefile_name, trace_binary? "wb": "w");
 	if (tracef == NULL) {
 	    popup_an_errno(errno, "%s", tracefile_name);
+	    trace_binary = false;
 	    return;
 	}
 
 	/* Initialize it. */
 	tracef_size = 0L;
-	SETLINEBUF(tracef);
-	new_header = create_tracefile_header("rolled over");
+	setvbuf(tracef, NULL, _IONBF, 0);
+	if (trace_binary) {
+	    trace_append(TRB_MAGIC, TRB_MAGIC_LEN);
+	}
+	new_header = create_tracefile_header("rolled over", true);
 	wtrace(false, new_header);
 	Free(new_header);
     }
@@ -464,9 +902,12 @@ trace_rollover_check(void)
 
 static int trace_reason;
 
-/* Create a trace file header. */
+/*
+ * Create a trace file header.
+ * If snap is true, include the TELNET state and the screen contents.
+ */
 static char *
-create_tracefile_header(const char *trace_mode)
+create_tracefile_header(const char *trace_mode, bool snap)
 {
     char *buf;
     int i;
@@ -532,6 +973,9 @@ create_tracefile_header(const char *trace_mode)
 	Free(setting);
     }
     wtrace(false, "\n");
+    if (snap && trace_categories != TC_ALL) {
+	wtrace(false, " Categories: %s\n", format_categories(trace_categories));
+    }
 
     if (HALF_CONNECTED) {
 	wtrace(false, " Connected to %s, port %u\n", current_host,
@@ -540,13 +984,13 @@ create_tracefile_header(const char *trace_mode)
     wtrace(false, " Connection state: %s\n", state_name[cstate]);
 
     /* Snap the current TELNET options. */
-    if (net_snap_options()) {
+    if (snap && net_snap_options()) {
 	wtrace(false, " TELNET state:\n");
 	trace_netdata('<', obuf, obptr - obuf);
     }
 
     /* Dump the screen contents and modes into the trace file. */
-    if (CONNECTED) {
+    if (snap && CONNECTED) {
 	/*
 	 * Note that if the screen is not formatted, we do not
 	 * attempt to save what's on it.  However, if we're in
@@ -613,13 +1057,47 @@ create_tracefile_header(const char *trace_mode)
     return buf;
 }
 
+/*
+ * Parse a size, which is a number optionally followed by K or M.
+ * Returns false if the size is zero or has the wrong syntax.
+ */
+static bool
+parse_size(const char *s, unsigned long *sizep)
+{
+    unsigned long size;
+    char *ptr;
+
+    size = strtoul(s, &ptr, 0);
+    if (size == 0 || ptr == s) {
+	return false;
+    }
+    switch (*ptr) {
+    case 'k':
+    case 'K':
+	size *= 1024;
+	ptr++;
+	break;
+    case 'm':
+    case 'M':
+	size *= 1024 * 1024;
+	ptr++;
+	break;
+    default:
+	break;
+    }
+    if (*ptr) {
+	return false;
+    }
+    *sizep = size;
+    return true;
+}
+
 /* Calculate the tracefile maximum size. */
 static void
 get_tracef_max(void)
 {
     static bool calculated = false;
-    char *ptr;
-    bool bad = false;
+    unsigned long size;
 
     if (calculated) {
 	return;
@@ -635,30 +1113,13 @@ get_tracef_max(void)
 	return;
     }
 
-    tracef_max = strtoul(appres.trace_file_size, &ptr, 0);
-    if (tracef_max == 0 || ptr == appres.trace_file_size || *(ptr + 1)) {
-	bad = true;
-    } else switch (*ptr) {
-    case 'k':
-    case 'K':
-	tracef_max *= 1024;
-	break;
-    case 'm':
-    case 'M':
-	tracef_max *= 1024 * 1024;
-	break;
-    case '\0':
-	break;
-    default:
-	bad = true;
-	break;
-    }
-
-    if (bad) {
+    if (!parse_size(appres.trace_file_size, &size)) {
 	tracef_max = MIN_TRACEFILE_SIZE;
 	trace_gui_bad_size(MIN_TRACEFILE_SIZE_NAME);
-    } else if (tracef_max < MIN_TRACEFILE_SIZE) {
+    } else if (size < MIN_TRACEFILE_SIZE) {
 	tracef_max = MIN_TRACEFILE_SIZE;
+    } else {
+	tracef_max = size;
     }
 }
 
@@ -780,6 +1241,9 @@ tracefile_ok(const char *tfn)
 	tracef = stdout;
     } else {
 	bool append = false;
+	bool binary = get_resource_bool(ResTraceBinary);
+
+	trace_categories_init();
 
 	if (!strcmp(stfn, "none") || !stfn[0]) {
 	    popup_an_error("Must specify a trace file name");
@@ -790,12 +1254,12 @@ tracefile_ok(const char *tfn)
 
 	/* Open and configure the file. */
 	if ((devfd = get_devfd(stfn)) >= 0)
-	    tracef = fdopen(dup(devfd), "a");
+	    tracef = fdopen(dup(devfd), binary? "ab": "a");
 	else if (!strncmp(stfn, ">>", 2)) {
 	    append = true;
-	    tracef = fopen(stfn + 2, "a");
+	    tracef = fopen(stfn + 2, binary? "ab": "a");
 	} else {
-	    tracef = fopen(stfn, "w");
+	    tracef = fopen(stfn, binary? "wb": "w");
 	}
 	if (tracef == NULL) {
 	    popup_an_errno(errno, "%s", stfn);
@@ -804,14 +1268,23 @@ tracefile_ok(const char *tfn)
 	}
 	tracef_size = ftello(tracef);
 	Replace(tracefile_name, NewString(append? stfn + 2: stfn));
-	SETLINEBUF(tracef);
+
+	/* Output is buffered by vwtrace(). */
+	setvbuf(tracef, NULL, _IONBF, 0);
 #if !defined(_WIN32) /*[*/
 	fcntl(fileno(tracef), F_SETFD, 1);
 #endif /*]*/
+
+	/* A new binary file starts with the magic string. */
+	trace_binary = binary;
+	if (binary && tracef_size <= 0) {
+	    trace_append(TRB_MAGIC, TRB_MAGIC_LEN);
+	}
     }
 
     /* Start the monitor window. */
-    if (tracef != stdout && appres.trace_monitor && product_has_display()) {
+    if (tracef != stdout && !trace_binary && appres.trace_monitor &&
+	    product_has_display()) {
 #if !defined(_WIN32) /*[*/
 	start_trace_window(stfn);
 #else /*][*/
@@ -823,12 +1296,17 @@ tracefile_ok(const char *tfn)
 
     Free(stfn);
 
+#if !defined(_WIN32) /*[*/
+    /* Write buffered output if the process crashes. */
+    trace_catch_fatal(true);
+#endif /*]*/
+
     /* We're really tracing, turn the flag on. */
     set_toggle(trace_reason, true);
     menubar_retoggle(trace_reason);
 
     /* Display current status. */
-    buf = create_tracefile_header("started");
+    buf = create_tracefile_header("started", true);
     wtrace(false, "%s", buf);
     Free(buf);
 done:
@@ -923,6 +1401,157 @@ trace_set_trace_file(const char *path)
     Replace(onetime_tracefile_name, NewString(path));
 }
 
+/* Set up the flight recorder from its resources. */
+static void
+frec_init(void)
+{
+    char *size_res;
+    char *cat_res;
+    unsigned long size;
+    unsigned categories;
+
+    frec.initted = true;
+
+    size_res = get_resource(ResFlightRecorder);
+    if (size_res == NULL || !strcmp(size_res, "0") ||
+	    !strcasecmp(size_res, "none")) {
+	return;
+    }
+    if (!parse_size(size_res, &size)) {
+	popup_an_error("Invalid %s: %s", ResFlightRecorder, size_res);
+	return;
+    }
+    if (size < MIN_FREC_SIZE) {
+	size = MIN_FREC_SIZE;
+    }
+
+    cat_res = get_resource(ResFlightRecorderCategories);
+    if (!parse_categories(ResFlightRecorderCategories,
+		cat_res? cat_res: FREC_DEFAULT_CATEGORIES, &categories)) {
+	return;
+    }
+
+    frec.buf = Malloc(size);
+    frec.size = size;
+    frec.head = 0;
+    frec.wrapped = false;
+    frec.categories = categories;
+}
+
+/* Returns true if the flight recorder is empty. */
+static bool
+frec_empty(void)
+{
+    return !frec.head && !frec.wrapped;
+}
+
+/* Write part of the flight recorder to a file. */
+static bool
+frec_write(FILE *f, const char *s, size_t len)
+{
+    return !len || fwrite(s, len, 1, f) == 1;
+}
+
+/*
+ * Write the flight recorder contents to a file and empty it.
+ * Uses the default file name if filename is NULL.
+ * Returns the name of the file, or NULL if it could not be written.
+ */
+static char *
+frec_dump(const char *reason, const char *filename)
+{
+    char *filename_buf = NULL;
+    char *path;
+    FILE *f;
+    char *header;
+    char *nl;
+    bool ok;
+
+    if (filename == NULL) {
+	filename = get_resource(ResFlightRecorderFile);
+    }
+    if (filename == NULL) {
+#if defined(_WIN32) /*[*/
+	filename = filename_buf = Asprintf("%s%sx3frec.$UNIQUE.txt",
+		appres.trace_dir? appres.trace_dir: default_trace_dir(),
+		appres.trace_dir? "\\": "");
+#else /*][*/
+	filename = filename_buf = Asprintf("%s/x3frec.$UNIQUE",
+		appres.trace_dir);
+#endif /*]*/
+    }
+    path = do_subst(filename, DS_VARS | DS_TILDE | DS_UNIQUE);
+    if (filename_buf != NULL) {
+	Free(filename_buf);
+    }
+    f = fopen(path, "w");
+    if (f == NULL) {
+	popup_an_errno(errno, "%s", path);
+	Free(path);
+	return NULL;
+    }
+
+    header = create_tracefile_header(
+	    txAsprintf("flight recorder dump (%s)", reason), false);
+    ok = fputs(header, f) != EOF;
+    Free(header);
+
+    /* Write the ring from the oldest data, skipping any partial line. */
+    if (frec.wrapped) {
+	nl = memchr(frec.buf + frec.head, '\n', frec.size - frec.head);
+	if (nl != NULL) {
+	    nl++;
+	    ok = ok && frec_write(f, nl, frec.buf + frec.size - nl) &&
+		frec_write(f, frec.buf, frec.head);
+	} else if ((nl = memchr(frec.buf, '\n', frec.head)) != NULL) {
+	    nl++;
+	    ok = ok && frec_write(f, nl, frec.buf + frec.head - nl);
+	}
+    } else {
+	ok = ok && frec_write(f, frec.buf, frec.head);
+    }
+    if (fclose(f) == EOF) {
+	ok = false;
+    }
+    if (!ok) {
+	popup_an_errno(errno, "%s", path);
+	Free(path);
+	return NULL;
+    }
+
+    frec.head = 0;
+    frec.wrapped = false;
+    return path;
+}
+
+/*
+ * Dump the flight recorder after an error or a host disconnect, if it is
+ * enabled and holds anything.
+ */
+void
+trace_flight_dump(const char *reason)
+{
+    char *path;
+
+    if (!frec.categories || frec_empty()) {
+	return;
+    }
+    path = frec_dump(reason, NULL);
+    if (path != NULL) {
+	vtrace("Flight recorder dumped to %s (%s)\n", path, reason);
+	Free(path);
+    }
+}
+
+/* Set up the flight recorder when the first connection starts. */
+static void
+frec_connect(bool ignored _is_unused)
+{
+    if (!frec.initted) {
+	frec_init();
+    }
+}
+
 static void
 toggle_tracing(toggle_index_t ix _is_unused, enum toggle_type tt)
 {
@@ -940,7 +1569,10 @@ toggle_tracing(toggle_index_t ix _is_unused, enum toggle_type tt)
     }
 }
 
-/* Trace([data|keyboard][on [filename]|off]) */
+/*
+ * Trace([data|keyboard][on [filename]|off]), Trace(dump [filename]),
+ * Trace(categories [category...])
+ */
 static bool
 Trace_action(ia_t ia, unsigned argc, const char **argv)
 {
@@ -959,6 +1591,62 @@ Trace_action(ia_t ia, unsigned argc, const char **argv)
 	return true;
     }
 
+    if (!strcasecmp(argv[0], KwDump)) {
+	char *path;
+
+	if (argc > 2) {
+	    popup_an_error(AnTrace "(): Too many arguments for '" KwDump "'");
+	    return false;
+	}
+	if (argc > 1 && appres.secure) {
+	    popup_an_error(AnTrace "(): Cannot specify filename in secure "
+		    "mode");
+	    return false;
+	}
+	if (!frec.initted) {
+	    frec_init();
+	}
+	if (!frec.categories) {
+	    popup_an_error(AnTrace "(): Flight recorder is not enabled");
+	    return false;
+	}
+	if (frec_empty()) {
+	    popup_an_error(AnTrace "(): Flight recorder is empty");
+	    return false;
+	}
+	path = frec_dump(AnTrace "()", (argc > 1)? argv[1]: NULL);
+	if (path == NULL) {
+	    return false;
+	}
+	action_output("Flight recorder dumped to %s.", path);
+	Free(path);
+	return true;
+    }
+
+    if (!strcasecmp(argv[0], KwCategories)) {
+	unsigned categories = 0;
+	unsigned i;
+
+	if (argc == 1) {
+	    trace_categories_init();
+	    action_output("%s", format_categories(trace_categories));
+	    return true;
+	}
+	for (i = 1; i < argc; i++) {
+	    unsigned c;
+
+	    if (!parse_categories(AnTrace "() category", argv[i], &c)) {
+		return false;
+	    }
+	    categories |= c;
+	}
+	trace_categories = categories;
+	trace_categories_set = true;
+	wtrace(true, "Trace categories set to %s\n",
+		format_categories(categories));
+	return true;
+    }
+
     if (!strcasecmp(argv[0], "Data") || !strcasecmp(argv[0], "Keyboard")) {
 	/* Skip. */
 	arg0++;
@@ -991,7 +1679,8 @@ Trace_action(ia_t ia, unsigned argc, const char **argv)
 	    return false;
 	}
     } else {
-	return action_args_are(AnTrace, KwOn, KwOff, NULL);
+	return action_args_are(AnTrace, KwOn, KwOff, KwDump, KwCategories,
+		NULL);
     }
 
     if ((on && !toggled(TRACING)) || (!on && toggled(TRACING))) {
@@ -1025,10 +1714,29 @@ trace_register(void)
 	  toggle_tracing,
 	  TOGGLE_NEED_INIT | TOGGLE_NEED_CLEANUP },
     };
+    static xres_t trace_xresources[] = {
+	{ ResFlightRecorder,		V_FLAT },
+	{ ResFlightRecorderCategories,	V_FLAT },
+	{ ResFlightRecorderFile,	V_FLAT },
+	{ ResTraceBinary,		V_FLAT },
+	{ ResTraceCategories,		V_FLAT },
+    };
 
     /* Register our actions. */
     register_actions(actions, array_count(actions));
 
     /* Register our toggles. */
     register_toggles(toggles, array_count(toggles));
+
+    /* Register our resources. */
+    register_xresources(trace_xresources, array_count(trace_xresources));
+
+    /* Register for state changes. */
+    register_schange(ST_CONNECT, frec_connect);
+
+    /* Make sure buffered output is written on exit. */
+#if !defined(_WIN32) /*[*/
+    trace_pid = getpid();
+#endif /*]*/
+    atexit(trace_atexit);
 }
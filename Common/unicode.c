@@ -364,6 +364,105 @@ cpalias_t cpaliases[] = {
 
 static uni_t *cur_uni = NULL;
 
+/*
+ * Unicode-to-EBCDIC reverse translation tables.
+ * These are two-level: the high-order byte of a UCS-2 code point selects a
+ * page of 256 EBCDIC codes, which is indexed by the low-order byte. Pages with
+ * no translations are NULL.
+ */
+#define RT_PAGES	256
+typedef struct {
+    unsigned char *page[RT_PAGES];
+} rev_table_t;
+
+static rev_table_t cur_rev;	/* reverse of cur_uni */
+static unsigned char asc2ebc[128]; /* ASCII subset of cur_rev */
+static rev_table_t apl_rev;	/* reverse of the APL (GE) code page */
+static bool apl_rev_built = false;
+
+static void mb_tables_clear(void);
+
+/* Add a translation to a reverse table, unless there is one already. */
+static void
+rev_add(rev_table_t *rt, ucs4_t u, unsigned char e)
+{
+    unsigned char **page;
+
+    if (u == 0 || u > 0xffff) {
+	return;
+    }
+    page = &rt->page[u >> 8];
+    if (*page == NULL) {
+	*page = (unsigned char *)Calloc(256, sizeof(unsigned char));
+    }
+    if ((*page)[u & 0xff] == 0) {
+	(*page)[u & 0xff] = e;
+    }
+}
+
+/* Look up a translation in a reverse table. Returns 0 if there is none. */
+static unsigned char
+rev_lookup(const rev_table_t *rt, ucs4_t u)
+{
+    const unsigned char *page;
+
+    if (u > 0xffff || (page = rt->page[u >> 8]) == NULL) {
+	return 0;
+    }
+    return page[u & 0xff];
+}
+
+/* Empty a reverse table. */
+static void
+rev_clear(rev_table_t *rt)
+{
+    int i;
+
+    for (i = 0; i < RT_PAGES; i++) {
+	Replace(rt->page[i], NULL);
+    }
+}
+
+/*
+ * Build the reverse table for the current code page.
+ * Where more than one EBCDIC code maps to the same Unicode character, the
+ * lowest one wins.
+ */
+static void
+build_cur_rev(void)
+{
+    int i;
+
+    rev_clear(&cur_rev);
+    for (i = 0; i < UT_SIZE; i++) {
+	rev_add(&cur_rev, cur_uni->code[i], UT_OFFSET + i);
+    }
+
+    /*
+     * Flatten the ASCII range, for bulk string translation. Characters that
+     * are not in the code page are left 0, and take the slow path.
+     */
+    for (i = 0; i < 128; i++) {
+	asc2ebc[i] = (i == 0x20)? 0x40: rev_lookup(&cur_rev, i);
+    }
+}
+
+/* Build the reverse table for the APL code page, which never changes. */
+static void
+build_apl_rev(void)
+{
+    ebc_t e;
+
+    for (e = 0x70; e <= 0xfe; e++) {
+	int u = apl_to_unicode(e, EUO_NONE);
+
+	if (u > 0) {
+	    rev_add(&apl_rev, (ucs4_t)u, (unsigned char)e);
+	}
+    }
+    apl_rev_built = true;
+}
+
 static void
 codepage_list_one(bool dbcs)
 {
@@ -508,7 +607,6 @@ ebcdic_base_to_unicode(ebc_t c, unsigned flags)
 ebc_t
 unicode_to_ebcdic(ucs4_t u)
 {
-    int i;
     ebc_t d;
 
     if (!u) {
@@ -518,10 +616,9 @@ unicode_to_ebcdic(ucs4_t u)
 	return 0x40;
     }
 
-    for (i = 0; i < UT_SIZE; i++) {
-	if (cur_uni->code[i] == u) {
-	    return UT_OFFSET + i;
-	}
+    d = rev_lookup(&cur_rev, u);
+    if (d) {
+	return d;
     }
     /* See if it's DBCS. */
     d = unicode_to_ebcdic_dbcs(u);
@@ -547,14 +644,10 @@ unicode_to_ebcdic_ge(ucs4_t u, bool *ge, bool prefer_apl)
     e_cur = unicode_to_ebcdic(u);
 
     /* Find the character in the APL code page. */
-    for (e_apl = 0x70; e_apl <= 0xfe; e_apl++) {
-	if ((ucs4_t)apl_to_unicode(e_apl, EUO_NONE) == u) {
-	    break;
-	}
-    }
-    if (e_apl > 0xfe) {
-	e_apl = 0;
+    if (!apl_rev_built) {
+	build_apl_rev();
     }
+    e_apl = rev_lookup(&apl_rev, u);
 
     if (e_apl != 0 && ((e_cur == 0) || prefer_apl)) {
 	*ge = true;
@@ -639,7 +732,10 @@ set_uni(const char *cpname, int local_cp _is_unused,
 	    continue;
 	}
 	if (!strcasecmp(realname, uni[i].name)) {
-	    cur_uni = &uni[i];
+	    if (cur_uni != &uni[i]) {
+		cur_uni = &uni[i];
+		build_cur_rev();
+	    }
 	    *host_codepage = uni[i].host_codepage;
 	    *cgcsgid = uni[i].cgcsgid;
 	    if (realnamep != NULL) {
@@ -702,6 +798,11 @@ set_uni(const char *cpname, int local_cp _is_unused,
     }
 #endif /*]*/
 
+    if (rc) {
+	/* The translations depend on the code page and the locale. */
+	mb_tables_clear();
+    }
+
     return rc;
 }
 
@@ -892,9 +993,11 @@ fail:
  *
  * Returns '?' in mb[] if there is no local multi-byte representation of
  * the EBCDIC character.
+ *
+ * This is the uncached version; see ebcdic_to_multibyte_x().
  */
-size_t
-ebcdic_to_multibyte_x(ebc_t ebc, unsigned char cs, char mb[],
+static size_t
+ebcdic_to_multibyte_local(ebc_t ebc, unsigned char cs, char mb[],
 	size_t mb_len, unsigned flags, ucs4_t *ucp)
 {
     ucs4_t uc;
@@ -1026,6 +1129,186 @@ ebcdic_to_multibyte_x(ebc_t ebc, unsigned char cs, char mb[],
 #endif /*]*/
 }
 
+/*
+ * ebcdic_to_multibyte_local with UTF-8 override, uncached.
+ */
+static size_t
+ebcdic_to_multibyte_compute(ebc_t ebc, unsigned char cs, char mb[],
+	size_t mb_len, unsigned flags, ucs4_t *ucp, bool force_utf8)
+{
+    if (force_utf8) {
+	ucs4_t ucs4;
+	int len;
+
+	if (mb_len < 7) {
+	    mb[0] = '\0';
+	    return 1;
+	}
+	ucs4 = ebcdic_to_unicode(ebc, cs, flags);
+	if (ucs4 == 0 && (flags & EUO_BLANK_UNDEF) != 0) {
+	    ucs4 = ' ';
+	}
+	*ucp = ucs4;
+	len = unicode_to_utf8(ucs4, mb);
+	if (len < 0) {
+	    len = 0;
+	}
+	mb[len++] = '\0';
+	return len;
+    } else {
+	return ebcdic_to_multibyte_local(ebc, cs, mb, mb_len, flags, ucp);
+    }
+}
+
+/*
+ * Single-byte EBCDIC-to-multibyte translation tables.
+ *
+ * Translating a character means mapping it to Unicode, optionally
+ * uppercasing it, and encoding it in the local multibyte representation. For
+ * single-byte characters the result depends only on the code page, the
+ * character set, the flags and the UTF-8 override, so the translations of all
+ * 256 codes are computed once for each combination in use and kept until the
+ * code page changes. Translating a character is then a table lookup and a
+ * copy.
+ */
+#define MBT_SLOTS	8	/* number of tables kept */
+#define MBT_MAX		16	/* longest sequence kept, including the NUL */
+#define MBT_CS_BASE	0	/* table character set: base */
+#define MBT_CS_APL	1	/* table character set: APL or GE */
+#define MBT_CS_OTHER	2	/* table character set: anything else */
+
+/* One translation. */
+typedef struct {
+    unsigned char len;		/* length returned, including the NUL */
+    char mb[MBT_MAX];		/* multibyte sequence */
+    ucs4_t uc;			/* Unicode value */
+} mb_entry_t;
+
+/* A table of translations. */
+typedef struct {
+    unsigned char cs_class;	/* character set, MBT_CS_xxx */
+    unsigned flags;		/* EUO_xxx flags */
+    bool force_utf8;		/* UTF-8 override */
+    bool is_utf8;		/* is_utf8 when computed */
+    mb_entry_t entry[256];	/* translations */
+} mb_table_t;
+
+static mb_table_t *mb_tables[MBT_SLOTS];
+static mb_table_t *mb_last_table;
+static int mb_next_slot;
+
+/* Discard the translation tables. */
+static void
+mb_tables_clear(void)
+{
+    int i;
+
+    for (i = 0; i < MBT_SLOTS; i++) {
+	Replace(mb_tables[i], NULL);
+    }
+    mb_last_table = NULL;
+    mb_next_slot = 0;
+}
+
+/* Map a character set to a table character set. */
+static unsigned char
+mb_cs_class(unsigned char cs)
+{
+    if ((cs & CS_GE) || ((cs & CS_MASK) == CS_APL)) {
+	return MBT_CS_APL;
+    }
+    return (cs == CS_BASE)? MBT_CS_BASE: MBT_CS_OTHER;
+}
+
+/*
+ * Find or build the translation table for a character set, set of flags and
+ * UTF-8 override.
+ */
+static mb_table_t *
+mb_table_get(unsigned char cs, unsigned flags, bool force_utf8)
+{
+    unsigned char cs_class = mb_cs_class(cs);
+    mb_table_t *t;
+    int i;
+
+    if ((t = mb_last_table) != NULL &&
+	    t->cs_class == cs_class &&
+	    t->flags == flags &&
+	    t->force_utf8 == force_utf8 &&
+	    t->is_utf8 == is_utf8) {
+	return t;
+    }
+
+    for (i = 0; i < MBT_SLOTS; i++) {
+	if ((t = mb_tables[i]) != NULL &&
+		t->cs_class == cs_class &&
+		t->flags == flags &&
+		t->force_utf8 == force_utf8 &&
+		t->is_utf8 == is_utf8) {
+	    mb_last_table = t;
+	    return t;
+	}
+    }
+
+    /* Build a new one, replacing the oldest if all of the slots are used. */
+    if (mb_tables[mb_next_slot] == NULL) {
+	mb_tables[mb_next_slot] = (mb_table_t *)Malloc(sizeof(mb_table_t));
+    }
+    t = mb_tables[mb_next_slot];
+    mb_next_slot = (mb_next_slot + 1) % MBT_SLOTS;
+    t->cs_class = cs_class;
+    t->flags = flags;
+    t->force_utf8 = force_utf8;
+    t->is_utf8 = is_utf8;
+    for (i = 0; i < 256; i++) {
+	mb_entry_t *e = &t->entry[i];
+
+	e->uc = 0;
+	e->len = (unsigned char)ebcdic_to_multibyte_compute((ebc_t)i, cs,
+		e->mb, sizeof(e->mb), flags, &e->uc, force_utf8);
+    }
+    mb_last_table = t;
+    return t;
+}
+
+/*
+ * Translate an EBCDIC character to the current locale's multi-byte
+ * representation, possibly forcing UTF-8, using the translation tables for
+ * single-byte characters.
+ */
+static size_t
+ebcdic_to_multibyte_cached(ebc_t ebc, unsigned char cs, char mb[],
+	size_t mb_len, unsigned flags, ucs4_t *ucp, bool force_utf8)
+{
+    mb_entry_t *e;
+
+    if (ebc & 0xff00) {
+	return ebcdic_to_multibyte_compute(ebc, cs, mb, mb_len, flags, ucp,
+		force_utf8);
+    }
+    e = &mb_table_get(cs, flags, force_utf8)->entry[ebc];
+    if (e->len > mb_len || (force_utf8 && mb_len < 7)) {
+	return ebcdic_to_multibyte_compute(ebc, cs, mb, mb_len, flags, ucp,
+		force_utf8);
+    }
+    if (ucp != NULL) {
+	*ucp = e->uc;
+    }
+    memcpy(mb, e->mb, e->len);
+    return e->len;
+}
+
+/*
+ * Translate an EBCDIC character to the current locale's multi-byte
+ * representation. See ebcdic_to_multibyte_local() for details.
+ */
+size_t
+ebcdic_to_multibyte_x(ebc_t ebc, unsigned char cs, char mb[],
+	size_t mb_len, unsigned flags, ucs4_t *ucp)
+{
+    return ebcdic_to_multibyte_cached(ebc, cs, mb, mb_len, flags, ucp, false);
+}
+
 /* Commonest version of ebcdic_to_multibyte_x:
  *  cs is CS_BASE
  *  EUO_BLANK_UNDEF is set
@@ -1057,28 +1340,8 @@ size_t
 ebcdic_to_multibyte_fx(ebc_t ebc, unsigned char cs, char mb[], size_t mb_len,
 	unsigned flags, ucs4_t *ucp, bool force_utf8)
 {
-    if (force_utf8) {
-	ucs4_t ucs4;
-	int len;
-
-	if (mb_len < 7) {
-	    mb[0] = '\0';
-	    return 1;
-	}
-	ucs4 = ebcdic_to_unicode(ebc, cs, flags);
-	if (ucs4 == 0 && (flags & EUO_BLANK_UNDEF) != 0) {
-	    ucs4 = ' ';
-	}
-	*ucp = ucs4;
-	len = unicode_to_utf8(ucs4, mb);
-	if (len < 0) {
-	    len = 0;
-	}
-	mb[len++] = '\0';
-	return len;
-    } else {
-	return ebcdic_to_multibyte_x(ebc, cs, mb, mb_len, flags, ucp);
-    }
+    return ebcdic_to_multibyte_cached(ebc, cs, mb, mb_len, flags, ucp,
+	    force_utf8);
 }
 
 /*
@@ -1090,12 +1353,25 @@ size_t
 ebcdic_to_multibyte_string(unsigned char *ebc, size_t ebc_len, char mb[],
 	size_t mb_len)
 {
+    mb_table_t *t = mb_table_get(CS_BASE, EUO_BLANK_UNDEF, false);
     size_t nmb = 0;
 
     while (ebc_len && mb_len) {
+	mb_entry_t *e = &t->entry[*ebc];
 	size_t xlen;
 
-	xlen = ebcdic_to_multibyte(*ebc, mb, mb_len);
+	if (e->len == 2 && mb_len >= 2) {
+	    /* Single-byte translation, the common case. */
+	    mb[0] = e->mb[0];
+	    mb[1] = '\0';
+	    xlen = 2;
+	} else if (e->len && e->len <= mb_len) {
+	    /* Copy the translation, including the NUL. */
+	    memcpy(mb, e->mb, e->len);
+	    xlen = e->len;
+	} else {
+	    xlen = ebcdic_to_multibyte(*ebc, mb, mb_len);
+	}
 	if (xlen) {
 	    mb += xlen - 1;
 	    mb_len -= (xlen - 1);
@@ -1276,12 +1552,32 @@ multibyte_to_unicode_string(const char *mb, size_t mb_len, ucs4_t *ucs4,
     int consumed;
     enum me_fail error;
     int nr = 0;
+    bool utf8 = is_utf8 || force_utf8;
 
     error = ME_NONE;
 
-    while (u_len && mb_len &&
-	    (*ucs4++ = multibyte_to_unicode_f(mb, mb_len, &consumed,
-					    &error, force_utf8)) != 0) {
+    while (u_len && mb_len) {
+	if (utf8) {
+	    /* Copy runs of ASCII directly. */
+	    size_t n = utf8_ascii_span(mb, (mb_len < u_len)? mb_len: u_len);
+
+	    if (n) {
+		size_t i;
+
+		for (i = 0; i < n; i++) {
+		    *ucs4++ = (unsigned char)mb[i];
+		}
+		u_len -= n;
+		mb += n;
+		mb_len -= n;
+		nr += (int)n;
+		continue;
+	    }
+	}
+	if ((*ucs4++ = multibyte_to_unicode_f(mb, mb_len, &consumed, &error,
+			force_utf8)) == 0) {
+	    break;
+	}
 	u_len--;
 	mb += consumed;
 	mb_len -= consumed;
@@ -1333,6 +1629,32 @@ multibyte_to_ebcdic_string(const char *mb, size_t mb_len, unsigned char *ebc,
 	ebc_t e;
 	int consumed;
 
+	if (is_utf8 && !in_dbcs) {
+	    /*
+	     * Translate runs of ASCII through the flattened table, stopping at
+	     * anything the code page does not have.
+	     */
+	    size_t n = utf8_ascii_span(mb, (mb_len < ebc_len)? mb_len: ebc_len);
+	    size_t i;
+
+	    for (i = 0; i < n; i++) {
+		unsigned char c = asc2ebc[(unsigned char)mb[i]];
+
+		if (c == 0) {
+		    break;
+		}
+		ebc[i] = c;
+	    }
+	    if (i) {
+		ebc += i;
+		ebc_len -= i;
+		ne += i;
+		mb += i;
+		mb_len -= i;
+		continue;
+	    }
+	}
+
 	e = multibyte_to_ebcdic(mb, mb_len, &consumed, errorp);
 	if (e == 0) {
 	    return -1;
@@ -272,3 +272,34 @@ utf8_to_unicode(const char *utf8, size_t len, ucs4_t *ucs4)
 
     return -3;
 }
+
+/* Word masks for utf8_ascii_span(). */
+#define ASCII_ONES	((uint64_t)0x0101010101010101ULL)
+#define ASCII_HIGHS	((uint64_t)0x8080808080808080ULL)
+
+/*
+ * Return the number of ASCII characters (U+0001 through U+007F) at the start
+ * of a UTF-8 string. These translate to themselves, so callers can copy
+ * them without decoding. The string is examined a word at a time until a word
+ * with a NUL or a byte with the high-order bit set is found.
+ */
+size_t
+utf8_ascii_span(const char *utf8, size_t len)
+{
+    size_t n = 0;
+
+    while (len - n >= sizeof(uint64_t)) {
+	uint64_t w;
+
+	memcpy(&w, utf8 + n, sizeof(w));
+	if (((w | ((w - ASCII_ONES) & ~w)) & ASCII_HIGHS) != 0) {
+	    /* Non-ASCII or NUL somewhere in this word. */
+	    break;
+	}
+	n += sizeof(w);
+    }
+    while (n < len && (unsigned char)(utf8[n] - 1) < 0x7f) {
+	n++;
+    }
+    return n;
+}
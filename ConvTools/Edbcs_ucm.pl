@@ -1,91 +1,102 @@
 #!/usr/bin/perl
-# Grab the DBCS part of a DBCS or MBCS ucm file and output DBCS translation
+# Grab the DBCS part of DBCS or MBCS ucm files and output DBCS translation
 # tables.
+#
+# Usage: Edbcs_ucm.pl ucm-name c-prefix [ucm-name c-prefix...]
+#
+# Each table is two-level: an index of 512 row numbers, selected by the upper
+# 9 bits of a code, and a 128-entry row, indexed by the lower 7 bits. The rows
+# for all of the tables are kept in one array, dbcs_rows. Row 0 is all zeroes,
+# and identical rows are stored once.
 
-my $file = $ARGV[0];
-my $in = 0;
-my %d2u;
-my %u2d;
-open TABLE, "<". $file . ".ucm" or die "No table.";
-while (<TABLE>) {
-    chomp;
-    next if /^#/;
-    last if /^END CHARMAP/;
-    if (/^CHARMAP/) {
-	$in = 1;
-	next;
-    }
-    next if (! $in);
-    # <U0020> \x20 #|0 SPACE
-    if (/<U([0-9a-fA-F]+)> +\\x([0-9a-fA-F]+)\\x([0-9a-fA-F]+)/) {
-	my $u = hex($1);
-	my $d = hex($2 . $3);
-	#printf "got U+%04x -> X'%02X'\n", $u, $d;
-	$d2u{$d} = $u;
-	$u2d{$u} = $d;
-    } elsif (/<U([0-9a-fA-F]+)> +\\x([0-9a-fA-F]+)/) {
-    } else {
-	die "Eh?";
-    }
-}
+my @rows = ("");
+my @first = ("empty");
+my %row_num = ("" => 0);
+my $indices = "";
 
-print "/* Unicode to EBCDIC DBCS translation table for $file */\n";
-my $row = "";
-my $i;
-my $any = 0;
-foreach $i (0..65535) {
-    if ($i && !($i % 128)) {
-	printf "/* %04x */ ", $i - 128;
-	if ($any) {
-	    print "\"$row\",\n";
-	} else {
-	    print "NULL,\n";
+die "Usage: $0 ucm-name c-prefix [ucm-name c-prefix...]\n"
+    if (!@ARGV || (@ARGV % 2));
+
+# Add a table to the rows and the indices.
+sub table {
+    my ($title, $file, $name, $map) = @_;
+    my @ix;
+    my ($r, $i);
+
+    # Split the map into rows, sharing identical ones.
+    foreach $r (0..511) {
+	my $row = "";
+	my $any = 0;
+
+	foreach $i (0..127) {
+	    my $v = $map->{($r * 128) + $i} || 0;
+
+	    $row .= sprintf("\t0x%04x,", $v) if (!($i % 8));
+	    $row .= sprintf(" 0x%04x,", $v) if ($i % 8);
+	    $row .= "\n" if (($i % 8) == 7);
+	    $any = 1 if ($v);
 	}
-	$row = "";
-	$any = 0;
+	$row = "" if (!$any);
+	if (!defined($row_num{$row})) {
+	    $row_num{$row} = scalar(@rows);
+	    push @rows, $row;
+	    push @first, sprintf("%s %04x", $name, $r * 128);
+	}
+	push @ix, $row_num{$row};
     }
-    if ($u2d{$i}) {
-	$row .= sprintf("\\x%02x\\x%02x",
-	    ($u2d{$i} >> 8) & 0xff, $u2d{$i} & 0xff);
-	$any = 1;
-    } else {
-	$row .= "\\x00\\x00";
+
+    $indices .= "/* $title translation table for $file */\n";
+    $indices .= "static const uint16_t ${name}_ix[512] = {\n";
+    foreach $r (0..511) {
+	$indices .= "\t" if (!($r % 8));
+	$indices .= $ix[$r] . ",";
+	$indices .= (($r % 8) == 7)? "\n": " ";
     }
+    $indices .= "};\n";
 }
-print "/* ff80 */ ";
-if ($any) {
-    print "\"$row\"";
-} else {
-    print "NULL";
-}
-print " };\n";
 
-print "/* EBCDIC DBCS to Unicode translation table for $file */\n";
-$row = "";
-$any = 0;
-foreach $i (0..65535) {
-    if ($i && !($i % 128)) {
-	printf "/* %04x */ ", $i - 128;
-	if ($any) {
-	    print "\"$row\",\n";
+while (@ARGV) {
+    my $file = shift;
+    my $prefix = shift;
+    my $in = 0;
+    my %d2u;
+    my %u2d;
+
+    open TABLE, "<". $file . ".ucm" or die "No table.";
+    while (<TABLE>) {
+	chomp;
+	next if /^#/;
+	last if /^END CHARMAP/;
+	if (/^CHARMAP/) {
+	    $in = 1;
+	    next;
+	}
+	next if (! $in);
+	# <U0020> \x20 #|0 SPACE
+	if (/<U([0-9a-fA-F]+)> +\\x([0-9a-fA-F]+)\\x([0-9a-fA-F]+)/) {
+	    my $u = hex($1);
+	    my $d = hex($2 . $3);
+	    #printf "got U+%04x -> X'%02X'\n", $u, $d;
+	    # The tables hold 16-bit values, so only the BMP can be translated.
+	    next if ($u > 0xffff);
+	    $d2u{$d} = $u;
+	    $u2d{$u} = $d;
+	} elsif (/<U([0-9a-fA-F]+)> +\\x([0-9a-fA-F]+)/) {
 	} else {
-	    print "NULL,\n";
+	    die "Eh?";
 	}
-	$row = "";
-	$any = 0;
-    }
-    if ($d2u{$i}) {
-	$row .= sprintf("\\x%02x\\x%02x",
-	    ($d2u{$i} >> 8) & 0xff, $d2u{$i} & 0xff);
-	$any = 1;
-    } else {
-	$row .= "\\x00\\x00";
     }
+    close TABLE;
+
+    table("Unicode to EBCDIC DBCS", $file, "${prefix}_u2ebc", \%u2d);
+    table("EBCDIC DBCS to Unicode", $file, "${prefix}_ebc2u", \%d2u);
 }
-print "/* ff80 */ ";
-if ($any) {
-    print "\"$row\"";
-} else {
-    print "NULL";
+
+print "/* DBCS translation table rows */\n";
+print "static const uint16_t dbcs_rows[][128] = {\n";
+print "/* 0: empty */ { 0 },\n";
+foreach my $r (1..$#rows) {
+    print "/* $r: $first[$r] */ {\n$rows[$r]},\n";
 }
-print " };\n";
+print "};\n\n";
+print $indices;
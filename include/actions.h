@@ -49,6 +49,7 @@ typedef struct action_elt {
 
 extern llist_t actions_list;
 extern unsigned actions_list_count;
+extern unsigned actions_generation;
 
 extern const char       *ia_name[];
 
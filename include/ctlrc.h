@@ -44,11 +44,17 @@ extern bool screen_alt;
 extern bool screen_changed;
 extern int first_changed;
 extern int last_changed;
+extern unsigned long ctlr_generation;
+extern unsigned long *ctlr_row_generation;
 
 bool check_rows_cols(int mn, unsigned ovc, unsigned ovr);
 void ctlr_aclear(int baddr, int count, int clear_ea);
 void ctlr_add(int baddr, unsigned char c, unsigned char cs);
 void ctlr_add_nvt(int baddr, ucs4_t ucs4, unsigned char cs);
+void ctlr_add_nvt_run(int baddr, const unsigned char *c, int count,
+	unsigned char gr, unsigned char fg, unsigned char bg);
+void ctlr_add_run(int baddr, const unsigned char *c, const unsigned char *cs,
+	int count);
 void ctlr_add_bg(int baddr, unsigned char color);
 void ctlr_add_cs(int baddr, unsigned char cs);
 void ctlr_add_fa(int baddr, unsigned char fa, unsigned char cs);
@@ -81,6 +81,7 @@ typedef struct {
     int windows_codepage;
 #endif /*]*/
     char *other_options;
+    char *checkpoint_file;
 
     /* Invocation state. */
     bool is_action;
@@ -106,7 +107,23 @@ typedef struct {
 	FT_DBCS_LEFT
     } dbcs_state;
     unsigned char dbcs_byte1;
+    unsigned char *inbuf;	/* upload input block */
+    size_t inbuf_len;		/* bytes in inbuf */
+    size_t inbuf_ix;		/* next byte to read from inbuf */
+    short ascii_remap[128];	/* upload translation of single-byte ASCII
+				   characters, -1 if not single-byte */
+    FILE *checkpoint;		/* checkpoint file, or NULL */
+    char *checkpoint_header;	/* identifies the transfer in checkpoint */
+    unsigned long long restart_bytes; /* bytes the host already has */
+    unsigned long restart_records; /* records the host already has */
 } ft_tstate_t;
 extern ft_tstate_t fts;
 
+int ft_fill_getc(void);
+void ft_checkpoint(unsigned long long bytes, unsigned long records);
+
+/* Get the next byte of the local file for an upload, or EOF. */
+#define ft_getc() \
+    ((fts.inbuf_ix < fts.inbuf_len)? fts.inbuf[fts.inbuf_ix++]: ft_fill_getc())
+
 #define __FT_PRIVATE_H
@@ -39,6 +39,9 @@
 #if defined(HAVE_VASPRINTF) && !defined(_GNU_SOURCE) /*[*/
 #define _GNU_SOURCE		/* vasprintf isn't POSIX */
 #endif /*]*/
+#if defined(HAVE_GETADDRINFO_A) && !defined(_GNU_SOURCE) /*[*/
+#define _GNU_SOURCE		/* getaddrinfo_a isn't POSIX */
+#endif /*]*/
 
 /*
  * OS-specific #defines.  Except for the blocking-connect workarounds, these
@@ -419,7 +422,7 @@ enum keytype { KT_STD, KT_GE };
 # define DFT_BUF	16384
 #endif /*]*/
 #define DFT_MIN_BUF	256
-#define DFT_MAX_BUF	32767
+#define DFT_MAX_BUF	65535	/* DDM INLIM/OUTLIM are 16-bit fields */
 
 /* DBCS Preedit Types */
 #define PT_ROOT		"Root"
@@ -197,6 +197,7 @@
 #define KwCopyright	"Copyright"
 #define KwCursor	"Cursor"
 #define KwCursor1	"Cursor1"
+#define KwFileTransfer	"FileTransfer"
 #define KwFormatted	"Formatted"
 #define KwHost		"Host"
 #define KwKeymap	"Keymap"
@@ -226,6 +227,7 @@
 #define KwTlsProvider	"TlsProvider"
 #define KwTlsSessionInfo "TlsSessionInfo"
 #define KwTlsSubjectNames "TlsSubjectNames"
+#define KwTypeahead	"Typeahead"
 #define KwVersion	"Version"
 /*  Parameters to Quit(). */
 #define KwDashForce	"-force"
@@ -252,6 +254,9 @@
 #define KwNoDialog	"nodialog"
 #define KwWindowId	"WindowId"
 #define KwWordPad	"wordpad"
+/*  Parameters to Trace(). */
+#define KwCategories	"categories"
+#define KwDump		"dump"
 /*  Parameters to Script(). */
 #define KwDashAsync	"-async"
 #define KwDashNoLock	"-nolock"
@@ -102,6 +102,9 @@
 #define ResErase		"erase"
 #define ResExtendedDataStream	"extendedDataStream"
 #define ResFixedSize		"fixedSize"
+#define ResFlightRecorder	"flightRecorder"
+#define ResFlightRecorderCategories "flightRecorderCategories"
+#define ResFlightRecorderFile	"flightRecorderFile"
 #define ResFtAllocation		"ftAllocation"
 #define ResFtAvblock		"ftAvblock"
 #define ResFtBlksize		"ftBlksize"
@@ -235,6 +238,8 @@
 #define ResTlsMinProtocol	"tlsMinProtocol"
 #define ResTlsSecurityLevel	"tlsSecurityLevel"
 #define ResTrace		"trace"
+#define ResTraceBinary		"traceBinary"
+#define ResTraceCategories	"traceCategories"
 #define ResTraceDir		"traceDir"
 #define ResTraceFile		"traceFile"
 #define ResTraceFileSize	"traceFileSize"
@@ -35,6 +35,17 @@ typedef enum {
     TSS_PRINTER	/* trace to printer */
 } tss_t;
 
+/* Trace categories, for the trace file and the flight recorder. */
+#define TC_DS		0x1	/* data stream (trace_ds) */
+#define TC_NET		0x2	/* network data (ntvtrace) */
+#define TC_EVENT	0x4	/* other events (vtrace) */
+#define TC_TELNET	0x8	/* TELNET negotiation */
+#define TC_SCRIPT	0x10	/* scripts and macros */
+#define TC_HTTPD	0x20	/* HTTP server */
+#define TC_SCHED	0x40	/* task scheduler */
+#define TC_EVENTS	(TC_EVENT | TC_TELNET | TC_SCRIPT | TC_HTTPD | TC_SCHED)
+#define TC_ALL		(TC_DS | TC_NET | TC_EVENTS)
+
 extern bool trace_skipping;
 extern char *tracefile_name;
 extern struct timeval ds_ts;
@@ -42,8 +53,13 @@ extern struct timeval ds_ts;
 const char *rcba(int baddr);
 void trace_ds(const char *fmt, ...) printflike(1, 2);
 void vtrace(const char *fmt, ...) printflike(1, 2);
+void vctrace(unsigned category, const char *fmt, ...) printflike(2, 3);
 void ntvtrace(const char *fmt, ...) printflike(1, 2);
 void trace_set_trace_file(const char *path);
+bool trace_on(unsigned category);
+void trace_netdata_record(char direction, unsigned const char *buf,
+	size_t len);
+void trace_flight_dump(const char *reason);
 void trace_rollover_check(void);
 void tracefile_ok(const char *tfn);
 #if defined(_WIN32) /*[*/
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2025 Paul Mattes.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the names of Paul Mattes nor the names of his contributors
+ *       may be used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ *	trace_binary.h
+ *		Binary trace file format.
+ *
+ * A binary trace file starts with TRB_MAGIC, followed by records. Each
+ * record has a TRB_HDR_LEN-byte header -- the record type, the time in
+ * seconds (8 bytes) and microseconds (4 bytes), and the length of the data
+ * (4 bytes), all big-endian -- followed by the data.
+ */
+
+#define TRB_MAGIC	"x3270 binary trace 1\n"
+#define TRB_MAGIC_LEN	(sizeof(TRB_MAGIC) - 1)
+
+#define TRB_HDR_LEN	17
+
+/* Record types. */
+#define TRB_HOST	'<'	/* network data from the host */
+#define TRB_EMUL	'>'	/* network data from the emulator */
+#define TRB_EVENT	'e'	/* event text, timestamped at each line start */
+#define TRB_TEXT	't'	/* text without timestamps */
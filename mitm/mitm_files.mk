@@ -1,2 +1,2 @@
 # mitm-specific object files
-MITM_OBJECTS = mitm.o
+MITM_OBJECTS = Malloc.o mitm.o
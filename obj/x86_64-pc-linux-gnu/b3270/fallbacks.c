@@ -0,0 +1,111 @@
+/* This file was created automatically by mkfb. */
+
+#include "globals.h"
+#include "fallbacks.h"
+static unsigned char fsd[] = {
+109,101,115,115, 97,103,101, 46,102,116, 67,111,109,112,108,101,116,101, 58,
+ 32, 84,114, 97,110,115,102,101,114, 32, 99,111,109,112,108,101,116,101, 44,
+ 32, 37,105, 32, 98,121,116,101,115, 32,116,114, 97,110,115,102,101,114,114,
+101,100, 10, 37,115, 98,121,116,101,115, 47,115,101, 99, 32,105,110, 32, 37,
+115, 32,109,111,100,101,  0,109,101,115,115, 97,103,101, 46,102,116, 85,110,
+ 97, 98,108,101, 58, 32, 67, 97,110,110,111,116, 32, 98,101,103,105,110, 32,
+116,114, 97,110,115,102,101,114,  0,109,101,115,115, 97,103,101, 46,102,116,
+ 83,116, 97,114,116, 84,105,109,101,111,117,116, 58, 32, 84,114, 97,110,115,
+102,101,114, 32,100,105,100, 32,110,111,116, 32,115,116, 97,114,116, 32,119,
+105,116,104,105,110, 32, 51, 48,115,  0,109,101,115,115, 97,103,101, 46,102,
+116, 85,115,101,114, 67, 97,110, 99,101,108, 58, 32, 84,114, 97,110,115,102,
+101,114, 32, 99, 97,110, 99,101,108,101,100, 32, 98,121, 32,117,115,101,114,
+  0,109,101,115,115, 97,103,101, 46,102,116, 72,111,115,116, 67, 97,110, 99,
+101,108, 58, 32, 84,114, 97,110,115,102,101,114, 32, 99, 97,110, 99,101,108,
+101,100, 32, 98,121, 32,104,111,115,116,  0,109,101,115,115, 97,103,101, 46,
+102,116, 67,117,116, 85,110,107,110,111,119,110, 70,114, 97,109,101, 58, 32,
+ 85,110,107,110,111,119,110, 32,102,114, 97,109,101, 32,116,121,112,101, 32,
+102,114,111,109, 32,104,111,115,116,  0,109,101,115,115, 97,103,101, 46,102,
+116, 67,117,116, 85,110,107,110,111,119,110, 67,111,110,116,114,111,108, 58,
+ 32, 85,110,107,110,111,119,110, 32, 70, 84, 32, 99,111,110,116,114,111,108,
+ 32, 99,111,100,101, 32,102,114,111,109, 32,104,111,115,116,  0,109,101,115,
+115, 97,103,101, 46,102,116, 67,117,116, 82,101,116,114, 97,110,115,109,105,
+116, 58, 32, 84,114, 97,110,115,109,105,115,115,105,111,110, 32,101,114,114,
+111,114,  0,109,101,115,115, 97,103,101, 46,102,116, 67,117,116, 67,111,110,
+118,101,114,115,105,111,110, 69,114,114,111,114, 58, 32, 68, 97,116, 97, 32,
+ 99,111,110,118,101,114,115,105,111,110, 32,101,114,114,111,114,  0,109,101,
+115,115, 97,103,101, 46,102,116, 67,117,116, 79,118,101,114,115,105,122,101,
+ 58, 32, 73,108,108,101,103, 97,108, 32,102,114, 97,109,101, 32,108,101,110,
+103,116,104,  0,109,101,115,115, 97,103,101, 46,102,116, 67,117,116, 78,111,
+ 82,101,115,116, 97,114,116, 58, 32, 67, 97,110,110,111,116, 32,114,101,115,
+117,109,101, 32, 97, 32,116,114, 97,110,115,102,101,114, 32,105,110, 32, 67,
+ 85, 84, 32,109,111,100,101,  0,109,101,115,115, 97,103,101, 46,102,116, 68,
+105,115, 99,111,110,110,101, 99,116,101,100, 58, 32, 72,111,115,116, 32,100,
+105,115, 99,111,110,110,101, 99,116,101,100, 44, 32,116,114, 97,110,115,102,
+101,114, 32, 99, 97,110, 99,101,108,101,100,  0,109,101,115,115, 97,103,101,
+ 46,102,116, 78,111,116, 51, 50, 55, 48, 58, 32, 78,111,116, 32,105,110, 32,
+ 51, 50, 55, 48, 32,109,111,100,101, 44, 32,116,114, 97,110,115,102,101,114,
+ 32, 99, 97,110, 99,101,108,101,100,  0,109,101,115,115, 97,103,101, 46,102,
+116, 68,102,116, 85,110,107,110,111,119,110, 79,112,101,110, 58, 32, 85,110,
+107,110,111,119,110, 32, 68, 70, 84, 32, 79,112,101,110, 32,116,121,112,101,
+ 32,102,114,111,109, 32,104,111,115,116,  0,109,101,115,115, 97,103,101, 46,
+102,116, 68,102,116, 82,101,115,116, 97,114,116, 83,104,111,114,116, 58, 32,
+ 76,111, 99, 97,108, 32,102,105,108,101, 32,105,115, 32,115,104,111,114,116,
+101,114, 32,116,104, 97,110, 32,116,104,101, 32, 99,104,101, 99,107,112,111,
+105,110,116,  0,109,101,115,115, 97,103,101, 46,102,116, 85,110, 97, 98,108,
+101, 76,111, 99,107,101,100, 58, 32,107,101,121, 98,111, 97,114,100, 32,108,
+111, 99,107,101,100,  0,109,101,115,115, 97,103,101, 46,102,116, 85,110, 97,
+ 98,108,101, 78,111,116, 51, 50, 55, 48, 58, 32,110,111,116, 32,105,110, 32,
+ 51, 50, 55, 48, 32,109,111,100,101,  0,109,101,115,115, 97,103,101, 46,102,
+116, 85,110, 97, 98,108,101, 78,111, 70,105,101,108,100, 58, 32,110,111, 32,
+105,110,112,117,116, 32,102,105,101,108,100,  0,109,101,115,115, 97,103,101,
+ 46,102,116, 85,110, 97, 98,108,101, 84,111,111, 83,109, 97,108,108, 58, 32,
+105,110,112,117,116, 32,102,105,101,108,100, 32,116,111,111, 32,115,109, 97,
+108,108,  0,112,114,105,110,116, 84,101,120,116, 67,111,109,109, 97,110,100,
+ 58, 32,108,112,114, 32, 45, 74, 32, 34, 37, 69, 37, 32,115, 99,114,101,101,
+110, 34,  0,112,114,105,110,116,101,114, 46, 99,111,109,109, 97,110,100, 58,
+ 32,108,112,114,  0,112,114,105,110,116,101,114, 46, 97,115,115,111, 99, 67,
+111,109,109, 97,110,100, 76,105,110,101, 58, 32,112,114, 51, 50, 56, 55, 32,
+ 45, 97,115,115,111, 99, 32, 37, 76, 37, 32, 45, 99,111,109,109, 97,110,100,
+ 32, 34, 37, 67, 37, 34, 32, 37, 82, 37, 32, 37, 80, 37, 32, 37, 86, 37, 32,
+ 37, 83, 37, 32, 37, 79, 37, 32, 34, 37, 72, 37, 34,  0,112,114,105,110,116,
+101,114, 46,108,117, 67,111,109,109, 97,110,100, 76,105,110,101, 58, 32,112,
+114, 51, 50, 56, 55, 32, 45, 99,111,109,109, 97,110,100, 32, 34, 37, 67, 37,
+ 34, 32, 37, 82, 37, 32, 37, 80, 37, 32, 37, 86, 37, 32, 37, 83, 37, 32, 37,
+ 79, 37, 32, 34, 37, 76, 37, 64, 37, 72, 37, 34,  0,};
+
+char *fallbacks[24] = {
+	(char *)&fsd[0], /* line 31 */
+	(char *)&fsd[83], /* line 33 */
+	(char *)&fsd[123], /* line 34 */
+	(char *)&fsd[181], /* line 35 */
+	(char *)&fsd[229], /* line 36 */
+	(char *)&fsd[277], /* line 37 */
+	(char *)&fsd[333], /* line 38 */
+	(char *)&fsd[396], /* line 39 */
+	(char *)&fsd[440], /* line 40 */
+	(char *)&fsd[492], /* line 41 */
+	(char *)&fsd[536], /* line 42 */
+	(char *)&fsd[597], /* line 43 */
+	(char *)&fsd[658], /* line 44 */
+	(char *)&fsd[713], /* line 45 */
+	(char *)&fsd[771], /* line 46 */
+	(char *)&fsd[840], /* line 48 */
+	(char *)&fsd[880], /* line 49 */
+	(char *)&fsd[922], /* line 50 */
+	(char *)&fsd[962], /* line 51 */
+	(char *)&fsd[1010], /* line 79 */
+	(char *)&fsd[1048], /* line 85 */
+	(char *)&fsd[1069], /* line 86 */
+	(char *)&fsd[1154], /* line 87 */
+	NULL
+};
+
+#if defined(DEBUG) /*[*/
+#include <stdio.h>
+int
+main(int argc, char *argv[])
+{
+    int i;
+
+    for (i = 0; fallbacks[i] != NULL; i++) {
+	printf("%d: %s\n", i, fallbacks[i]);
+    }
+    return 0;
+}
+#endif /*]*/
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 data stream processing benchmarks
+
+import glob
+import os
+import sys
+import unittest
+from subprocess import Popen, PIPE
+import Common.Test.cti as cti
+
+# Minimum time to spend on each trace file, in seconds.
+bench_time = os.environ.get('BENCH_DS_TIME', '0.25')
+
+class BenchS3270DataStream(cti.cti):
+
+    # Benchmark the 3270 and NVT data stream processors over the test traces.
+    def test_s3270_bench_data_stream(self):
+
+        traces = sorted(glob.glob('s3270/Test/*.trc')) + sorted(glob.glob('b3270/Test/*.trc'))
+        bench = Popen(['ds_bench', '-t', bench_time] + traces, stdout=PIPE,
+            stderr=PIPE)
+        self.children.append(bench)
+        out, _ = bench.communicate()
+        self.assertEqual(0, bench.wait())
+        lines = out.decode().splitlines()
+        self.assertTrue(lines[-1].startswith('Total:'), lines[-1])
+        print('\n' + '\n'.join(lines), file=sys.stderr)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 DFT file transfer benchmarks
+
+import os
+import sys
+import tempfile
+import threading
+import time
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import Common.Test.cti as cti
+from Common.Test.dfthost import DftHost
+
+# Size of the file to transfer, in bytes.
+file_size = int(os.environ.get('BENCH_FT_SIZE', str(16 * 1024 * 1024)))
+
+# DFT buffer sizes to try.
+buffer_sizes = [4096, 16384, 32767, 65535]
+
+class BenchS3270Ft(cti.cti):
+
+    # Run a transfer and report its throughput.
+    def transfer(self, s3270: Popen, action: str, size: int, host_fn):
+        cpu_start = cti.cpu_time(s3270.pid)
+        wall_start = time.monotonic()
+        s3270.stdin.write(f'{action}\n'.encode())
+        s3270.stdin.flush()
+        host_fn()
+        output = []
+        while True:
+            line = s3270.stdout.readline().decode().rstrip('\n')
+            self.assertNotEqual('', line, 's3270 exited unexpectedly')
+            if line in ['ok', 'error']:
+                break
+            output.append(line)
+        wall = time.monotonic() - wall_start
+        cpu_end = cti.cpu_time(s3270.pid)
+        self.assertEqual('ok', line, f'{action} failed: {output}')
+        self.assertTrue(output[0].startswith('data: Transfer complete'), output[0])
+        cpu_text = f', s3270 CPU {(cpu_end - cpu_start) * 1e9 / size:.1f} ns/byte' if cpu_start is not None and cpu_end is not None else ''
+        print(f'\n{action}: {size / wall / 1e6:.1f} MB/s{cpu_text}', file=sys.stderr)
+
+    # Upload a file and download it again with each buffer size, checking
+    # that it survives the round trip.
+    def round_trip(self, s3270: Popen, host: DftHost, mode: str, data: bytes):
+        send_file = tempfile.NamedTemporaryFile(delete=False)
+        send_file.write(data)
+        send_file.close()
+        receive_name = send_file.name + '.receive'
+
+        for bs in buffer_sizes:
+            host_data = None
+            def do_upload():
+                nonlocal host_data
+                host_data = host.upload()
+            self.transfer(s3270,
+                f'Transfer(direction=send,host=tso,mode={mode},localfile={send_file.name},hostfile=x,bufferSize={bs})',
+                len(data), do_upload)
+            self.transfer(s3270,
+                f'Transfer(direction=receive,host=tso,mode={mode},localfile={receive_name},hostfile=x,exist=replace,bufferSize={bs})',
+                len(data), lambda: host.download(host_data))
+            with open(receive_name, 'rb') as f:
+                self.assertEqual(data, f.read(), 'Received file differs')
+
+        os.unlink(send_file.name)
+        os.unlink(receive_name)
+
+    # Benchmark DFT uploads and downloads with different buffer sizes.
+    def test_s3270_bench_ft(self):
+
+        # Start the host.
+        port, listener = cti.unused_port()
+        listener.listen(1)
+        host = DftHost(listener)
+        hthread = threading.Thread(target=host.connect)
+        hthread.start()
+
+        # Start s3270.
+        s3270 = Popen(['s3270', f'127.0.0.1:{port}'], stdin=PIPE, stdout=PIPE, stderr=DEVNULL)
+        self.children.append(s3270)
+        hthread.join()
+        s3270.stdin.write(b'Wait(InputField)\n')
+        s3270.stdin.flush()
+        s3270.stdout.readline()
+        self.assertEqual('ok', s3270.stdout.readline().decode().strip())
+
+        # Transfer a binary file and a text file.
+        self.round_trip(s3270, host, 'binary', bytes(range(256)) * (file_size // 256))
+        line = b'The quick brown fox jumps over the lazy dog 0123456789.\n'
+        self.round_trip(s3270, host, 'ascii', line * (file_size // len(line)))
+
+        s3270.stdin.write(b'Quit()\n')
+        s3270.stdin.flush()
+
+        # Wait for the processes to exit.
+        s3270.stdin.close()
+        s3270.stdout.close()
+        self.vgwait(s3270)
+        host.conn.close()
+        listener.close()
+
+if __name__ == '__main__':
+    unittest.main()
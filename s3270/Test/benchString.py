@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 String() benchmarks
+
+import sys
+import threading
+import time
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import Common.Test.playback as playback
+import Common.Test.cti as cti
+
+# Number of times to run each action.
+iterations = cti.bench_iterations(20000)
+
+class BenchS3270String(cti.cti):
+
+    # Run an action repeatedly, returning its output and timings.
+    def run_repeated(self, s3270: Popen, action: str, n: int):
+        def writer():
+            for _ in range(n):
+                s3270.stdin.write(f'{action}\n'.encode())
+            s3270.stdin.flush()
+        cpu_start = cti.cpu_time(s3270.pid)
+        wall_start = time.monotonic()
+        t = threading.Thread(target=writer)
+        t.start()
+        results = []
+        data = []
+        while len(results) < n:
+            line = s3270.stdout.readline().decode().rstrip('\n')
+            self.assertNotEqual('', line, 's3270 exited unexpectedly')
+            if line.startswith('data: '):
+                data.append(line[6:])
+            elif line in ['ok', 'error']:
+                self.assertEqual('ok', line, f'{action} failed')
+                results.append(data)
+                data = []
+        t.join()
+        wall = time.monotonic() - wall_start
+        cpu_end = cti.cpu_time(s3270.pid)
+        cpu = cpu_end - cpu_start if cpu_start is not None and cpu_end is not None else None
+        return (results, wall, cpu)
+
+    # Report timings.
+    def report(self, action: str, n: int, wall: float, cpu):
+        cpu_text = f', s3270 CPU {cpu * 1e6 / n:.1f} us/call' if cpu is not None else ''
+        print(f'\n{action} x {n}: wall {wall * 1e6 / n:.1f} us/call{cpu_text}', file=sys.stderr)
+
+    # Benchmark repeatedly typing a long string into the input fields of a
+    # formatted screen.
+    def test_s3270_bench_string(self):
+
+        # Start 'playback' to read s3270's output.
+        port, ts = cti.unused_port()
+        with playback.playback(self, 's3270/Test/ibmlink.trc', port=port) as p:
+            ts.close()
+
+            # Start s3270.
+            s3270 = Popen(['s3270', f'127.0.0.1:{port}'], stdin=PIPE, stdout=PIPE, stderr=DEVNULL)
+            self.children.append(s3270)
+            p.send_records(4)
+
+            # Fill the input fields repeatedly.
+            text = ''.join(chr(ord('a') + i % 26) for i in range(90))
+            action = f'Home() String("{text}")'
+            r, wall, cpu = self.run_repeated(s3270, action, iterations)
+            self.report(action[:20] + '...)', iterations, wall, cpu)
+
+            # Make sure the text landed on the screen.
+            r, _, _ = self.run_repeated(s3270, 'Ascii1(24,7,20)', 1)
+            self.assertIn(r[0][0], text)
+
+            s3270.stdin.write(b'Quit()\n')
+            s3270.stdin.flush()
+
+        # Wait for the processes to exit.
+        s3270.stdin.close()
+        s3270.stdout.close()
+        self.vgwait(s3270)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 tracing overhead benchmarks
+
+import os
+import sys
+import tempfile
+import threading
+import time
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import Common.Test.cti as cti
+from Common.Test.dfthost import DftHost
+
+# Size of the file to transfer, in bytes.
+file_size = int(os.environ.get('BENCH_TRACE_SIZE', str(4 * 1024 * 1024)))
+
+# Number of times to replay each trace.
+iterations = cti.bench_iterations(200)
+
+# Traces to replay.
+trace_files = ['ibmlink.trc', 'sruvm.trc', 'all_chars.trc', 'apl.trc']
+
+# Write commands, with and without SNA command codes.
+write_commands = [0xf1, 0xf5, 0x7e, 0x01, 0x05, 0x0d]
+
+# Return the 3270 Write, Erase/Write and Erase/Write Alternate records sent by
+# the host in a trace file, without any TN3270E headers.
+def screen_writes(trace_file: str):
+    data = bytearray()
+    with open(trace_file) as f:
+        for line in f:
+            if line.startswith('< 0x'):
+                data += bytes.fromhex(line.split()[2])
+    records = []
+    record = bytearray()
+    i = 0
+    while i + 1 < len(data):
+        if data[i] == 0xff and data[i + 1] == 0xef:
+            if len(record) > 5 and record[0] == 0 and record[5] in write_commands:
+                del record[:5]
+            if len(record) > 0 and record[0] in write_commands:
+                records.append(bytes(record))
+            record = bytearray()
+            i += 2
+        elif data[i] == 0xff and data[i + 1] == 0xff:
+            record.append(0xff)
+            i += 2
+        else:
+            record.append(data[i])
+            i += 1
+    return records
+
+class BenchS3270Trace(cti.cti):
+
+    # Run an action and check that it succeeds.
+    def action(self, s3270: Popen, action: str):
+        s3270.stdin.write(f'{action}\n'.encode())
+        s3270.stdin.flush()
+        output = []
+        while True:
+            line = s3270.stdout.readline().decode().rstrip('\n')
+            self.assertNotEqual('', line, 's3270 exited unexpectedly')
+            if line in ['ok', 'error']:
+                break
+            output.append(line)
+        self.assertEqual('ok', line, f'{action} failed: {output}')
+        return output
+
+    # Report the CPU time used with and without tracing.
+    def report(self, what: str, cpu: dict, trace_size: int):
+        if cpu['off'] is None or cpu['on'] is None:
+            return
+        overhead = f' ({(cpu["on"] - cpu["off"]) * 100 / cpu["off"]:.0f}% overhead)' if cpu['off'] > 0 else ''
+        print(f'\n{what}: s3270 CPU {cpu["off"]:.2f}s untraced, {cpu["on"]:.2f}s traced{overhead}, {trace_size / 1e6:.1f} MB of trace', file=sys.stderr)
+
+    # Benchmark a DFT upload with and without tracing.
+    def test_s3270_bench_trace_ft(self):
+
+        # Start the host.
+        port, listener = cti.unused_port()
+        listener.listen(1)
+        host = DftHost(listener)
+        hthread = threading.Thread(target=host.connect)
+        hthread.start()
+
+        # Start s3270.
+        s3270 = Popen(['s3270', f'127.0.0.1:{port}'], stdin=PIPE, stdout=PIPE, stderr=DEVNULL)
+        self.children.append(s3270)
+        hthread.join()
+        self.action(s3270, 'Wait(InputField)')
+
+        with tempfile.NamedTemporaryFile(delete=False) as f:
+            f.write(bytes(range(256)) * (file_size // 256))
+        trace_file = f.name + '.trace'
+        cpu = {}
+        for trace in ['off', 'on']:
+            if trace == 'on':
+                self.action(s3270, f'Trace(on,{trace_file})')
+            hthread = threading.Thread(target=host.upload)
+            cpu_start = cti.cpu_time(s3270.pid)
+            hthread.start()
+            self.action(s3270, f'Transfer(direction=send,host=tso,mode=binary,localfile={f.name},hostfile=x,bufferSize=16384)')
+            hthread.join()
+            cpu_end = cti.cpu_time(s3270.pid)
+            cpu[trace] = cpu_end - cpu_start if cpu_start is not None and cpu_end is not None else None
+            if trace == 'on':
+                self.action(s3270, 'Trace(off)')
+        self.report('DFT upload', cpu, os.path.getsize(trace_file))
+        os.unlink(f.name)
+        os.unlink(trace_file)
+
+        s3270.stdin.write(b'Quit()\n')
+        s3270.stdin.flush()
+        s3270.stdin.close()
+        s3270.stdout.close()
+        self.vgwait(s3270)
+        host.conn.close()
+        listener.close()
+
+    # Benchmark replaying the screens from the test traces with and without
+    # tracing.
+    def test_s3270_bench_trace_replay(self):
+
+        # Collect the screen writes from the test traces.
+        records = []
+        for trc in trace_files:
+            records += screen_writes(f's3270/Test/{trc}')
+        self.assertNotEqual([], records)
+
+        # Start the host.
+        port, listener = cti.unused_port()
+        listener.listen(1)
+        host = DftHost(listener)
+        hthread = threading.Thread(target=host.connect)
+        hthread.start()
+
+        # Start s3270.
+        s3270 = Popen(['s3270', f'127.0.0.1:{port}'], stdin=PIPE, stdout=PIPE, stderr=DEVNULL)
+        self.children.append(s3270)
+        hthread.join()
+        self.action(s3270, 'Wait(InputField)')
+
+        trace_file = tempfile.NamedTemporaryFile(delete=False).name
+        cpu = {}
+        for trace in ['off', 'on']:
+            if trace == 'on':
+                self.action(s3270, f'Trace(on,{trace_file})')
+            cpu_start = cti.cpu_time(s3270.pid)
+            for _ in range(iterations):
+                for record in records:
+                    host.send_record(record)
+                # Send a timing mark and wait for the reply, so s3270 has
+                # processed everything.
+                host.conn.sendall(bytes.fromhex('fffd06'))
+                host.read_command()
+            cpu_end = cti.cpu_time(s3270.pid)
+            cpu[trace] = cpu_end - cpu_start if cpu_start is not None and cpu_end is not None else None
+            if trace == 'on':
+                self.action(s3270, 'Trace(off)')
+        self.report(f'Screen replay ({len(records)} records x {iterations})', cpu, os.path.getsize(trace_file))
+        os.unlink(trace_file)
+
+        s3270.stdin.write(b'Quit()\n')
+        s3270.stdin.flush()
+        s3270.stdin.close()
+        s3270.stdout.close()
+        self.vgwait(s3270)
+        host.conn.close()
+        listener.close()
+
+if __name__ == '__main__':
+    unittest.main()
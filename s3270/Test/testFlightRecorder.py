@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 trace flight recorder tests
+
+import os
+import tempfile
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import Common.Test.playback as playback
+import Common.Test.cti as cti
+
+class TestS3270FlightRecorder(cti.cti):
+
+    # Run an action, returning its result and output.
+    def run_action(self, s3270: Popen, action: str):
+        s3270.stdin.write(f'{action}\n'.encode())
+        s3270.stdin.flush()
+        output = []
+        while True:
+            line = s3270.stdout.readline().decode().rstrip('\n')
+            self.assertNotEqual('', line, 's3270 exited unexpectedly')
+            if line in ['ok', 'error']:
+                return (line, output)
+            if line.startswith('data: '):
+                output.append(line[6:])
+
+    # Start s3270 with the flight recorder on, and feed it some data.
+    def start(self, p: playback.playback, port: int, dump_file: str, extra=[]):
+        s3270 = Popen(cti.vgwrap(['s3270', '-xrm', 's3270.flightRecorder: 16K',
+            '-xrm', f's3270.flightRecorderFile: {dump_file}'] + extra +
+            [f'127.0.0.1:{port}']), stdin=PIPE, stdout=PIPE, stderr=DEVNULL)
+        self.children.append(s3270)
+        p.send_records(4)
+        return s3270
+
+    # Stop s3270.
+    def stop(self, s3270: Popen):
+        s3270.stdin.write(b'Quit()\n')
+        s3270.stdin.flush()
+        s3270.stdin.close()
+        s3270.stdout.close()
+        self.vgwait(s3270)
+
+    # s3270 flight recorder Trace(Dump) test
+    def test_s3270_flight_recorder_dump(self):
+
+        dump_file = tempfile.NamedTemporaryFile(delete=False).name
+        port, ts = cti.unused_port()
+        with playback.playback(self, 's3270/Test/ibmlink.trc', port=port) as p:
+            ts.close()
+            s3270 = self.start(p, port, dump_file)
+
+            # Dump the recorder.
+            result, output = self.run_action(s3270, 'Trace(Dump)')
+            self.assertEqual('ok', result)
+            self.assertEqual([f'Flight recorder dumped to {dump_file}.'], output)
+
+            # It is empty now.
+            result, output = self.run_action(s3270, 'Trace(Dump)')
+            self.assertEqual('error', result)
+            self.assertIn('empty', output[0])
+            self.stop(s3270)
+
+        # Check the dump.
+        with open(dump_file) as f:
+            text = f.read()
+        os.unlink(dump_file)
+        self.assertIn('Trace flight recorder dump (Trace())', text)
+        self.assertIn(' Data stream:\n', text)
+        self.assertIn('< EraseWrite', text)
+        self.assertIn('< 0x0   ', text)
+        self.assertNotIn('Host socket read complete', text)
+
+    # s3270 flight recorder dump on host disconnect test
+    def test_s3270_flight_recorder_disconnect(self):
+
+        dump_file = tempfile.NamedTemporaryFile(delete=False).name
+        os.unlink(dump_file)
+        port, ts = cti.unused_port()
+        with playback.playback(self, 's3270/Test/ibmlink.trc', port=port) as p:
+            ts.close()
+            s3270 = self.start(p, port, dump_file,
+                ['-xrm', 's3270.flightRecorderCategories: ds events'])
+
+            # Disconnect and wait for the dump.
+            p.disconnect()
+            self.try_until(lambda: os.path.exists(dump_file) and os.path.getsize(dump_file) > 0,
+                2, 'Dump not written')
+            self.stop(s3270)
+
+        # Check the dump.
+        with open(dump_file) as f:
+            text = f.read()
+        os.unlink(dump_file)
+        self.assertIn('Trace flight recorder dump (host disconnected)', text)
+        self.assertIn('< EraseWrite', text)
+        self.assertIn('RCVD disconnect', text)
+        self.assertNotIn('< 0x0   ', text)
+
+    # s3270 Trace(Dump) without the flight recorder test
+    def test_s3270_flight_recorder_off(self):
+
+        s3270 = Popen(cti.vgwrap(['s3270']), stdin=PIPE, stdout=PIPE,
+            stderr=DEVNULL)
+        self.children.append(s3270)
+        result, output = self.run_action(s3270, 'Trace(Dump)')
+        self.assertEqual('error', result)
+        self.assertIn('not enabled', output[0])
+        self.stop(s3270)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 batch file transfer tests
+
+import os
+import sys
+import tempfile
+import threading
+import unittest
+from subprocess import Popen, DEVNULL
+import Common.Test.cti as cti
+from Common.Test.dfthost import DftHost
+
+sys.path.insert(0, 'Common/Python')
+import x3270if
+
+class TestS3270FtBatch(cti.cti):
+
+    # s3270 batch file transfer test
+    def test_s3270_ft_batch(self):
+
+        nsessions = 3
+        hosts = []
+        hthreads = []
+        emulators = []
+        sessions = []
+        for _ in range(nsessions):
+
+            # Start a host.
+            hport, listener = cti.unused_port()
+            listener.listen(1)
+            host = DftHost(listener)
+            hthread = threading.Thread(target=lambda h=host: (h.connect(), h.serve()))
+            hthread.start()
+            hosts.append(host)
+            hthreads.append(hthread)
+
+            # Start s3270.
+            sport, ts = cti.unused_port()
+            s3270 = Popen(cti.vgwrap(['s3270', '-scriptport', str(sport),
+                f'127.0.0.1:{hport}']), stdin=DEVNULL, stdout=DEVNULL)
+            self.children.append(s3270)
+            emulators.append(s3270)
+            ts.close()
+            self.check_listen(sport)
+            session = x3270if.port_session(sport)
+            session.run_action('Wait(InputField)')
+            sessions.append(session)
+
+        # Create the files.
+        files = []
+        for i in range(10):
+            with tempfile.NamedTemporaryFile(delete=False) as f:
+                data = os.urandom(1000 * (i + 1))
+                f.write(data)
+                files.append((f.name, data))
+
+        # Transfer them, plus one that does not exist.
+        manifest = [{ 'direction': 'send', 'host': 'tso', 'mode': 'binary',
+            'localfile': name, 'hostfile': f'file{i}' } for i, (name, _) in enumerate(files)]
+        manifest.append({ 'direction': 'send', 'host': 'tso', 'mode': 'binary',
+            'localfile': '/nonexistent/file', 'hostfile': 'missing' })
+        batch = x3270if.batch_transfer(sessions, manifest)
+        report = batch.run()
+
+        # Check the report.
+        self.assertEqual(len(files), report['completed'])
+        self.assertEqual(1, report['failed'])
+        self.assertEqual(0, report['pending'])
+        self.assertEqual(sum(len(data) for _, data in files), report['bytes'])
+        self.assertEqual(len(manifest), len(report['files']))
+        self.assertEqual('failed', report['files'][-1]['status'])
+        self.assertIn('/nonexistent/file', report['files'][-1]['message'])
+        self.assertTrue(all(f['status'] == 'complete' for f in report['files'][:-1]))
+        self.assertEqual(len(files[3][1]), report['files'][3]['bytes'])
+        self.assertGreater(len(set(f['session'] for f in report['files'])), 1,
+            'Transfers not spread over sessions')
+        self.assertIn('"completed": 10', batch.json())
+
+        # Check what the hosts received.
+        for i, (_, data) in enumerate(files):
+            session = report['files'][i]['session']
+            self.assertEqual(data, hosts[session].files[f'file{i}'])
+
+        # Check the per-session statistics.
+        completed = 0
+        for i, session in enumerate(sessions):
+            r = session.run_action('Query(FileTransfer)').split('\n')
+            self.assertEqual('state idle', r[0])
+            words = r[1].split()
+            self.assertEqual('completed', words[0])
+            completed += int(words[1])
+            expected = sum(len(files[f['index']][1]) for f in report['files'][:-1] if f['session'] == i)
+            self.assertEqual(str(expected), words[5])
+        self.assertEqual(len(files), completed)
+
+        # Clean up.
+        for name, _ in files:
+            os.unlink(name)
+        for session in sessions:
+            session.run_action('Quit()')
+        for s3270 in emulators:
+            self.vgwait(s3270)
+        for hthread in hthreads:
+            hthread.join()
+        for host in hosts:
+            host.conn.close()
+            host.listener.close()
+
+if __name__ == '__main__':
+    unittest.main()
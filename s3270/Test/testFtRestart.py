@@ -0,0 +1,134 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 restartable file transfer tests
+
+import os
+import random
+import sys
+import tempfile
+import threading
+import unittest
+from subprocess import Popen, DEVNULL
+import Common.Test.cti as cti
+from Common.Test.dfthost import DftHost
+
+sys.path.insert(0, 'Common/Python')
+import x3270if
+
+class TestS3270FtRestart(cti.cti):
+
+    # Run a host thread function, keeping any exception it raises.
+    def host_thread(self, fn):
+        def run():
+            try:
+                self.host_result = fn()
+            except Exception as e:
+                self.host_result = e
+        t = threading.Thread(target=run)
+        t.start()
+        return t
+
+    # Upload a file that fails partway and is then resumed.
+    def restart_test(self, data: bytes, args: list, aligned):
+        hport, listener = cti.unused_port()
+        listener.listen(1)
+        host = DftHost(listener)
+        with tempfile.NamedTemporaryFile(delete=False) as f:
+            f.write(data)
+        ckpt = f.name + '.ckpt'
+        transfer = ['Direction=send', 'Host=tso', f'LocalFile={f.name}',
+            'HostFile=x', 'BufferSize=1000'] + args
+
+        # Start s3270.
+        hthread = self.host_thread(lambda: host.connect())
+        sport, ts = cti.unused_port()
+        s3270 = Popen(cti.vgwrap(['s3270', '-scriptport', str(sport),
+            f'127.0.0.1:{hport}']), stdin=DEVNULL, stdout=DEVNULL)
+        self.children.append(s3270)
+        ts.close()
+        self.check_listen(sport)
+        session = x3270if.port_session(sport)
+        hthread.join()
+        session.run_action('Wait(InputField)')
+
+        # Get the whole file, without a checkpoint.
+        hthread = self.host_thread(lambda: host.upload())
+        session.run_action('Transfer', transfer)
+        hthread.join()
+        whole = self.host_result
+        self.assertGreater(len(whole), 10000)
+
+        # Fail partway through the transfer.
+        hthread = self.host_thread(lambda: host.upload(fail_after=5))
+        with self.assertRaises(x3270if.ActionFailException):
+            session.run_action('Transfer', transfer + [f'Checkpoint={ckpt}'])
+        hthread.join()
+        first = self.host_result
+        self.assertGreater(len(first), 0)
+        self.assertTrue(aligned(first), 'Checkpoint not on a boundary')
+        with open(ckpt) as c:
+            self.assertIn(f'confirmed {len(first):020}', c.read())
+
+        # Reconnect and resume.
+        hthread = self.host_thread(lambda: host.connect())
+        session.run_action(f'Connect(127.0.0.1:{hport})')
+        hthread.join()
+        session.run_action('Wait(InputField)')
+        def resume():
+            rec = host.read_record()
+            self.assertIn('APPEND', rec.decode('cp037'))
+            return host.upload(rec)
+        hthread = self.host_thread(resume)
+        session.run_action('Transfer', transfer + [f'Checkpoint={ckpt}'])
+        hthread.join()
+        self.assertIsInstance(self.host_result, bytes)
+        self.assertEqual(whole, first + self.host_result)
+        self.assertFalse(os.path.exists(ckpt))
+
+        # Clean up.
+        os.unlink(f.name)
+        session.run_action('Quit()')
+        self.vgwait(s3270)
+        host.conn.close()
+        listener.close()
+
+    # ASCII restart test, resuming at a line boundary.
+    def test_s3270_ft_restart_ascii(self):
+        rand = random.Random(38)
+        lines = [''.join(rand.choice('abcdefghij KLMNOP 0123') for _ in range(rand.randrange(150))) for _ in range(300)]
+        self.restart_test(('\n'.join(lines) + '\n').encode(), ['Mode=ascii'],
+            lambda d: d.endswith(b'\r\n'))
+
+    # Binary restart test, resuming at a fixed-length record boundary.
+    def test_s3270_ft_restart_binary(self):
+        self.restart_test(os.urandom(50000),
+            ['Mode=binary', 'Recfm=fixed', 'Lrecl=80'],
+            lambda d: len(d) % 80 == 0)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,92 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 load generator tests
+
+import shutil
+import sys
+import unittest
+from subprocess import Popen, PIPE
+import Common.Test.cti as cti
+
+sys.path.insert(0, 'Common/Python')
+import x3270if
+
+@unittest.skipIf(shutil.which('playback') is None, 'playback not built')
+class TestS3270LoadGenerator(cti.cti):
+
+    # s3270 load generator test
+    def test_s3270_load_generator(self):
+
+        # Start playback as the host.
+        nsessions = 4
+        port, ts = cti.unused_port()
+        ts.close()
+        pb = Popen(cti.vgwrap(['playback', '-r', '-n', str(nsessions), '-p',
+            str(port), 's3270/Test/ibmlink_help.trc']), stdout=PIPE)
+        self.children.append(pb)
+        while not pb.stdout.readline().decode().startswith('Replaying on'):
+            pass
+
+        # Each Enter brings up the next screen of the trace.
+        g = x3270if.load_generator(f'127.0.0.1:{port}', nsessions,
+            ['Enter()', 'Wait(InputField)'], transactions=3)
+        report = g.run()
+
+        # Check the report.
+        self.assertEqual(nsessions, report['sessions'])
+        self.assertEqual(0, report['session_failures'])
+        self.assertEqual(nsessions * 3, report['transactions'])
+        self.assertEqual(0, report['failed'])
+        self.assertEqual([], report['errors'])
+        self.assertGreater(report['transactions_per_second'], 0)
+        latency = report['latency']
+        self.assertGreater(latency['min'], 0)
+        self.assertTrue(latency['min'] <= latency['p50'] <= latency['p90']
+            <= latency['p95'] <= latency['p99'] <= latency['max'])
+        self.assertIn('"transactions": 12', g.json())
+
+        # Playback saw every session.
+        output = pb.communicate()[0].decode()
+        self.vgwait(pb, assertOnFailure=False)
+        self.assertIn(f'{nsessions} sessions, ', output)
+
+    # s3270 load generator session failure test
+    def test_s3270_load_generator_no_host(self):
+
+        # Nothing is listening on the port.
+        port, ts = cti.unused_port()
+        ts.close()
+        g = x3270if.load_generator(f'127.0.0.1:{port}', 2, ['Enter()'])
+        report = g.run()
+        self.assertEqual(0, report['sessions'])
+        self.assertEqual(2, report['session_failures'])
+        self.assertEqual(0, report['transactions'])
+        self.assertEqual(1, len(report['errors']))
+
+if __name__ == '__main__':
+    unittest.main()
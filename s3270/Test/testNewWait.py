@@ -76,11 +76,13 @@ class TestNewWait(cti.cti):
                     f'http://127.0.0.1:{s3270_port}/3270/rest/json/Wait({wait_params})',
                     timeout=2)
             self.assertEqual(r.status_code, requests.codes.ok)
+            result = r.json()['result']
 
         # Wait for the processes to exit.
         x.join(timeout=2)
         requests.get(f'http://127.0.0.1:{s3270_port}/3270/rest/json/Quit()')
         self.vgwait(s3270)
+        return result
 
     # Generic flavor of CursorAt test.
     def test_cursor_at(self):
@@ -94,6 +96,14 @@ class TestNewWait(cti.cti):
     def test_string_at_offset(self):
         self.new_wait(4, ['String("xxx")'], 'StringAt,1612,"xx"')
 
+    # StringAt with several strings, reporting which one matched.
+    def test_string_at_multiple(self):
+        result = self.new_wait(4, ['String("xxx")'], 'StringAt,1,1,"nope",21,13,"xx",22,1,"nope"')
+        self.assertEqual(['2'], result)
+    def test_string_at_multiple_change(self):
+        result = self.new_wait(4, ['Tab()', 'String("yyy")'], 'StringAt,21,13,"xx",21,32,"yy"')
+        self.assertEqual(['2'], result)
+
     # Generic flavor of InputFieldAt test.
     def test_input_field_at(self):
         self.new_wait(3, [], 'InputFieldAt,21,13', playback, 1)
@@ -125,6 +135,7 @@ class TestNewWait(cti.cti):
         self.simple_negative_test(port, 'Wait(CursorAt,300,300)', 'Invalid')
         self.simple_negative_test(port, 'Wait(StringAt)', 'requires')
         self.simple_negative_test(port, 'Wait(StringAt,1,2,3,4)', 'requires')
+        self.simple_negative_test(port, 'Wait(StringAt,1,2,"a",3,4)', 'requires')
         self.simple_negative_test(port, 'Wait(InputFieldAt)', 'requires')
         self.simple_negative_test(port, 'Wait(InputFieldAt,1,2,3)', 'requires')
 
@@ -165,6 +176,7 @@ class TestNewWait(cti.cti):
             self.nop(sport, 'Wait(CursorAt,21,13)')
             self.nop(sport, 'Wait(InputFieldAt,21,13)')
             self.nop(sport, 'Wait(StringAt,21,13,"___")')
+            self.nop(sport, 'Wait(StringAt,1,1,"nope",21,13,"___")')
 
         requests.get(f'http://127.0.0.1:{sport}/3270/rest/json/Quit()')
         self.vgwait(s3270)
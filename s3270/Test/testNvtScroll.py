@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 NVT-mode scrolling output tests
+
+import re
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import Common.Test.playback as playback
+import Common.Test.cti as cti
+
+class TestS3270NvtScroll(cti.cti):
+
+    # Compute what the screen should look like after the trace is played.
+    def expected_screen(self, trace: str, rows=43, cols=80):
+        data = b''
+        with open(trace) as f:
+            for line in f:
+                if line.startswith('< 0x'):
+                    data += bytes.fromhex(line.split()[2])
+        text = re.sub(r'\x1b\[[0-9;]*m', '', data.decode())
+        screen = []
+        for line in text.split('\r\n')[:-1]:
+            screen += [line[i:i + cols] for i in range(0, len(line), cols)] or ['']
+        screen.append('')
+        return [row.ljust(cols) for row in screen[-rows:]]
+
+    # s3270 NVT-mode scrolling output test
+    def test_s3270_nvt_scroll(self):
+
+        port, ts = cti.unused_port()
+        with playback.playback(self, 's3270/Test/nvt-scroll.trc', port=port) as p:
+            ts.close()
+            s3270 = Popen(cti.vgwrap(['s3270', f'127.0.0.1:{port}']),
+                stdin=PIPE, stdout=PIPE, stderr=DEVNULL)
+            self.children.append(s3270)
+            p.send_to_mark()
+
+            # Check the screen and the cursor.
+            s3270.stdin.write(b'Ascii()\nQuery(Cursor1)\nQuit()\n')
+            s3270.stdin.flush()
+            out = s3270.stdout.read().decode().split('\n')
+            s3270.stdin.close()
+            s3270.stdout.close()
+            self.vgwait(s3270)
+
+        screen = [line[6:] for line in out if line.startswith('data: ')]
+        self.assertEqual(self.expected_screen('s3270/Test/nvt-scroll.trc'),
+            screen[:-1])
+        self.assertEqual('row 43 column 1 offset 3360', screen[-1])
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# playback replay mode tests
+
+import os
+import shutil
+import tempfile
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import Common.Test.cti as cti
+
+@unittest.skipIf(shutil.which('playback') is None, 'playback not built')
+class TestPlaybackReplay(cti.cti):
+
+    # Start playback in replay mode, returning the process, its port and
+    # the messages it displayed while loading the traces.
+    def start_playback(self, args: list[str]):
+        port, ts = cti.unused_port()
+        ts.close()
+        pb = Popen(cti.vgwrap(['playback', '-r', '-p', str(port)] + args),
+            stdout=PIPE)
+        self.children.append(pb)
+        loaded = ''
+        while True:
+            line = pb.stdout.readline().decode()
+            self.assertNotEqual('', line, 'playback exited unexpectedly')
+            if line.startswith('Replaying on'):
+                return (pb, port, loaded)
+            loaded += line
+
+    # Start s3270 and feed it a script.
+    def start_s3270(self, port: int, script: str):
+        s3270 = Popen(cti.vgwrap(['s3270', f'127.0.0.1:{port}']), stdin=PIPE,
+            stdout=DEVNULL)
+        self.children.append(s3270)
+        s3270.stdin.write(script.encode())
+        s3270.stdin.flush()
+        s3270.stdin.close()
+        return s3270
+
+    # Concurrent replay test
+    def test_playback_replay(self):
+
+        # Replay a directory of traces to several emulators at once.
+        trace_dir = tempfile.mkdtemp()
+        shutil.copy('s3270/Test/ibmlink_help.trc', trace_dir)
+        shutil.copy('s3270/Test/ibmlink.trc', trace_dir)
+        pb, port, loaded = self.start_playback(['-n', '4', '-s', '100', trace_dir])
+
+        # Each Enter advances the trace to the next screen.
+        script = 'Wait(InputField)\nEnter()\n' * 4 + 'Wait(Disconnect)\nQuit()\n'
+        emulators = [self.start_s3270(port, script) for _ in range(4)]
+        for s3270 in emulators:
+            self.vgwait(s3270)
+        output = pb.communicate()[0].decode()
+        self.vgwait(pb)
+        shutil.rmtree(trace_dir)
+
+        self.assertIn(f'Loaded {trace_dir}/ibmlink.trc: ', loaded)
+        self.assertIn(f'Loaded {trace_dir}/ibmlink_help.trc: ', loaded)
+        for i in range(1, 5):
+            name = 'ibmlink.trc' if i % 2 else 'ibmlink_help.trc'
+            self.assertIn(f'Session {i} ({trace_dir}/{name}): complete, ', output)
+        self.assertIn('4 sessions, 4 complete, ', output)
+
+    # Replay with an emulator that disconnects early
+    def test_playback_replay_disconnect(self):
+
+        pb, port, _ = self.start_playback(['-n', '1',
+            's3270/Test/ibmlink_help.trc'])
+        s3270 = self.start_s3270(port, 'Wait(InputField)\nDisconnect()\nQuit()\n')
+        self.vgwait(s3270)
+        output = pb.communicate()[0].decode()
+        self.vgwait(pb, assertOnFailure=False)
+        self.assertEqual(2, pb.returncode)
+        self.assertRegex(output, r'Session 1 \(s3270/Test/ibmlink_help\.trc\): emulator disconnected at record \d+ of \d+')
+        self.assertIn('1 sessions, 0 complete, ', output)
+
+    # Replay with an emulator reply that is longer than the traced one
+    def test_playback_replay_long_reply(self):
+
+        # Shorten the third traced reply, so the emulator's Enter is longer.
+        trace_dir = tempfile.mkdtemp()
+        trace_file = f'{trace_dir}/short_reply.trc'
+        with open('s3270/Test/ibmlink_help.trc') as f:
+            trace = f.read()
+        self.assertIn('> 0x0   0000000002f35cf6ffef\n', trace)
+        with open(trace_file, 'w') as f:
+            f.write(trace.replace('> 0x0   0000000002f35cf6ffef\n', '> 0x0   0000000002f3ffef\n'))
+
+        # The excess must not count toward the fourth reply, so the script
+        # has to wait for the emulator there.
+        pb, port, _ = self.start_playback(['-n', '1', trace_file])
+        script = 'Wait(InputField)\nEnter()\n' * 3 + 'Wait(InputField)\nDisconnect()\nQuit()\n'
+        s3270 = self.start_s3270(port, script)
+        self.vgwait(s3270)
+        output = pb.communicate()[0].decode()
+        self.vgwait(pb, assertOnFailure=False)
+        shutil.rmtree(trace_dir)
+        self.assertEqual(2, pb.returncode)
+        self.assertIn('emulator disconnected at record ', output)
+        self.assertIn('1 sessions, 0 complete, ', output)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 binary trace tests
+
+import os
+import shutil
+import tempfile
+import threading
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import Common.Test.playback as playback
+import Common.Test.cti as cti
+
+@unittest.skipIf(shutil.which('playback') is None, 'playback not built')
+class TestS3270TraceBinary(cti.cti):
+
+    # Return the data sent in one direction in a text trace.
+    def trace_data(self, text: str, direction: str):
+        return bytes.fromhex(''.join(line.split()[2]
+            for line in text.split('\n') if line.startswith(direction + ' 0x')))
+
+    # s3270 binary trace test
+    def test_s3270_trace_binary(self):
+
+        trace_file = tempfile.NamedTemporaryFile(delete=False).name
+
+        # Write a binary trace.
+        port, ts = cti.unused_port()
+        with playback.playback(self, 's3270/Test/ibmlink.trc', port=port) as p:
+            ts.close()
+            s3270 = Popen(cti.vgwrap(['s3270', '-xrm', 's3270.traceBinary: true',
+                '-trace', '-tracefile', trace_file, f'127.0.0.1:{port}']),
+                stdin=PIPE, stdout=DEVNULL)
+            self.children.append(s3270)
+            p.send_records(4)
+            s3270.stdin.write(b'PF(3)\n')
+            s3270.stdin.flush()
+            p.match()
+        s3270.stdin.write(b'Quit()\n')
+        s3270.stdin.flush()
+        s3270.stdin.close()
+        self.vgwait(s3270)
+        with open(trace_file, 'rb') as f:
+            self.assertTrue(f.read().startswith(b'x3270 binary trace 1\n'))
+
+        # Render it as text.
+        conv = Popen(cti.vgwrap(['playback', '-t', trace_file]), stdout=PIPE)
+        self.children.append(conv)
+        text = conv.communicate()[0].decode()
+        self.vgwait(conv)
+        self.assertRegex(text, r'^\d{8}\.\d{6}\.\d{3} Trace started\n')
+        self.assertIn('\n Data stream:\n', text)
+        self.assertRegex(text, r'\n\d{8}\.\d{6}\.\d{3} Trace stopped\n$')
+        self.assertIn('\n< EraseWrite', text)
+
+        # The host data matches the original trace, apart from the timing
+        # marks added by send_records(), and the emulator sent the PF3.
+        with open('s3270/Test/ibmlink.trc') as f:
+            original = f.read()
+        host_data = self.trace_data(text, '<').replace(b'\xff\xfd\x06', b'')
+        self.assertNotEqual(b'', host_data)
+        self.assertTrue(self.trace_data(original, '<').startswith(host_data))
+        self.assertIn(bytes.fromhex('0000000000f3'), self.trace_data(text, '>'))
+
+        # Play it back directly, and check that s3270 responds the same way.
+        port, ts = cti.unused_port()
+        ts.close()
+        pb = Popen(cti.vgwrap(['playback', '-b', '-p', str(port), trace_file]),
+            stdout=PIPE)
+        self.children.append(pb)
+        self.assertIn('Waiting for connection', pb.stdout.readline().decode())
+        drain = threading.Thread(target=pb.stdout.read)
+        drain.start()
+        s3270 = Popen(cti.vgwrap(['s3270', f'127.0.0.1:{port}']), stdin=PIPE,
+            stdout=DEVNULL)
+        self.children.append(s3270)
+        s3270.stdin.write(b'Wait(InputField)\nPF(3)\nWait(Disconnect)\nQuit()\n')
+        s3270.stdin.flush()
+        s3270.stdin.close()
+        self.vgwait(s3270)
+        self.vgwait(pb)
+        drain.join()
+        pb.stdout.close()
+        os.unlink(trace_file)
+
+if __name__ == '__main__':
+    unittest.main()
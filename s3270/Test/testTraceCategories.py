@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 trace category tests
+
+import os
+import tempfile
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import Common.Test.playback as playback
+import Common.Test.cti as cti
+
+class TestS3270TraceCategories(cti.cti):
+
+    # Run an action, returning its result and output.
+    def run_action(self, s3270: Popen, action: str):
+        s3270.stdin.write(f'{action}\n'.encode())
+        s3270.stdin.flush()
+        output = []
+        while True:
+            line = s3270.stdout.readline().decode().rstrip('\n')
+            self.assertNotEqual('', line, 's3270 exited unexpectedly')
+            if line in ['ok', 'error']:
+                return (line, output)
+            if line.startswith('data: '):
+                output.append(line[6:])
+
+    # Stop s3270.
+    def stop(self, s3270: Popen):
+        s3270.stdin.write(b'Quit()\n')
+        s3270.stdin.flush()
+        s3270.stdin.close()
+        s3270.stdout.close()
+        self.vgwait(s3270)
+
+    # s3270 traceCategories resource test
+    def test_s3270_trace_categories_resource(self):
+
+        trace_file = tempfile.NamedTemporaryFile(delete=False).name
+        port, ts = cti.unused_port()
+        with playback.playback(self, 's3270/Test/ibmlink.trc', port=port) as p:
+            ts.close()
+            s3270 = Popen(cti.vgwrap(['s3270', '-xrm',
+                's3270.traceCategories: telnet script', '-trace',
+                '-tracefile', trace_file, f'127.0.0.1:{port}']),
+                stdin=PIPE, stdout=PIPE, stderr=DEVNULL)
+            self.children.append(s3270)
+            p.send_records(4)
+            result, _ = self.run_action(s3270, 'Wait(InputField)')
+            self.assertEqual('ok', result)
+            self.stop(s3270)
+
+        # Check the trace.
+        with open(trace_file) as f:
+            text = f.read()
+        os.unlink(trace_file)
+        self.assertIn('\n Categories: telnet script\n', text)
+        self.assertIn(' SENT WILL TN3270E\n', text)
+        self.assertIn(' s3stdin read \'Wait(InputField)\'\n', text)
+        self.assertNotIn('< 0x0   ', text)
+        self.assertNotIn('EraseWrite', text)
+        self.assertNotIn('sched:', text)
+        self.assertNotIn('Host socket read complete', text)
+
+    # s3270 Trace(Categories) test
+    def test_s3270_trace_categories_action(self):
+
+        trace_file = tempfile.NamedTemporaryFile(delete=False).name
+        port, ts = cti.unused_port()
+        with playback.playback(self, 's3270/Test/ibmlink.trc', port=port) as p:
+            ts.close()
+            s3270 = Popen(cti.vgwrap(['s3270', '-trace', '-tracefile',
+                trace_file, f'127.0.0.1:{port}']), stdin=PIPE, stdout=PIPE,
+                stderr=DEVNULL)
+            self.children.append(s3270)
+            p.send_records(4)
+
+            # Check the default, then trace only network data.
+            self.assertEqual(('ok', ['all']),
+                self.run_action(s3270, 'Trace(Categories)'))
+            self.assertEqual(('ok', []),
+                self.run_action(s3270, 'Trace(Categories,"net sched",ds)'))
+            self.assertEqual(('ok', ['ds net sched']),
+                self.run_action(s3270, 'Trace(Categories)'))
+            self.assertEqual(('ok', []),
+                self.run_action(s3270, 'Trace(Categories,net)'))
+            result, output = self.run_action(s3270, 'Trace(Categories,foo)')
+            self.assertEqual('error', result)
+            self.assertIn('foo', output[0])
+            self.assertEqual(('ok', ['net']),
+                self.run_action(s3270, 'Trace(Categories)'))
+
+            # Generate some traffic.
+            s3270.stdin.write(b'PF(3)\n')
+            s3270.stdin.flush()
+            p.match()
+            self.stop(s3270)
+
+        # Check the trace.
+        with open(trace_file) as f:
+            text = f.read()
+        os.unlink(trace_file)
+        changed = text.index('Trace categories set to net\n')
+        self.assertIn('> 0x0   ', text[changed:])
+        self.assertNotIn('PF3', text[changed:])
+        self.assertNotIn('s3stdin', text[changed:])
+
+if __name__ == '__main__':
+    unittest.main()
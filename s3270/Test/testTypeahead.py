@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025 Paul Mattes.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in the
+#       documentation and/or other materials provided with the distribution.
+#     * Neither the names of Paul Mattes nor the names of his contributors
+#       may be used to endorse or promote products derived from this software
+#       without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY PAUL MATTES "AS IS" AND ANY EXPRESS OR IMPLIED
+# WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+# EVENT SHALL PAUL MATTES BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# s3270 typeahead tests
+
+import threading
+import unittest
+from subprocess import Popen, PIPE, DEVNULL
+import requests
+import Common.Test.playback as playback
+import Common.Test.cti as cti
+
+# Number of keystrokes to queue.
+keystrokes = 3000
+
+class TestS3270Typeahead(cti.cti):
+
+    # s3270 typeahead stress test
+    def test_s3270_typeahead_stress(self):
+
+        # Start 'playback' to read s3270's output.
+        playback_port, ts = cti.unused_port()
+        with playback.playback(self, 's3270/Test/ibmlink.trc', port=playback_port) as p:
+            ts.close()
+
+            # Start s3270.
+            http_port, ts = cti.unused_port()
+            s3270 = Popen(cti.vgwrap(['s3270', '-httpd', f'127.0.0.1:{http_port}',
+                f'127.0.0.1:{playback_port}']), stdin=PIPE, stdout=DEVNULL)
+            self.children.append(s3270)
+            ts.close()
+            url = f'http://127.0.0.1:{http_port}/3270/rest/json/'
+
+            # Feed s3270 some data.
+            p.send_records(4)
+
+            # Press Enter, which locks the keyboard until the host answers.
+            # The Enter() request does not complete until then.
+            enter = threading.Thread(target=lambda: requests.get(url + 'Enter()'))
+            enter.start()
+            self.try_until(lambda: requests.get(url + 'Query(KeyboardLock)').json()['result'][0] == 'true',
+                2, 'keyboard did not lock')
+
+            # Queue up lots of keystrokes.
+            keys = [f'Key({chr(ord("a") + i % 26)})' for i in range(keystrokes)]
+            for i in range(0, keystrokes, 100):
+                r = requests.get(url + ' '.join(keys[i:i+100]))
+                self.assertEqual(requests.codes.ok, r.status_code)
+
+            # Verify that they are all queued.
+            r = requests.get(url + 'Query(Typeahead)')
+            self.assertEqual(f'queued {keystrokes} peak {keystrokes} dropped 0 flushed 0', r.json()['result'][0])
+
+            # Let the host answer, which unlocks the keyboard and runs the typeahead.
+            p.send_records(1)
+            enter.join(timeout=2)
+            self.assertFalse(enter.is_alive(), 'Enter() did not complete')
+
+            # Verify that the queue drained, in order.
+            r = requests.get(url + 'Query(Typeahead)')
+            self.assertEqual(f'queued 0 peak {keystrokes} dropped 0 flushed 0', r.json()['result'][0])
+            r = requests.get(url + 'Query(KeyboardLock)')
+            self.assertEqual('false', r.json()['result'][0])
+            r = requests.get(url + 'Ascii()')
+            self.assertIn('qrstuvwxyzabcdefghij', ''.join(r.json()['result']))
+
+            # Stop s3270.
+            requests.get(url + 'Quit()')
+
+        # Wait for the processes to exit.
+        s3270.stdin.close()
+        self.vgwait(s3270)
+
+if __name__ == '__main__':
+    unittest.main()
@@ -149,5 +149,36 @@ class TestS3270WrapField(cti.cti):
         requests.get(f'http://127.0.0.1:{sport}/3270/rest/json/Quit()')
         self.vgwait(s3270)
 
+    # s3270 AsciiField() on a field that wraps past the end of the screen
+    def test_s3270_ascii_field_wrap(self):
+
+        pport, socket = cti.unused_port()
+        with playback.playback(self, 's3270/Test/wrap_field_end.trc', pport) as p:
+            socket.close()
+
+            # Start s3270.
+            sport, socket = cti.unused_port()
+            s3270 = Popen(cti.vgwrap(['s3270', '-httpd', str(sport),
+                    f'127.0.0.1:{pport}']), stdin=DEVNULL, stdout=DEVNULL)
+            self.children.append(s3270)
+            self.check_listen(sport)
+            socket.close()
+
+            # Fill in the screen.
+            # The screen will be painted with a protected field whose SF is at (43,40), so it runs to the end of the
+            # screen and wraps to row 1, where it ends at the SF of an unprotected field at (1,40). The cursor is
+            # in the protected field.
+            p.send_records(1)
+
+            # Dump the field, twice so the second one comes from the cache.
+            for _ in range(2):
+                rs = requests.get(f'http://127.0.0.1:{sport}/3270/rest/json/AsciiField()').json()['result']
+                self.assertEqual(['This read-only field starts on row 43,  ',
+                    'and wraps to the top of the screen.    '], rs)
+
+        # Wait for the processes to exit.
+        requests.get(f'http://127.0.0.1:{sport}/3270/rest/json/Quit()')
+        self.vgwait(s3270)
+
 if __name__ == '__main__':
     unittest.main()
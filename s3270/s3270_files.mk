@@ -1,2 +1,2 @@
 # s3270-specific object files
-S3270_OBJECTS = s3270.o
+S3270_OBJECTS = s3270.o s3270_modules.o
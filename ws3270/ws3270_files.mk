@@ -1 +1 @@
-WS3270_OBJECTS = s3270.o
+WS3270_OBJECTS = s3270.o s3270_modules.o